@@ -0,0 +1,52 @@
+# ld_flag_manifest(<target> MANIFEST <file> [PREFIX <prefix>] [OUTPUT <name>])
+#
+# Generates typed flag accessors from a JSON flag manifest with
+# ld-flag-codegen, and adds them to <target>. The header, <name>.h, defaults
+# to <prefix-lowercase>.h and is placed on the include path of the target.
+# The prefix, which defaults to LDFlag, names the accessors and the
+# <prefix>Manifest array that must be passed to LDConfigSetFlagManifest.
+#
+# LD_FLAG_CODEGEN_EXECUTABLE, when set, names a host ld-flag-codegen to run in
+# place of the target built with LD_BUILD_FLAG_CODEGEN.
+function(ld_flag_manifest target)
+    cmake_parse_arguments(LD_MANIFEST "" "MANIFEST;PREFIX;OUTPUT" "" ${ARGN})
+
+    if(NOT LD_MANIFEST_MANIFEST)
+        message(FATAL_ERROR "ld_flag_manifest requires MANIFEST")
+    endif()
+
+    if(NOT LD_MANIFEST_PREFIX)
+        set(LD_MANIFEST_PREFIX "LDFlag")
+    endif()
+
+    if(NOT LD_MANIFEST_OUTPUT)
+        string(TOLOWER "${LD_MANIFEST_PREFIX}" LD_MANIFEST_OUTPUT)
+    endif()
+
+    if(LD_FLAG_CODEGEN_EXECUTABLE)
+        set(codegen "${LD_FLAG_CODEGEN_EXECUTABLE}")
+    elseif(LD_BUILD_FLAG_CODEGEN)
+        set(codegen ld-flag-codegen)
+    else()
+        message(FATAL_ERROR "ld_flag_manifest requires LD_BUILD_FLAG_CODEGEN "
+                            "or LD_FLAG_CODEGEN_EXECUTABLE")
+    endif()
+
+    get_filename_component(manifest "${LD_MANIFEST_MANIFEST}" ABSOLUTE)
+
+    set(directory "${CMAKE_CURRENT_BINARY_DIR}/ld-flag-manifest/${target}")
+    set(output "${directory}/${LD_MANIFEST_OUTPUT}")
+
+    file(MAKE_DIRECTORY "${directory}")
+
+    add_custom_command(
+        OUTPUT  "${output}.h" "${output}.c"
+        COMMAND "${codegen}" "${manifest}" "${output}" "${LD_MANIFEST_PREFIX}"
+        DEPENDS "${codegen}" "${manifest}"
+        COMMENT "Generating flag accessors from ${LD_MANIFEST_MANIFEST}"
+        VERBATIM
+    )
+
+    target_sources(${target} PRIVATE "${output}.h" "${output}.c")
+    target_include_directories(${target} PRIVATE "${directory}")
+endfunction()
@@ -0,0 +1,81 @@
+#include <stdio.h>
+#include <string.h>
+
+#include <launchdarkly/api.h>
+
+#include "assertion.h"
+#include "ldinternal.h"
+#include "utility.h"
+
+#define FLAG_COUNT 3000
+#define ITERATIONS 200
+
+static LDBoolean
+countFlag(
+    const char *const key, const struct LDJSON *const value, void *const context)
+{
+    LD_ASSERT(key);
+    LD_ASSERT(value);
+
+    (*(unsigned int *)context)++;
+
+    return LDBooleanTrue;
+}
+
+int
+main()
+{
+    struct LDConfig *config;
+    struct LDUser *  user;
+    struct LDClient *client;
+    struct LDFlag    flag;
+    struct LDJSON *  all;
+    char             key[64];
+    unsigned int     i, visited;
+    double           start, finish;
+
+    LD_ASSERT(config = LDConfigNew("key"));
+    LDConfigSetOffline(config, LDBooleanTrue);
+    LD_ASSERT(user = LDUserNew("user"));
+    LD_ASSERT(client = LDClientInit(config, user, 0));
+
+    for (i = 0; i < FLAG_COUNT; i++) {
+        snprintf(key, sizeof(key), "diagnostics-flag-%u", i);
+
+        memset(&flag, 0, sizeof(flag));
+        LD_ASSERT(flag.key = LDStrDup(key));
+        LD_ASSERT(flag.value = LDNewText("a short flag value"));
+        flag.version     = 1;
+        flag.flagVersion = -1;
+
+        LD_ASSERT(LDi_storeUpsert(&client->store, flag));
+    }
+
+    LD_ASSERT(LDi_getMonotonicMilliseconds(&start));
+
+    for (i = 0; i < ITERATIONS; i++) {
+        LD_ASSERT(all = LDAllFlags(client));
+        LDJSONFree(all);
+    }
+
+    LD_ASSERT(LDi_getMonotonicMilliseconds(&finish));
+
+    printf("LDAllFlags us/call %f\n", (finish - start) * 1000 / ITERATIONS);
+
+    LD_ASSERT(LDi_getMonotonicMilliseconds(&start));
+
+    for (i = 0; i < ITERATIONS; i++) {
+        visited = 0;
+        LD_ASSERT(LDClientForEachFlag(client, countFlag, &visited));
+        LD_ASSERT(visited == FLAG_COUNT);
+    }
+
+    LD_ASSERT(LDi_getMonotonicMilliseconds(&finish));
+
+    printf("LDClientForEachFlag us/call %f\n",
+        (finish - start) * 1000 / ITERATIONS);
+
+    LDClientClose(client);
+
+    return 0;
+}
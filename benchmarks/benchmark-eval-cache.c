@@ -0,0 +1,62 @@
+#include <stdio.h>
+#include <string.h>
+
+#include <launchdarkly/api.h>
+
+#include "assertion.h"
+#include "ldinternal.h"
+#include "utility.h"
+
+#define ITERATIONS 2000000
+
+static void
+run(const char *const name, const LDBoolean cached)
+{
+    struct LDConfig *config;
+    struct LDUser *  user;
+    struct LDClient *client;
+    struct LDFlag    flag;
+    struct LDJSON *  payload;
+    unsigned int     i;
+    double           start, finish;
+
+    LD_ASSERT(config = LDConfigNew("key"));
+    LDConfigSetOffline(config, LDBooleanTrue);
+    LDConfigSetEvaluationCache(config, cached);
+
+    LD_ASSERT(user = LDUserNew("user"));
+    LD_ASSERT(client = LDClientInit(config, user, 0));
+
+    memset(&flag, 0, sizeof(flag));
+    LD_ASSERT(flag.key = LDStrDup("checkout-flow"));
+    LD_ASSERT(flag.value = LDNewBool(LDBooleanTrue));
+    flag.version     = 12;
+    flag.flagVersion = -1;
+    flag.variation   = 1;
+
+    LD_ASSERT(LDi_storeUpsert(&client->store, flag));
+
+    LD_ASSERT(LDi_getMonotonicMilliseconds(&start));
+
+    for (i = 0; i < ITERATIONS; i++) {
+        LD_ASSERT(LDBoolVariation(client, "checkout-flow", LDBooleanFalse));
+    }
+
+    LD_ASSERT(LDi_getMonotonicMilliseconds(&finish));
+
+    LD_ASSERT(LDi_bundleEventPayload(client->eventProcessor, &payload));
+    LDJSONFree(payload);
+
+    printf("%s ns/eval %f\n", name, (finish - start) * 1000000 / ITERATIONS);
+
+    LDClientClose(client);
+}
+
+int
+main()
+{
+    run("uncached", LDBooleanFalse);
+    run("cached", LDBooleanTrue);
+
+    return 0;
+}
@@ -0,0 +1,78 @@
+#include <stdio.h>
+#include <string.h>
+
+#include <launchdarkly/api.h>
+
+#include "assertion.h"
+#include "ldinternal.h"
+#include "utility.h"
+
+#define EVENT_COUNT 5000
+
+/* Bundles, serializes, and frees a payload of custom events for a single
+ * inlined user, returning its size in bytes. */
+static size_t
+payloadBytes(const LDBoolean deduplicate, double *const micros)
+{
+    struct LDConfig *config;
+    struct LDUser *  user;
+    struct LDClient *client;
+    struct LDJSON *  payload, *iter;
+    char *           serialized;
+    unsigned int     i;
+    size_t           size;
+    double           start, finish;
+
+    LD_ASSERT(config = LDConfigNew("key"));
+    LDConfigSetOffline(config, LDBooleanTrue);
+    LDConfigSetEventsCapacity(config, EVENT_COUNT + 1);
+    LDConfigSetInlineUsersInEvents(config, LDBooleanTrue);
+    LDConfigSetDeduplicateInlineUsers(config, deduplicate);
+
+    LD_ASSERT(user = LDUserNew("user"));
+    LD_ASSERT(LDUserSetFirstName(user, "Ada"));
+    LD_ASSERT(LDUserSetLastName(user, "Lovelace"));
+    LD_ASSERT(LDUserSetEmail(user, "ada@example.com"));
+    LD_ASSERT(LDUserSetCountry(user, "United Kingdom"));
+    LD_ASSERT(client = LDClientInit(config, user, 0));
+
+    for (i = 0; i < EVENT_COUNT; i++) {
+        LDClientTrack(client, "button-clicked");
+    }
+
+    LD_ASSERT(LDi_getMonotonicMilliseconds(&start));
+
+    LD_ASSERT(LDi_bundleEventPayload(client->eventProcessor, &payload));
+    iter = LDGetIter(payload);
+    LD_ASSERT(serialized = LDi_serializeEventBatch(&iter, 0, deduplicate));
+    LDJSONFree(payload);
+
+    LD_ASSERT(LDi_getMonotonicMilliseconds(&finish));
+
+    size    = strlen(serialized);
+    *micros = (finish - start) * 1000;
+
+    LDFree(serialized);
+    LDClientClose(client);
+
+    return size;
+}
+
+int
+main()
+{
+    size_t inlined, deduplicated;
+    double inlinedMicros, deduplicatedMicros;
+
+    inlined      = payloadBytes(LDBooleanFalse, &inlinedMicros);
+    deduplicated = payloadBytes(LDBooleanTrue, &deduplicatedMicros);
+
+    printf("inlined bytes %lu us %f\n", (unsigned long)inlined, inlinedMicros);
+    printf("deduplicated bytes %lu us %f\n", (unsigned long)deduplicated,
+        deduplicatedMicros);
+    printf("saved bytes %lu (%.1f%%)\n",
+        (unsigned long)(inlined - deduplicated),
+        100.0 * (inlined - deduplicated) / inlined);
+
+    return 0;
+}
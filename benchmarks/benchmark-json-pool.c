@@ -0,0 +1,177 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <launchdarkly/api.h>
+
+#include "assertion.h"
+#include "cJSON.h"
+#include "event_processor.h"
+#include "json_pool.h"
+#include "store.h"
+#include "utility.h"
+
+#define ITERATIONS 200000
+/* evaluations between flushes */
+#define BATCH 50
+
+static unsigned long allocations;
+
+static void *
+countingAlloc(const size_t bytes)
+{
+    allocations++;
+
+    return malloc(bytes);
+}
+
+static void
+countingFree(void *const buffer)
+{
+    free(buffer);
+}
+
+static void *
+countingRealloc(void *const buffer, const size_t bytes)
+{
+    allocations++;
+
+    return realloc(buffer, bytes);
+}
+
+static char *
+countingStrDup(const char *const string)
+{
+    char *result;
+
+    allocations++;
+
+    if ((result = (char *)malloc(strlen(string) + 1))) {
+        strcpy(result, string);
+    }
+
+    return result;
+}
+
+static void *
+countingCalloc(const size_t nmemb, const size_t size)
+{
+    allocations++;
+
+    return calloc(nmemb, size);
+}
+
+static char *
+countingStrNDup(const char *const string, const size_t n)
+{
+    char *result;
+
+    allocations++;
+
+    if ((result = (char *)malloc(n + 1))) {
+        memcpy(result, string, n);
+        result[n] = '\0';
+    }
+
+    return result;
+}
+
+/* Evaluates a tracked flag, building feature events and summary counters,
+ * and serializes a payload every BATCH evaluations. Everything allocated
+ * through the cJSON hooks is released before returning, so the hooks may be
+ * changed between runs. */
+static void
+run(const char *const            name,
+    const struct LDConfig *const config,
+    const struct LDUser *const   user)
+{
+    struct LDStore         store;
+    struct LDFlag          flag;
+    struct LDStoreNode *   node;
+    struct EventProcessor *processor;
+    struct LDJSON *        payload;
+    char *                 serialized;
+    unsigned int           i;
+    int                    value, fallback;
+    unsigned long          startAllocations;
+    double                 start, finish;
+
+    LD_ASSERT(LDi_storeInitialize(&store));
+
+    memset(&flag, 0, sizeof(flag));
+    LD_ASSERT(flag.key = LDStrDup("checkout-flow"));
+    LD_ASSERT(flag.value = LDNewBool(LDBooleanTrue));
+    flag.version     = 12;
+    flag.flagVersion = 40;
+    flag.variation   = 1;
+    flag.trackEvents = LDBooleanTrue;
+
+    LD_ASSERT(LDi_storeUpsert(&store, flag));
+    LD_ASSERT(node = LDi_storeGet(&store, "checkout-flow"));
+    LD_ASSERT(processor = LDi_newEventProcessor(config));
+
+    value    = LDBooleanTrue;
+    fallback = LDBooleanFalse;
+
+    startAllocations = allocations;
+
+    LD_ASSERT(LDi_getMonotonicMilliseconds(&start));
+
+    for (i = 0; i < ITERATIONS; i++) {
+        LD_ASSERT(LDi_processEvalEvent(processor, user, "checkout-flow",
+            LDBool, node, &value, &fallback, LDBooleanFalse));
+
+        if ((i + 1) % BATCH == 0) {
+            LD_ASSERT(LDi_bundleEventPayload(processor, &payload));
+            LD_ASSERT(serialized = LDJSONSerialize(payload));
+            LDFree(serialized);
+            LDJSONFree(payload);
+        }
+    }
+
+    LD_ASSERT(LDi_getMonotonicMilliseconds(&finish));
+
+    printf("%s allocations/eval %f ns/eval %f\n", name,
+        (double)(allocations - startAllocations) / ITERATIONS,
+        (finish - start) * 1000000 / ITERATIONS);
+
+    LDi_freeEventProcessor(processor);
+    LDi_rc_decrement(&node->rc);
+    LDi_storeDestroy(&store);
+}
+
+int
+main()
+{
+    struct LDConfig *  config;
+    struct LDUser *    user;
+    struct cJSON_Hooks hooks;
+
+    LDSetMemoryRoutines(countingAlloc, countingFree, countingRealloc,
+        countingStrDup, countingCalloc, countingStrNDup);
+
+    LDGlobalInit();
+
+    LD_ASSERT(config = LDConfigNew("key"));
+    LDConfigSetOffline(config, LDBooleanTrue);
+    LD_ASSERT(user = LDUserNew("user-key"));
+
+    run("default", config, user);
+
+    LD_ASSERT(LDi_jsonPoolInitialize());
+
+    hooks.malloc_fn = LDi_jsonPoolAllocate;
+    hooks.free_fn   = LDi_jsonPoolFree;
+    cJSON_InitHooks(&hooks);
+
+    run("pooled", config, user);
+
+    hooks.malloc_fn = LDAlloc;
+    hooks.free_fn   = LDFree;
+    cJSON_InitHooks(&hooks);
+
+    LDUserFree(user);
+    LDConfigFree(config);
+
+    return 0;
+}
@@ -0,0 +1,158 @@
+#include <stdio.h>
+#include <string.h>
+
+#include <launchdarkly/api.h>
+
+#include "assertion.h"
+#include "scan.h"
+#include "sse.h"
+#include "utility.h"
+
+#define FLAG_COUNT 20000
+#define ITERATIONS 20
+
+static size_t
+scanScalar(const char *const buffer, const size_t length)
+{
+    size_t i;
+
+    for (i = 0; i < length; i++) {
+        if (buffer[i] == '"' || buffer[i] == '\\') {
+            return i;
+        }
+    }
+
+    return length;
+}
+
+/* Builds a put payload with long string values, similar to the bodies
+ * of large environments. */
+static char *
+makePayload(size_t *const length)
+{
+    struct LDJSON *payload, *flag;
+    char           key[64];
+    unsigned int   i;
+    char *         serialized;
+
+    LD_ASSERT(payload = LDNewObject());
+
+    for (i = 0; i < FLAG_COUNT; i++) {
+        snprintf(key, sizeof(key), "remote-configuration-flag-%u", i);
+
+        LD_ASSERT(flag = LDNewObject());
+        LD_ASSERT(LDObjectSetKey(flag, "value", LDNewText(
+            "a remote configuration value that is long enough to cover "
+            "several vector widths, with an \"escaped\" section in it")));
+        LD_ASSERT(LDObjectSetKey(flag, "version", LDNewNumber(i)));
+        LD_ASSERT(LDObjectSetKey(flag, "variation", LDNewNumber(1)));
+        LD_ASSERT(LDObjectSetKey(payload, key, flag));
+    }
+
+    LD_ASSERT(serialized = LDJSONSerialize(payload));
+    LDJSONFree(payload);
+
+    *length = strlen(serialized);
+
+    return serialized;
+}
+
+static double
+timeScan(
+    size_t (*scan)(const char *const, const size_t),
+    const char *const buffer,
+    const size_t      length)
+{
+    unsigned int i;
+    size_t       offset, found;
+    double       start, finish;
+
+    found = 0;
+
+    LD_ASSERT(LDi_getMonotonicMilliseconds(&start));
+
+    for (i = 0; i < ITERATIONS; i++) {
+        for (offset = 0; offset < length; offset++) {
+            offset += scan(buffer + offset, length - offset);
+            found++;
+        }
+    }
+
+    LD_ASSERT(LDi_getMonotonicMilliseconds(&finish));
+
+    LD_ASSERT(found);
+
+    return (finish - start) / ITERATIONS;
+}
+
+static LDBoolean
+discardEvent(const char *const name, const char *const body, void *const ctx)
+{
+    LD_ASSERT(name);
+    LD_ASSERT(body);
+    LD_ASSERT(ctx == NULL);
+
+    return LDBooleanTrue;
+}
+
+int
+main()
+{
+    char *             payload, *event;
+    size_t             length;
+    unsigned int       i;
+    double             start, finish;
+    struct LDJSON *    parsed;
+    struct LDSSEParser parser;
+
+    payload = makePayload(&length);
+
+    printf("kernel %s payload bytes %lu\n", LDi_scanKernelName(),
+        (unsigned long)length);
+
+    printf("string scan scalar ms %f\n", timeScan(scanScalar, payload, length));
+    printf("string scan vector ms %f\n",
+        timeScan(LDi_scanForQuoteOrBackslash, payload, length));
+
+    LD_ASSERT(LDi_getMonotonicMilliseconds(&start));
+
+    for (i = 0; i < ITERATIONS; i++) {
+        LD_ASSERT(parsed = LDJSONDeserialize(payload));
+        LDJSONFree(parsed);
+    }
+
+    LD_ASSERT(LDi_getMonotonicMilliseconds(&finish));
+
+    printf("deserialize ms %f\n", (finish - start) / ITERATIONS);
+
+    LD_ASSERT(event = LDAlloc(length + 32));
+    memcpy(event, "event: put\ndata: ", 17);
+    memcpy(event + 17, payload, length);
+    memcpy(event + 17 + length, "\n\n", 3);
+
+    LD_ASSERT(LDi_getMonotonicMilliseconds(&start));
+
+    for (i = 0; i < ITERATIONS; i++) {
+        const size_t eventLength = length + 19;
+        size_t       offset;
+
+        LDSSEParserInitialize(&parser, discardEvent, NULL);
+
+        /* deliver in chunks the size of a typical network read */
+        for (offset = 0; offset < eventLength; offset += 16384) {
+            LD_ASSERT(LDSSEParserProcess(&parser, event + offset,
+                eventLength - offset < 16384 ? eventLength - offset : 16384));
+        }
+
+        LDSSEParserDestroy(&parser);
+    }
+
+    LD_ASSERT(LDi_getMonotonicMilliseconds(&finish));
+
+    printf("sse parse ms %f\n", (finish - start) / ITERATIONS);
+
+    LDFree(event);
+    LDFree(payload);
+
+    return 0;
+}
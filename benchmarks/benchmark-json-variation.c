@@ -0,0 +1,87 @@
+#include <stdio.h>
+#include <string.h>
+
+#include <launchdarkly/api.h>
+
+#include "assertion.h"
+#include "ldinternal.h"
+#include "utility.h"
+
+#define MEMBER_COUNT 2000
+#define ITERATIONS 2000
+
+/* Builds a remote configuration object of roughly 100 KB. */
+static struct LDJSON *
+makeValue(void)
+{
+    struct LDJSON *value;
+    char           key[32];
+    unsigned int   i;
+
+    LD_ASSERT(value = LDNewObject());
+
+    for (i = 0; i < MEMBER_COUNT; i++) {
+        snprintf(key, sizeof(key), "setting-%u", i);
+
+        LD_ASSERT(LDObjectSetKey(
+            value, key, LDNewText("a configuration value of moderate size")));
+    }
+
+    return value;
+}
+
+int
+main()
+{
+    struct LDConfig *   config;
+    struct LDUser *     user;
+    struct LDClient *   client;
+    struct LDFlag       flag;
+    struct LDJSON *     fallback, *copy;
+    LDBorrowedJSON      borrowed;
+    unsigned int        i;
+    double              start, finish;
+
+    LD_ASSERT(config = LDConfigNew("key"));
+    LDConfigSetOffline(config, LDBooleanTrue);
+    LD_ASSERT(user = LDUserNew("user"));
+    LD_ASSERT(client = LDClientInit(config, user, 0));
+
+    memset(&flag, 0, sizeof(flag));
+    LD_ASSERT(flag.key = LDStrDup("remote-config"));
+    flag.value       = makeValue();
+    flag.version     = 1;
+    flag.flagVersion = -1;
+
+    LD_ASSERT(LDi_storeUpsert(&client->store, flag));
+    LD_ASSERT(fallback = LDNewNull());
+
+    LD_ASSERT(LDi_getMonotonicMilliseconds(&start));
+
+    for (i = 0; i < ITERATIONS; i++) {
+        LD_ASSERT(copy = LDJSONVariation(client, "remote-config", fallback));
+        LDJSONFree(copy);
+    }
+
+    LD_ASSERT(LDi_getMonotonicMilliseconds(&finish));
+
+    printf("LDJSONVariation us/read %f\n", (finish - start) * 1000 / ITERATIONS);
+
+    LD_ASSERT(LDi_getMonotonicMilliseconds(&start));
+
+    for (i = 0; i < ITERATIONS; i++) {
+        LD_ASSERT(LDJSONVariationBorrow(
+            client, "remote-config", fallback, &borrowed));
+        LDBorrowedJSONRelease(&borrowed);
+    }
+
+    LD_ASSERT(LDi_getMonotonicMilliseconds(&finish));
+
+    printf("LDJSONVariationBorrow us/read %f\n",
+        (finish - start) * 1000 / ITERATIONS);
+
+    LDJSONFree(fallback);
+    LDClientClose(client);
+
+    return 0;
+}
@@ -0,0 +1,94 @@
+#include <stdio.h>
+#include <string.h>
+
+#include <launchdarkly/api.h>
+
+#include "assertion.h"
+#include "ldinternal.h"
+#include "utility.h"
+
+#define FLAG_COUNT 2000
+#define LISTENER_COUNT 500
+#define ITERATIONS 50
+
+static unsigned long notifications = 0;
+
+static void
+countNotification(const char *const key, const int status)
+{
+    LD_ASSERT(key);
+    LD_ASSERT(status == 0);
+
+    notifications++;
+}
+
+static struct LDFlag *
+makeFlags(const int version)
+{
+    struct LDFlag *flags;
+    char           key[32];
+    unsigned int   i;
+
+    LD_ASSERT(flags = LDAlloc(sizeof(struct LDFlag) * FLAG_COUNT));
+
+    memset(flags, 0, sizeof(struct LDFlag) * FLAG_COUNT);
+
+    for (i = 0; i < FLAG_COUNT; i++) {
+        snprintf(key, sizeof(key), "flag-%u", i);
+
+        LD_ASSERT(flags[i].key = LDStrDup(key));
+        LD_ASSERT(flags[i].value = LDNewNumber(version));
+        flags[i].version     = version;
+        flags[i].flagVersion = -1;
+        flags[i].variation   = 1;
+    }
+
+    return flags;
+}
+
+int
+main()
+{
+    struct LDConfig *config;
+    struct LDUser *  user;
+    struct LDClient *client;
+    struct LDFlag *  payloads[ITERATIONS];
+    char             key[32];
+    unsigned int     i;
+    double           start, finish;
+
+    LD_ASSERT(config = LDConfigNew("key"));
+    LDConfigSetOffline(config, LDBooleanTrue);
+
+    LD_ASSERT(user = LDUserNew("user"));
+    LD_ASSERT(client = LDClientInit(config, user, 0));
+
+    /* every fourth flag has a listener */
+    for (i = 0; i < LISTENER_COUNT; i++) {
+        snprintf(key, sizeof(key), "flag-%u", i * 4);
+
+        LD_ASSERT(LDClientRegisterFeatureFlagListener(
+            client, key, countNotification));
+    }
+
+    for (i = 0; i < ITERATIONS; i++) {
+        payloads[i] = makeFlags(i + 1);
+    }
+
+    LD_ASSERT(LDi_getMonotonicMilliseconds(&start));
+
+    for (i = 0; i < ITERATIONS; i++) {
+        LD_ASSERT(LDi_storePut(&client->store, payloads[i], FLAG_COUNT));
+    }
+
+    LD_ASSERT(LDi_getMonotonicMilliseconds(&finish));
+
+    LD_ASSERT(notifications == LISTENER_COUNT * ITERATIONS);
+
+    printf("flags %u listeners %u ms/put %f\n", FLAG_COUNT, LISTENER_COUNT,
+        (finish - start) / ITERATIONS);
+
+    LDClientClose(client);
+
+    return 0;
+}
@@ -0,0 +1,103 @@
+#include <stdio.h>
+#include <string.h>
+
+#include <launchdarkly/api.h>
+
+#include "assertion.h"
+#include "ldinternal.h"
+#include "utility.h"
+
+#define FLAG_COUNT 20
+#define FRAMES 100000
+
+static char      keys[FLAG_COUNT][64];
+static LDFlagKey prepared[FLAG_COUNT];
+/* the same keys, resolved through the flag manifest */
+static LDFlagKey slotted[FLAG_COUNT];
+
+static void
+prepareKey(const unsigned int index)
+{
+    snprintf(keys[index], sizeof(keys[index]),
+        "product-area-experiment-frame-flag-%u", index);
+
+    LDFlagKeyInit(&prepared[index], keys[index]);
+
+    slotted[index]      = prepared[index];
+    slotted[index].slot = index + 1;
+}
+
+static void
+addFlag(struct LDClient *const client, const unsigned int index)
+{
+    struct LDFlag flag;
+
+    memset(&flag, 0, sizeof(flag));
+    LD_ASSERT(flag.key = LDStrDup(keys[index]));
+    LD_ASSERT(flag.value = LDNewNumber(index));
+    flag.version     = 12;
+    flag.flagVersion = -1;
+    flag.variation   = 1;
+
+    LD_ASSERT(LDi_storeUpsert(&client->store, flag));
+}
+
+/* Reads every flag once per frame, by name or through prepared keys. */
+static void
+run(struct LDClient *const client, const LDFlagKey *const prepare,
+    const char *const label)
+{
+    struct LDJSON *payload;
+    unsigned int   frame, i;
+    double         start, finish;
+
+    LD_ASSERT(LDi_getMonotonicMilliseconds(&start));
+
+    for (frame = 0; frame < FRAMES; frame++) {
+        for (i = 0; i < FLAG_COUNT; i++) {
+            if (prepare) {
+                LD_ASSERT(LDIntVariationKey(client, &prepare[i], -1) == (int)i);
+            } else {
+                LD_ASSERT(LDIntVariation(client, keys[i], -1) == (int)i);
+            }
+        }
+    }
+
+    LD_ASSERT(LDi_getMonotonicMilliseconds(&finish));
+
+    LD_ASSERT(LDi_bundleEventPayload(client->eventProcessor, &payload));
+    LDJSONFree(payload);
+
+    printf("%s us/frame %f\n", label, (finish - start) * 1000 / FRAMES);
+}
+
+int
+main()
+{
+    struct LDConfig *config;
+    struct LDUser *  user;
+    struct LDClient *client;
+    unsigned int     i;
+
+    for (i = 0; i < FLAG_COUNT; i++) {
+        prepareKey(i);
+    }
+
+    LD_ASSERT(config = LDConfigNew("key"));
+    LDConfigSetOffline(config, LDBooleanTrue);
+    LDConfigSetFlagManifest(config, slotted, FLAG_COUNT);
+    LD_ASSERT(user = LDUserNew("user"));
+    LD_ASSERT(client = LDClientInit(config, user, 0));
+
+    for (i = 0; i < FLAG_COUNT; i++) {
+        addFlag(client, i);
+    }
+
+    run(client, NULL, "plain");
+    run(client, prepared, "prepared");
+    run(client, slotted, "slotted");
+
+    LDClientClose(client);
+
+    return 0;
+}
@@ -0,0 +1,76 @@
+#include <stdio.h>
+
+#include <launchdarkly/api.h>
+
+#include "assertion.h"
+#include "cJSON.h"
+#include "utility.h"
+
+#define EVENT_COUNT 100
+#define ITERATIONS 2000
+
+/* Builds a payload shaped like a flush of feature and custom events. */
+static struct LDJSON *
+makePayload(void)
+{
+    struct LDJSON *payload, *event;
+    unsigned int   i;
+
+    LD_ASSERT(payload = LDNewArray());
+
+    for (i = 0; i < EVENT_COUNT; i++) {
+        LD_ASSERT(event = LDNewObject());
+        LD_ASSERT(LDObjectSetKey(event, "kind", LDNewText("feature")));
+        LD_ASSERT(LDObjectSetKey(
+            event, "creationDate", LDNewNumber(1609459200000.0 + i)));
+        LD_ASSERT(LDObjectSetKey(event, "key", LDNewText("checkout-flow")));
+        LD_ASSERT(LDObjectSetKey(event, "userKey", LDNewText("user-key")));
+        LD_ASSERT(LDObjectSetKey(event, "value", LDNewBool(i % 2)));
+        LD_ASSERT(LDObjectSetKey(event, "default", LDNewBool(LDBooleanFalse)));
+        LD_ASSERT(LDObjectSetKey(event, "version", LDNewNumber(42)));
+        LD_ASSERT(LDObjectSetKey(event, "variation", LDNewNumber(i % 2)));
+        LD_ASSERT(LDObjectSetKey(event, "metricValue", LDNewNumber(i * 0.25)));
+        LD_ASSERT(LDArrayPush(payload, event));
+    }
+
+    return payload;
+}
+
+int
+main()
+{
+    struct LDJSON *payload;
+    char *         serialized;
+    unsigned int   i;
+    double         start, finish;
+
+    payload = makePayload();
+
+    LD_ASSERT(LDi_getMonotonicMilliseconds(&start));
+
+    for (i = 0; i < ITERATIONS; i++) {
+        LD_ASSERT(serialized = cJSON_PrintUnformatted((cJSON *)payload));
+        cJSON_free(serialized);
+    }
+
+    LD_ASSERT(LDi_getMonotonicMilliseconds(&finish));
+
+    printf("cJSON_PrintUnformatted us/payload %f\n",
+        (finish - start) * 1000 / ITERATIONS);
+
+    LD_ASSERT(LDi_getMonotonicMilliseconds(&start));
+
+    for (i = 0; i < ITERATIONS; i++) {
+        LD_ASSERT(serialized = LDJSONSerialize(payload));
+        LDFree(serialized);
+    }
+
+    LD_ASSERT(LDi_getMonotonicMilliseconds(&finish));
+
+    printf("LDJSONSerialize us/payload %f\n",
+        (finish - start) * 1000 / ITERATIONS);
+
+    LDJSONFree(payload);
+
+    return 0;
+}
@@ -0,0 +1,94 @@
+#include <stdio.h>
+#include <string.h>
+
+#include <launchdarkly/api.h>
+
+#include "assertion.h"
+#include "ldinternal.h"
+#include "utility.h"
+
+#define FLAG_COUNT 20
+#define FRAMES 100000
+
+static char keys[FLAG_COUNT][32];
+
+static void
+addFlag(struct LDClient *const client, const unsigned int index)
+{
+    struct LDFlag flag;
+
+    snprintf(keys[index], sizeof(keys[index]), "frame-flag-%u", index);
+
+    memset(&flag, 0, sizeof(flag));
+    LD_ASSERT(flag.key = LDStrDup(keys[index]));
+    LD_ASSERT(flag.value = LDNewNumber(index));
+    flag.version     = 12;
+    flag.flagVersion = -1;
+    flag.variation   = 1;
+
+    LD_ASSERT(LDi_storeUpsert(&client->store, flag));
+}
+
+/* Reads every flag once per frame, as a game or UI loop would. */
+static void
+run(struct LDClient *const client, const LDBoolean snapshots)
+{
+    struct LDClientSnapshot *snapshot;
+    struct LDJSON *          payload;
+    unsigned int             frame, i;
+    double                   start, finish;
+
+    LD_ASSERT(LDi_getMonotonicMilliseconds(&start));
+
+    for (frame = 0; frame < FRAMES; frame++) {
+        snapshot = NULL;
+
+        if (snapshots) {
+            LD_ASSERT(snapshot = LDClientSnapshotAcquire(client));
+        }
+
+        for (i = 0; i < FLAG_COUNT; i++) {
+            if (snapshots) {
+                LD_ASSERT(LDSnapshotIntVariation(snapshot, keys[i], -1) == (int)i);
+            } else {
+                LD_ASSERT(LDIntVariation(client, keys[i], -1) == (int)i);
+            }
+        }
+
+        LDClientSnapshotRelease(snapshot);
+    }
+
+    LD_ASSERT(LDi_getMonotonicMilliseconds(&finish));
+
+    LD_ASSERT(LDi_bundleEventPayload(client->eventProcessor, &payload));
+    LDJSONFree(payload);
+
+    printf("%s us/frame %f\n", snapshots ? "snapshot" : "client",
+        (finish - start) * 1000 / FRAMES);
+}
+
+int
+main()
+{
+    struct LDConfig *config;
+    struct LDUser *  user;
+    struct LDClient *client;
+    unsigned int     i;
+
+    LD_ASSERT(config = LDConfigNew("key"));
+    LDConfigSetOffline(config, LDBooleanTrue);
+
+    LD_ASSERT(user = LDUserNew("user"));
+    LD_ASSERT(client = LDClientInit(config, user, 0));
+
+    for (i = 0; i < FLAG_COUNT; i++) {
+        addFlag(client, i);
+    }
+
+    run(client, LDBooleanFalse);
+    run(client, LDBooleanTrue);
+
+    LDClientClose(client);
+
+    return 0;
+}
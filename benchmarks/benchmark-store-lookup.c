@@ -0,0 +1,151 @@
+#include <stdio.h>
+#include <string.h>
+
+#include <launchdarkly/api.h>
+
+#include "assertion.h"
+#include "flag_index.h"
+#include "store.h"
+#include "utility.h"
+#include "uthash.h"
+
+#define TOTAL_OPS 10000000 /* 10 million */
+
+/* The layout the store used before the flat index, kept for comparison. */
+struct ChainedNode
+{
+    struct LDStoreNode *node;
+    UT_hash_handle      hh;
+};
+
+static char **
+makeKeys(const unsigned int count, const char *const format)
+{
+    char **      keys;
+    char         buffer[64];
+    unsigned int i;
+
+    LD_ASSERT(keys = LDAlloc(sizeof(char *) * count));
+
+    for (i = 0; i < count; i++) {
+        snprintf(buffer, sizeof(buffer), format, i);
+        LD_ASSERT(keys[i] = LDStrDup(buffer));
+    }
+
+    return keys;
+}
+
+static double
+benchChained(
+    struct ChainedNode *const table,
+    char **const              keys,
+    const unsigned int        count)
+{
+    struct ChainedNode *lookup;
+    unsigned int        i, found;
+    double              start, finish;
+
+    found = 0;
+
+    LD_ASSERT(LDi_getMonotonicMilliseconds(&start));
+
+    for (i = 0; i < TOTAL_OPS; i++) {
+        HASH_FIND_STR(table, keys[i % count], lookup);
+
+        if (lookup) {
+            found++;
+        }
+    }
+
+    LD_ASSERT(LDi_getMonotonicMilliseconds(&finish));
+
+    LD_ASSERT(found == 0 || found == TOTAL_OPS);
+
+    return ((finish - start) * 1000000) / TOTAL_OPS;
+}
+
+static double
+benchIndex(
+    const struct LDFlagIndex *const index,
+    char **const                    keys,
+    const unsigned int              count)
+{
+    unsigned int i, found;
+    double       start, finish;
+
+    found = 0;
+
+    LD_ASSERT(LDi_getMonotonicMilliseconds(&start));
+
+    for (i = 0; i < TOTAL_OPS; i++) {
+        if (LDi_flagIndexFind(index, keys[i % count])) {
+            found++;
+        }
+    }
+
+    LD_ASSERT(LDi_getMonotonicMilliseconds(&finish));
+
+    LD_ASSERT(found == 0 || found == TOTAL_OPS);
+
+    return ((finish - start) * 1000000) / TOTAL_OPS;
+}
+
+static void
+benchSize(const unsigned int count)
+{
+    struct LDStoreNode *nodes, *previous;
+    struct ChainedNode *chained, *table;
+    struct LDFlagIndex  index;
+    char **             hits, **misses;
+    unsigned int        i;
+
+    hits   = makeKeys(count, "release-feature-flag-%u");
+    misses = makeKeys(count, "missing-feature-flag-%u");
+
+    LD_ASSERT(nodes = LDAlloc(sizeof(struct LDStoreNode) * count));
+    LD_ASSERT(chained = LDAlloc(sizeof(struct ChainedNode) * count));
+
+    table = NULL;
+    LDi_flagIndexInitialize(&index);
+
+    for (i = 0; i < count; i++) {
+        memset(&nodes[i], 0, sizeof(struct LDStoreNode));
+        nodes[i].flag.key = hits[i];
+        chained[i].node   = &nodes[i];
+
+        HASH_ADD_KEYPTR(hh, table, hits[i], strlen(hits[i]), &chained[i]);
+        LD_ASSERT(LDi_flagIndexInsert(&index, &nodes[i], &previous));
+    }
+
+    printf(
+        "flags %5u uthash hit ns/op %7.2f miss ns/op %7.2f | "
+        "flat index hit ns/op %7.2f miss ns/op %7.2f\n",
+        count,
+        benchChained(table, hits, count),
+        benchChained(table, misses, count),
+        benchIndex(&index, hits, count),
+        benchIndex(&index, misses, count));
+
+    HASH_CLEAR(hh, table);
+    LDi_flagIndexClear(&index);
+
+    for (i = 0; i < count; i++) {
+        LDFree(hits[i]);
+        LDFree(misses[i]);
+    }
+
+    LDFree(hits);
+    LDFree(misses);
+    LDFree(nodes);
+    LDFree(chained);
+}
+
+int
+main()
+{
+    benchSize(100);
+    benchSize(1000);
+    benchSize(10000);
+
+    return 0;
+}
@@ -0,0 +1,78 @@
+#include <stdio.h>
+#include <string.h>
+
+#include <launchdarkly/api.h>
+
+#include "assertion.h"
+#include "ldinternal.h"
+#include "utility.h"
+
+#define EVENT_COUNT 10000
+
+/* Telemetry that arrives already serialized. */
+static const char *const data =
+    "{\"screen\":\"checkout\",\"durationMillis\":1834,\"items\":[{\"sku\":"
+    "\"A-1001\",\"quantity\":2,\"price\":19.99},{\"sku\":\"B-2002\","
+    "\"quantity\":1,\"price\":5.25}],\"coupon\":null,\"express\":true}";
+
+/* Tracks the data either parsed into a tree or raw, then bundles and
+ * serializes the payload as the events thread would. */
+static void
+run(struct LDClient *const client, const LDBoolean raw)
+{
+    struct LDJSON *payload, *iter;
+    char *         serialized;
+    unsigned int   i;
+    size_t         length;
+    double         start, tracked, finish;
+
+    length = strlen(data);
+
+    LD_ASSERT(LDi_getMonotonicMilliseconds(&start));
+
+    for (i = 0; i < EVENT_COUNT; i++) {
+        if (raw) {
+            LD_ASSERT(LDClientTrackRawJSON(client, "checkout", data, length));
+        } else {
+            LDClientTrackData(client, "checkout", LDJSONDeserialize(data));
+        }
+    }
+
+    LD_ASSERT(LDi_getMonotonicMilliseconds(&tracked));
+
+    LD_ASSERT(LDi_bundleEventPayload(client->eventProcessor, &payload));
+    iter = LDGetIter(payload);
+    LD_ASSERT(serialized = LDi_serializeEventBatch(&iter, 0, LDBooleanFalse));
+
+    LD_ASSERT(LDi_getMonotonicMilliseconds(&finish));
+
+    printf("%s track us/event %f serialize us/event %f\n",
+        raw ? "LDClientTrackRawJSON" : "LDClientTrackData",
+        (tracked - start) * 1000 / EVENT_COUNT,
+        (finish - tracked) * 1000 / EVENT_COUNT);
+
+    LDFree(serialized);
+    LDJSONFree(payload);
+}
+
+int
+main()
+{
+    struct LDConfig *config;
+    struct LDUser *  user;
+    struct LDClient *client;
+
+    LD_ASSERT(config = LDConfigNew("key"));
+    LDConfigSetOffline(config, LDBooleanTrue);
+    LDConfigSetEventsCapacity(config, EVENT_COUNT + 1);
+
+    LD_ASSERT(user = LDUserNew("user"));
+    LD_ASSERT(client = LDClientInit(config, user, 0));
+
+    run(client, LDBooleanFalse);
+    run(client, LDBooleanTrue);
+
+    LDClientClose(client);
+
+    return 0;
+}
@@ -0,0 +1,76 @@
+#include <stdio.h>
+
+#include <launchdarkly/api.h>
+
+#include "assertion.h"
+#include "concurrency.h"
+#include "ldinternal.h"
+#include "utility.h"
+
+#define THREAD_COUNT 4
+#define EVENTS_PER_THREAD 2500
+
+static struct LDClient *client;
+
+/* Records custom events with data, as an instrumented app thread would. */
+static THREAD_RETURN
+produce(void *const unused)
+{
+    struct LDJSON *data;
+    unsigned int   i;
+
+    (void)unused;
+
+    for (i = 0; i < EVENTS_PER_THREAD; i++) {
+        LD_ASSERT(data = LDNewObject());
+        LD_ASSERT(LDObjectSetKey(data, "index", LDNewNumber(i)));
+        LD_ASSERT(LDObjectSetKey(data, "screen", LDNewText("checkout")));
+
+        LDClientTrackData(client, "button-clicked", data);
+    }
+
+    return THREAD_RETURN_DEFAULT;
+}
+
+int
+main()
+{
+    struct LDConfig *config;
+    struct LDUser *  user;
+    struct LDJSON *  payload;
+    ld_thread_t      threads[THREAD_COUNT];
+    unsigned int     i;
+    double           start, finish;
+
+    LD_ASSERT(config = LDConfigNew("key"));
+    LDConfigSetOffline(config, LDBooleanTrue);
+    LDConfigSetEventsCapacity(config, THREAD_COUNT * EVENTS_PER_THREAD);
+    LDConfigSetInlineUsersInEvents(config, LDBooleanTrue);
+
+    LD_ASSERT(user = LDUserNew("user"));
+    LD_ASSERT(LDUserSetFirstName(user, "Ada"));
+    LD_ASSERT(client = LDClientInit(config, user, 0));
+
+    LD_ASSERT(LDi_getMonotonicMilliseconds(&start));
+
+    for (i = 0; i < THREAD_COUNT; i++) {
+        LD_ASSERT(LDi_thread_create(&threads[i], produce, NULL));
+    }
+
+    for (i = 0; i < THREAD_COUNT; i++) {
+        LD_ASSERT(LDi_thread_join(&threads[i]));
+    }
+
+    LD_ASSERT(LDi_getMonotonicMilliseconds(&finish));
+
+    LD_ASSERT(LDi_bundleEventPayload(client->eventProcessor, &payload));
+    LD_ASSERT(LDCollectionGetSize(payload) == THREAD_COUNT * EVENTS_PER_THREAD);
+    LDJSONFree(payload);
+
+    printf("%u threads us/event %f\n", THREAD_COUNT,
+        (finish - start) * 1000 / (THREAD_COUNT * EVENTS_PER_THREAD));
+
+    LDClientClose(client);
+
+    return 0;
+}
@@ -32,5 +32,14 @@ LDSetMemoryRoutines(
     void *(*const newCalloc)(const size_t, const size_t),
     char *(*const newStrNDup)(const char *const, const size_t));
 
+/**
+ * @brief Serve small JSON allocations from per thread free lists.
+ *
+ * Reduces allocator traffic when constructing events and values. Memory is
+ * still obtained through the routines given to `LDSetMemoryRoutines`. Must
+ * be called before `LDGlobalInit`, calls made afterwards have no effect.
+ */
+LD_EXPORT(void) LDEnableJSONPooling(void);
+
 /** @brief Must be called once before any other API function */
 LD_EXPORT(void) LDGlobalInit(void);
@@ -56,6 +56,8 @@
 #endif
 
 #include "cJSON.h"
+#include "json_index.h"
+#include "scan.h"
 
 /* define our own boolean type */
 #ifdef true
@@ -244,6 +246,8 @@ CJSON_PUBLIC(void) cJSON_Delete(cJSON *item)
         if (!(item->type & cJSON_StringIsConst) && (item->string != NULL)) {
             global_hooks.deallocate(item->string);
         }
+        /* a reference builds its own index, it is not shared */
+        LDi_objectIndexFree(item->index);
         global_hooks.deallocate(item);
         item = next;
     }
@@ -686,22 +690,31 @@ parse_string(cJSON *const item, parse_buffer *const input_buffer)
         /* calculate approximate size of the output (overestimate) */
         size_t allocation_length = 0;
         size_t skipped_bytes     = 0;
-        while (((size_t)(input_end - input_buffer->content) <
-                input_buffer->length) &&
-               (*input_end != '\"'))
+        while ((size_t)(input_end - input_buffer->content) <
+               input_buffer->length)
         {
+            /* skip to the next quote or escape sequence in wide steps */
+            input_end += LDi_scanForQuoteOrBackslash(
+                (const char *)input_end,
+                input_buffer->length -
+                    (size_t)(input_end - input_buffer->content));
+
+            if (((size_t)(input_end - input_buffer->content) >=
+                 input_buffer->length) ||
+                (*input_end == '\"'))
+            {
+                break;
+            }
+
             /* is escape sequence */
-            if (input_end[0] == '\\') {
-                if ((size_t)(input_end + 1 - input_buffer->content) >=
-                    input_buffer->length) {
-                    /* prevent buffer overflow when last input character is a
-                     * backslash */
-                    goto fail;
-                }
-                skipped_bytes++;
-                input_end++;
+            if ((size_t)(input_end + 1 - input_buffer->content) >=
+                input_buffer->length) {
+                /* prevent buffer overflow when last input character is a
+                 * backslash */
+                goto fail;
             }
-            input_end++;
+            skipped_bytes++;
+            input_end += 2;
         }
         if (((size_t)(input_end - input_buffer->content) >=
              input_buffer->length) ||
@@ -725,7 +738,16 @@ parse_string(cJSON *const item, parse_buffer *const input_buffer)
     /* loop through the string literal */
     while (input_pointer < input_end) {
         if (*input_pointer != '\\') {
-            *output_pointer++ = *input_pointer++;
+            /* copy the run of literal characters up to the next escape */
+            const size_t run = LDi_scanForEither(
+                (const char *)input_pointer,
+                (size_t)(input_end - input_pointer),
+                '\\',
+                '\\');
+
+            memcpy(output_pointer, input_pointer, run);
+            output_pointer += run;
+            input_pointer += run;
         }
         /* escape sequence */
         else
@@ -1721,10 +1743,21 @@ get_object_item(
 
     current_element = object->child;
     if (case_sensitive) {
+        size_t walked = 0;
+
+        if (LDi_objectIndexLookup(object, name, &current_element)) {
+            return current_element;
+        }
+
         while ((current_element != NULL) && (current_element->string != NULL) &&
                (strcmp(name, current_element->string) != 0))
         {
             current_element = current_element->next;
+            walked++;
+        }
+
+        if (walked >= LD_OBJECT_INDEX_THRESHOLD) {
+            LDi_objectIndexBuild(object);
         }
     } else {
         while ((current_element != NULL) &&
@@ -1786,6 +1819,7 @@ create_reference(const cJSON *item, const internal_hooks *const hooks)
 
     memcpy(reference, item, sizeof(cJSON));
     reference->string = NULL;
+    reference->index  = NULL;
     reference->type |= cJSON_IsReference;
     reference->next = reference->prev = NULL;
     return reference;
@@ -1806,13 +1840,20 @@ add_item_to_array(cJSON *array, cJSON *item)
         /* list is empty, start new one */
         array->child = item;
     } else {
-        /* append to the end */
+        /* append to the end, which an index already knows */
+        cJSON *const tail = LDi_objectIndexTail(array);
+
+        if (tail != NULL) {
+            child = tail;
+        }
         while (child->next) {
             child = child->next;
         }
         suffix_object(child, item);
     }
 
+    LDi_objectIndexAppended(array, item);
+
     return true;
 }
 
@@ -2035,6 +2076,8 @@ cJSON_DetachItemViaPointer(cJSON *parent, cJSON *const item)
         return NULL;
     }
 
+    LDi_objectIndexDetaching(parent, item);
+
     if (item->prev != NULL) {
         /* not the first element */
         item->prev->next = item->next;
@@ -2113,6 +2156,8 @@ cJSON_InsertItemInArray(cJSON *array, int which, cJSON *newitem)
         return;
     }
 
+    LDi_objectIndexInvalidate(array);
+
     newitem->next        = after_inserted;
     newitem->prev        = after_inserted->prev;
     after_inserted->prev = newitem;
@@ -2135,6 +2180,8 @@ cJSON_ReplaceItemViaPointer(
         return true;
     }
 
+    LDi_objectIndexInvalidate(parent);
+
     replacement->next = item->next;
     replacement->prev = item->prev;
 
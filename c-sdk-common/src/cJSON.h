@@ -131,6 +131,9 @@ typedef struct cJSON
     /* The item's name string, if this item is the child of, or is in the list
      * of subitems of an object. */
     char *string;
+
+    /* Hash index over the members of a large object, see json_index.h */
+    struct LDObjectIndex *index;
 } cJSON;
 
 typedef struct cJSON_Hooks
@@ -617,7 +617,8 @@ LDi_cond_wait_imp(
     LD_ASSERT(mutex);
 
 #ifdef _WIN32
-    status = SleepConditionVariableCS(cond, mutex, milliseconds);
+    /* LD_COND_WAIT_FOREVER converts to INFINITE */
+    status = SleepConditionVariableCS(cond, mutex, (DWORD)milliseconds);
 
     if (status == 0) {
         if (GetLastError() != ERROR_TIMEOUT) {
@@ -627,6 +628,15 @@ LDi_cond_wait_imp(
         status = 0;
     }
 #else
+    if (milliseconds < 0) {
+        if ((status = pthread_cond_wait(cond, mutex)) != 0) {
+            LD_LOG_1(
+                LD_LOG_CRITICAL, "pthread_cond_wait failed: %s", strerror(status));
+        }
+
+        goto done;
+    }
+
     if ((status = LDi_clockGetTime(&ts, LD_CLOCK_REALTIME) == LDBooleanFalse)) {
         goto done;
     }
@@ -683,12 +693,47 @@ LDi_cond_signal_imp(ld_cond_t *const cond)
 
     LD_ASSERT(cond);
 
+#ifdef _WIN32
+    WakeConditionVariable(cond);
+
+    status = 0;
+#else
+    if ((status = pthread_cond_signal(cond)) != 0) {
+        LD_LOG_1(
+            LD_LOG_CRITICAL,
+            "pthread_cond_signal failed: %s",
+            strerror(status));
+    }
+#endif
+
+#ifdef LAUNCHDARKLY_TRACE_CONCURRENCY
+    LD_LOG_1(LD_LOG_TRACE, "LDi_cond_signal end %p", (void *)cond);
+#endif
+
+#ifdef LAUNCHDARKLY_CONCURRENCY_ABORT
+    LD_ASSERT(status == 0);
+#endif
+
+    return status == 0;
+}
+
+static LDBoolean
+LDi_cond_broadcast_imp(ld_cond_t *const cond)
+{
+    int status;
+
+#ifdef LAUNCHDARKLY_TRACE_CONCURRENCY
+    LD_LOG_1(LD_LOG_TRACE, "LDi_cond_broadcast start %p", (void *)cond);
+#endif
+
+    LD_ASSERT(cond);
+
 #ifdef _WIN32
     WakeAllConditionVariable(cond);
 
     status = 0;
 #else
-    if ((status = pthread_cond_broadcast(cond) != 0)) {
+    if ((status = pthread_cond_broadcast(cond)) != 0) {
         LD_LOG_1(
             LD_LOG_CRITICAL,
             "pthread_cond_broadcast failed: %s",
@@ -697,7 +742,7 @@ LDi_cond_signal_imp(ld_cond_t *const cond)
 #endif
 
 #ifdef LAUNCHDARKLY_TRACE_CONCURRENCY
-    LD_LOG_1(LD_LOG_TRACE, "LDi_cond_signal end %p", (void *)cond);
+    LD_LOG_1(LD_LOG_TRACE, "LDi_cond_broadcast end %p", (void *)cond);
 #endif
 
 #ifdef LAUNCHDARKLY_CONCURRENCY_ABORT
@@ -722,7 +767,7 @@ LDi_cond_destroy_imp(ld_cond_t *const cond)
     /* windows has no destruction routine */
     status = 0;
 #else
-    if ((status = pthread_cond_destroy(cond) != 0)) {
+    if ((status = pthread_cond_destroy(cond)) != 0) {
         LD_LOG_1(
             LD_LOG_CRITICAL,
             "pthread_cond_destroy failed: %s",
@@ -757,7 +802,7 @@ LDi_cond_init_imp(ld_cond_t *const cond)
 
     status = 0;
 #else
-    if ((status = pthread_cond_init(cond, NULL) != 0)) {
+    if ((status = pthread_cond_init(cond, NULL)) != 0) {
         LD_LOG_1(
             LD_LOG_CRITICAL, "pthread_cond_init failed: %s", strerror(status));
     }
@@ -794,7 +839,8 @@ ld_rwlock_unary_t LDi_rwlock_wrlock   = LDi_rwlock_wrlock_imp;
 ld_rwlock_unary_t LDi_rwlock_rdunlock = LDi_rwlock_rdunlock_imp;
 ld_rwlock_unary_t LDi_rwlock_wrunlock = LDi_rwlock_wrunlock_imp;
 
-ld_cond_unary_t LDi_cond_init    = LDi_cond_init_imp;
-ld_cond_wait_t  LDi_cond_wait    = LDi_cond_wait_imp;
-ld_cond_unary_t LDi_cond_signal  = LDi_cond_signal_imp;
-ld_cond_unary_t LDi_cond_destroy = LDi_cond_destroy_imp;
+ld_cond_unary_t LDi_cond_init      = LDi_cond_init_imp;
+ld_cond_wait_t  LDi_cond_wait      = LDi_cond_wait_imp;
+ld_cond_unary_t LDi_cond_signal    = LDi_cond_signal_imp;
+ld_cond_unary_t LDi_cond_broadcast = LDi_cond_broadcast_imp;
+ld_cond_unary_t LDi_cond_destroy   = LDi_cond_destroy_imp;
@@ -50,6 +50,9 @@ typedef LDBoolean (*ld_thread_create_t)(
 
 typedef LDBoolean (*ld_rwlock_unary_t)(ld_rwlock_t *const lock);
 
+/* passed to LDi_cond_wait to wait without a timeout */
+#define LD_COND_WAIT_FOREVER -1
+
 typedef LDBoolean (*ld_cond_unary_t)(ld_cond_t *const cond);
 typedef LDBoolean (*ld_cond_wait_t)(
     ld_cond_t *const cond, ld_mutex_t *const mutex, const int milliseconds);
@@ -76,5 +79,45 @@ extern ld_rwlock_unary_t LDi_rwlock_wrunlock;
 
 extern ld_cond_unary_t LDi_cond_init;
 extern ld_cond_wait_t  LDi_cond_wait;
+/* wakes one waiter */
 extern ld_cond_unary_t LDi_cond_signal;
+/* wakes every waiter */
+extern ld_cond_unary_t LDi_cond_broadcast;
 extern ld_cond_unary_t LDi_cond_destroy;
+
+/* Pointer sized atomics. Loads have acquire semantics, compare and swap is
+ * a full barrier and evaluates to true when the swap was performed. */
+#ifdef _WIN32
+#define LD_ATOMIC_LOAD_POINTER(target)                                         \
+    InterlockedCompareExchangePointer((PVOID volatile *)(target), NULL, NULL)
+#define LD_ATOMIC_CAS_POINTER(target, expected, desired)                       \
+    (InterlockedCompareExchangePointer(                                        \
+         (PVOID volatile *)(target), (PVOID)(desired), (PVOID)(expected)) ==   \
+     (PVOID)(expected))
+#else
+#define LD_ATOMIC_LOAD_POINTER(target) __atomic_load_n((target), __ATOMIC_ACQUIRE)
+#define LD_ATOMIC_CAS_POINTER(target, expected, desired)                       \
+    __sync_bool_compare_and_swap((target), (expected), (desired))
+#endif
+
+/* unsigned long atomics. Stores have release semantics, increment and
+ * compare and swap are full barriers. Increment evaluates to the new value,
+ * compare and swap to true when the swap was performed. */
+#ifdef _WIN32
+#define LD_ATOMIC_LOAD_ULONG(target)                                           \
+    ((unsigned long)InterlockedCompareExchange((LONG volatile *)(target), 0, 0))
+#define LD_ATOMIC_STORE_ULONG(target, value)                                   \
+    InterlockedExchange((LONG volatile *)(target), (LONG)(value))
+#define LD_ATOMIC_INCREMENT_ULONG(target)                                      \
+    ((unsigned long)InterlockedIncrement((LONG volatile *)(target)))
+#define LD_ATOMIC_CAS_ULONG(target, expected, desired)                         \
+    (InterlockedCompareExchange((LONG volatile *)(target), (LONG)(desired),    \
+         (LONG)(expected)) == (LONG)(expected))
+#else
+#define LD_ATOMIC_LOAD_ULONG(target) __atomic_load_n((target), __ATOMIC_ACQUIRE)
+#define LD_ATOMIC_STORE_ULONG(target, value)                                   \
+    __atomic_store_n((target), (value), __ATOMIC_RELEASE)
+#define LD_ATOMIC_INCREMENT_ULONG(target) __sync_add_and_fetch((target), 1)
+#define LD_ATOMIC_CAS_ULONG(target, expected, desired)                         \
+    __sync_bool_compare_and_swap((target), (expected), (desired))
+#endif
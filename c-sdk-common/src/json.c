@@ -3,6 +3,7 @@
 #include <launchdarkly/json.h>
 
 #include "assertion.h"
+#include "json_writer.h"
 
 struct LDJSON *
 LDNewNull(void)
@@ -658,7 +659,7 @@ LDJSONSerialize(const struct LDJSON *const json)
     }
 #endif
 
-    return cJSON_PrintUnformatted((cJSON *)json);
+    return LDi_serializeJSON(json);
 }
 
 struct LDJSON *
@@ -0,0 +1,284 @@
+#include <string.h>
+
+#include <launchdarkly/memory.h>
+
+#include "concurrency.h"
+#include "json_index.h"
+#include "utility.h"
+
+struct LDObjectIndexEntry
+{
+    unsigned int hash;
+    /* NULL marks an empty slot */
+    cJSON *      item;
+};
+
+struct LDObjectIndex
+{
+    struct LDObjectIndexEntry *entries;
+    /* Always a power of two, kept at least twice count. */
+    unsigned int               capacity;
+    unsigned int               count;
+    /* Set when a key was seen more than once. Removing a member then drops
+     * the index, because a later duplicate may become the first. */
+    cJSON_bool                 duplicates;
+    cJSON *                    tail;
+};
+
+static unsigned int
+LDi_keyHash(const char *const key)
+{
+    return LDi_hash32(key, strlen(key));
+}
+
+/* Returns the slot holding key, or the empty slot where it would go. */
+static unsigned int
+LDi_findSlot(
+    const struct LDObjectIndex *const index,
+    const char *const                 key,
+    const unsigned int                hash)
+{
+    unsigned int position;
+
+    position = hash & (index->capacity - 1);
+
+    while (index->entries[position].item) {
+        const struct LDObjectIndexEntry *const entry =
+            &index->entries[position];
+
+        if (entry->hash == hash && strcmp(entry->item->string, key) == 0) {
+            break;
+        }
+
+        position = (position + 1) & (index->capacity - 1);
+    }
+
+    return position;
+}
+
+static cJSON_bool
+LDi_resize(struct LDObjectIndex *const index, const unsigned int capacity)
+{
+    struct LDObjectIndexEntry *entries, *previous;
+    unsigned int               i, previousCapacity;
+
+    if (!(entries = (struct LDObjectIndexEntry *)LDAlloc(
+              sizeof(struct LDObjectIndexEntry) * capacity)))
+    {
+        return 0;
+    }
+
+    memset(entries, 0, sizeof(struct LDObjectIndexEntry) * capacity);
+
+    previous         = index->entries;
+    previousCapacity = index->capacity;
+    index->entries   = entries;
+    index->capacity  = capacity;
+
+    for (i = 0; i < previousCapacity; i++) {
+        if (previous[i].item) {
+            unsigned int position;
+
+            position = previous[i].hash & (capacity - 1);
+
+            while (entries[position].item) {
+                position = (position + 1) & (capacity - 1);
+            }
+
+            entries[position] = previous[i];
+        }
+    }
+
+    LDFree(previous);
+
+    return 1;
+}
+
+static cJSON_bool
+LDi_insert(struct LDObjectIndex *const index, cJSON *const item)
+{
+    unsigned int hash, position;
+
+    if (!item->string) {
+        return 1;
+    }
+
+    if ((index->count + 1) * 2 > index->capacity) {
+        if (!LDi_resize(index, index->capacity * 2)) {
+            return 0;
+        }
+    }
+
+    hash     = LDi_keyHash(item->string);
+    position = LDi_findSlot(index, item->string, hash);
+
+    if (index->entries[position].item) {
+        /* keep the first member with this key */
+        index->duplicates = 1;
+    } else {
+        index->entries[position].hash = hash;
+        index->entries[position].item = item;
+        index->count++;
+    }
+
+    return 1;
+}
+
+cJSON_bool
+LDi_objectIndexLookup(
+    const cJSON *const object, const char *const key, cJSON **const result)
+{
+    struct LDObjectIndex *index;
+    unsigned int          position;
+
+    index = (struct LDObjectIndex *)LD_ATOMIC_LOAD_POINTER(
+        (struct LDObjectIndex **)&object->index);
+
+    if (!index) {
+        return 0;
+    }
+
+    position = LDi_findSlot(index, key, LDi_keyHash(key));
+    *result  = index->entries[position].item;
+
+    return 1;
+}
+
+void
+LDi_objectIndexBuild(const cJSON *const object)
+{
+    struct LDObjectIndex *index;
+    cJSON *               child;
+
+    if (!(index = (struct LDObjectIndex *)LDAlloc(sizeof(struct LDObjectIndex))))
+    {
+        return;
+    }
+
+    index->entries    = NULL;
+    index->capacity   = 0;
+    index->count      = 0;
+    index->duplicates = 0;
+    index->tail       = NULL;
+
+    if (!LDi_resize(index, LD_OBJECT_INDEX_THRESHOLD * 4)) {
+        LDFree(index);
+
+        return;
+    }
+
+    for (child = object->child; child; child = child->next) {
+        if (!LDi_insert(index, child)) {
+            LDi_objectIndexFree(index);
+
+            return;
+        }
+
+        index->tail = child;
+    }
+
+    /* Lookups on shared values may race to build; the first one wins. */
+    if (!LD_ATOMIC_CAS_POINTER(
+            (struct LDObjectIndex **)&object->index,
+            (struct LDObjectIndex *)NULL,
+            index))
+    {
+        LDi_objectIndexFree(index);
+    }
+}
+
+void
+LDi_objectIndexFree(struct LDObjectIndex *const index)
+{
+    if (index) {
+        LDFree(index->entries);
+        LDFree(index);
+    }
+}
+
+void
+LDi_objectIndexInvalidate(cJSON *const object)
+{
+    LDi_objectIndexFree(object->index);
+
+    object->index = NULL;
+}
+
+cJSON *
+LDi_objectIndexTail(const cJSON *const object)
+{
+    return object->index ? object->index->tail : NULL;
+}
+
+void
+LDi_objectIndexAppended(cJSON *const object, cJSON *const item)
+{
+    if (!object->index) {
+        return;
+    }
+
+    if (!LDi_insert(object->index, item)) {
+        LDi_objectIndexInvalidate(object);
+
+        return;
+    }
+
+    object->index->tail = item;
+}
+
+void
+LDi_objectIndexDetaching(cJSON *const object, cJSON *const item)
+{
+    struct LDObjectIndex *const index = object->index;
+    unsigned int                hole, next, home, mask;
+
+    if (!index) {
+        return;
+    }
+
+    if (index->duplicates) {
+        LDi_objectIndexInvalidate(object);
+
+        return;
+    }
+
+    if (index->tail == item) {
+        index->tail = item->prev;
+    }
+
+    if (!item->string) {
+        return;
+    }
+
+    hole = LDi_findSlot(index, item->string, LDi_keyHash(item->string));
+
+    if (index->entries[hole].item != item) {
+        return;
+    }
+
+    /* backward shift deletion keeps probe sequences unbroken */
+    mask = index->capacity - 1;
+    next = hole;
+
+    for (;;) {
+        next = (next + 1) & mask;
+
+        if (!index->entries[next].item) {
+            break;
+        }
+
+        home = index->entries[next].hash & mask;
+
+        if (hole <= next ? (hole < home && home <= next)
+                         : (hole < home || home <= next))
+        {
+            continue;
+        }
+
+        index->entries[hole] = index->entries[next];
+        hole                 = next;
+    }
+
+    index->entries[hole].item = NULL;
+    index->count--;
+}
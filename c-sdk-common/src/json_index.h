@@ -0,0 +1,46 @@
+#pragma once
+
+#include "cJSON.h"
+
+/* Hash side index for large cJSON objects, used by case sensitive member
+ * lookup. An index is built the first time a lookup has to walk past
+ * LD_OBJECT_INDEX_THRESHOLD members, and is then kept up to date by the
+ * cJSON functions that add or remove members. When several members share
+ * a key the index resolves to the first, matching a linear search.
+ *
+ * Building is safe while other threads look up members of the same object,
+ * so shared values may be read concurrently as before. Mutation still
+ * requires exclusive access. */
+
+#define LD_OBJECT_INDEX_THRESHOLD 16
+
+struct LDObjectIndex;
+
+/* Returns true when the object is indexed, setting result to the member
+ * or to NULL when there is no member named key. Returns false when the
+ * caller should fall back to a linear search. */
+cJSON_bool
+LDi_objectIndexLookup(
+    const cJSON *const object, const char *const key, cJSON **const result);
+
+void
+LDi_objectIndexBuild(const cJSON *const object);
+
+void
+LDi_objectIndexFree(struct LDObjectIndex *const index);
+
+/* Drops the index, it will be rebuilt by a later lookup if needed. */
+void
+LDi_objectIndexInvalidate(cJSON *const object);
+
+/* Returns the last member of an indexed object, or NULL when unknown. */
+cJSON *
+LDi_objectIndexTail(const cJSON *const object);
+
+/* Called after item has been appended to the member list. */
+void
+LDi_objectIndexAppended(cJSON *const object, cJSON *const item);
+
+/* Called before item is unlinked from the member list. */
+void
+LDi_objectIndexDetaching(cJSON *const object, cJSON *const item);
@@ -0,0 +1,231 @@
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+
+#include <launchdarkly/memory.h>
+
+#include "assertion.h"
+#include "json_pool.h"
+
+/* Blocks are pooled in classes of 16, 32, 48, 64 and 80 bytes. The largest
+ * class holds a cJSON node. */
+#define LD_POOL_GRANULE 16
+#define LD_POOL_CLASS_COUNT 5
+/* Upper bound on blocks a thread keeps per class. */
+#define LD_POOL_MAX_CACHED 512
+
+/* Precedes every block, aligned for any member of a cJSON node. */
+union LDPoolHeader
+{
+    size_t sizeClass;
+    double alignDouble;
+    void * alignPointer;
+};
+
+/* Overlays the payload of a cached block. */
+struct LDPoolBlock
+{
+    struct LDPoolBlock *next;
+};
+
+struct LDPoolCache
+{
+    struct LDPoolBlock *         blocks[LD_POOL_CLASS_COUNT];
+    unsigned int                 cached[LD_POOL_CLASS_COUNT];
+    struct LDJSONPoolStatistics statistics;
+};
+
+static LDBoolean LDi_poolInitialized = LDBooleanFalse;
+
+static void
+LDi_destroyCache(struct LDPoolCache *const cache)
+{
+    size_t i;
+
+    for (i = 0; i < LD_POOL_CLASS_COUNT; i++) {
+        while (cache->blocks[i]) {
+            struct LDPoolBlock *const block = cache->blocks[i];
+
+            cache->blocks[i] = block->next;
+
+            LDFree((union LDPoolHeader *)block - 1);
+        }
+    }
+
+    LDFree(cache);
+}
+
+#ifdef _WIN32
+static DWORD LDi_poolKey = FLS_OUT_OF_INDEXES;
+
+static void WINAPI
+LDi_destroyCacheCallback(void *const cache)
+{
+    if (cache) {
+        LDi_destroyCache((struct LDPoolCache *)cache);
+    }
+}
+
+#define LD_POOL_GET_CACHE() ((struct LDPoolCache *)FlsGetValue(LDi_poolKey))
+#define LD_POOL_SET_CACHE(cache) (FlsSetValue(LDi_poolKey, (cache)) != 0)
+#else
+static pthread_key_t LDi_poolKey;
+
+static void
+LDi_destroyCacheCallback(void *const cache)
+{
+    LDi_destroyCache((struct LDPoolCache *)cache);
+}
+
+#define LD_POOL_GET_CACHE()                                                    \
+    ((struct LDPoolCache *)pthread_getspecific(LDi_poolKey))
+#define LD_POOL_SET_CACHE(cache) (pthread_setspecific(LDi_poolKey, (cache)) == 0)
+#endif
+
+LDBoolean
+LDi_jsonPoolInitialize(void)
+{
+    if (LDi_poolInitialized) {
+        return LDBooleanTrue;
+    }
+
+#ifdef _WIN32
+    if ((LDi_poolKey = FlsAlloc(LDi_destroyCacheCallback)) ==
+        FLS_OUT_OF_INDEXES) {
+        return LDBooleanFalse;
+    }
+#else
+    if (pthread_key_create(&LDi_poolKey, LDi_destroyCacheCallback) != 0) {
+        return LDBooleanFalse;
+    }
+#endif
+
+    LDi_poolInitialized = LDBooleanTrue;
+
+    return LDBooleanTrue;
+}
+
+/* Returns the calling thread's cache, creating it on first use. */
+static struct LDPoolCache *
+LDi_threadCache(void)
+{
+    struct LDPoolCache *cache;
+
+    if (!LDi_poolInitialized) {
+        return NULL;
+    }
+
+    if ((cache = LD_POOL_GET_CACHE())) {
+        return cache;
+    }
+
+    if (!(cache = (struct LDPoolCache *)LDAlloc(sizeof(struct LDPoolCache)))) {
+        return NULL;
+    }
+
+    memset(cache, 0, sizeof(struct LDPoolCache));
+
+    if (!LD_POOL_SET_CACHE(cache)) {
+        LDFree(cache);
+
+        return NULL;
+    }
+
+    return cache;
+}
+
+/* Returns the pool class for a request, or zero when it is too large. */
+static size_t
+LDi_sizeClass(const size_t bytes)
+{
+    const size_t sizeClass = bytes ? (bytes + LD_POOL_GRANULE - 1) / LD_POOL_GRANULE : 1;
+
+    return sizeClass <= LD_POOL_CLASS_COUNT ? sizeClass : 0;
+}
+
+void *
+LDi_jsonPoolAllocate(size_t bytes)
+{
+    union LDPoolHeader *header;
+    struct LDPoolCache *cache;
+    size_t              sizeClass;
+
+    sizeClass = LDi_sizeClass(bytes);
+    cache     = LDi_threadCache();
+
+    if (sizeClass == 0) {
+        if (cache) {
+            cache->statistics.oversized++;
+        }
+    } else if (cache && cache->blocks[sizeClass - 1]) {
+        struct LDPoolBlock *const block = cache->blocks[sizeClass - 1];
+
+        cache->blocks[sizeClass - 1] = block->next;
+        cache->cached[sizeClass - 1]--;
+        cache->statistics.hits++;
+
+        return block;
+    } else {
+        bytes = sizeClass * LD_POOL_GRANULE;
+
+        if (cache) {
+            cache->statistics.misses++;
+        }
+    }
+
+    if (!(header = (union LDPoolHeader *)LDAlloc(sizeof(union LDPoolHeader) + bytes)))
+    {
+        return NULL;
+    }
+
+    header->sizeClass = sizeClass;
+
+    return header + 1;
+}
+
+void
+LDi_jsonPoolFree(void *block)
+{
+    union LDPoolHeader *header;
+    struct LDPoolCache *cache;
+    size_t              sizeClass;
+
+    if (!block) {
+        return;
+    }
+
+    header    = (union LDPoolHeader *)block - 1;
+    sizeClass = header->sizeClass;
+
+    if (sizeClass && (cache = LDi_threadCache()) &&
+        cache->cached[sizeClass - 1] < LD_POOL_MAX_CACHED)
+    {
+        struct LDPoolBlock *const cached = (struct LDPoolBlock *)block;
+
+        cached->next                 = cache->blocks[sizeClass - 1];
+        cache->blocks[sizeClass - 1] = cached;
+        cache->cached[sizeClass - 1]++;
+
+        return;
+    }
+
+    LDFree(header);
+}
+
+void
+LDi_jsonPoolStatistics(struct LDJSONPoolStatistics *const statistics)
+{
+    struct LDPoolCache *cache;
+
+    LD_ASSERT(statistics);
+
+    if ((cache = LDi_threadCache())) {
+        *statistics = cache->statistics;
+    } else {
+        memset(statistics, 0, sizeof(struct LDJSONPoolStatistics));
+    }
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <stddef.h>
+
+#include <launchdarkly/boolean.h>
+
+/* Per thread free list allocator for the small, fixed size allocations
+ * that dominate JSON construction: cJSON nodes and short strings. It is
+ * installed as the cJSON allocation hooks by LDGlobalInit when enabled with
+ * LDEnableJSONPooling, and obtains memory through LDAlloc so custom memory
+ * routines still apply.
+ *
+ * Every block carries a small header naming its size class, so a block may
+ * be released on a different thread than the one that allocated it. Each
+ * thread caches a bounded number of blocks per class, and returns them to
+ * LDFree when the thread exits. */
+
+/* Creates the thread cache key. Must be called once before use. */
+LDBoolean
+LDi_jsonPoolInitialize(void);
+
+void *
+LDi_jsonPoolAllocate(size_t bytes);
+
+void
+LDi_jsonPoolFree(void *block);
+
+/* Counters for the calling thread, for tests and benchmarks. */
+struct LDJSONPoolStatistics
+{
+    /* Allocations served from the thread cache. */
+    unsigned long hits;
+    /* Allocations that required a call to LDAlloc. */
+    unsigned long misses;
+    /* Allocations too large to be pooled. */
+    unsigned long oversized;
+};
+
+void
+LDi_jsonPoolStatistics(struct LDJSONPoolStatistics *const statistics);
@@ -0,0 +1,329 @@
+#include <string.h>
+
+#include "assertion.h"
+#include "cJSON.h"
+#include "json_raw.h"
+
+static size_t
+LDi_skipWhitespace(
+    const char *const text, const size_t length, size_t offset)
+{
+    while (offset < length &&
+           (text[offset] == ' ' || text[offset] == '\t' ||
+            text[offset] == '\n' || text[offset] == '\r'))
+    {
+        offset++;
+    }
+
+    return offset;
+}
+
+static LDBoolean
+LDi_isDigit(const char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+static LDBoolean
+LDi_isHexDigit(const char c)
+{
+    return LDi_isDigit(c) || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F');
+}
+
+/* Each scanner starts at the first byte of its value and, on success,
+ * advances offset past the last. */
+
+static LDBoolean
+LDi_scanString(const char *const text, const size_t length, size_t *const offset)
+{
+    size_t        i;
+    unsigned char c;
+
+    i = *offset + 1;
+
+    while (i < length) {
+        c = (unsigned char)text[i];
+
+        if (c == '"') {
+            *offset = i + 1;
+
+            return LDBooleanTrue;
+        }
+
+        if (c < 0x20) {
+            return LDBooleanFalse;
+        }
+
+        if (c == '\\') {
+            if (++i >= length) {
+                return LDBooleanFalse;
+            }
+
+            switch (text[i]) {
+                case '"':
+                case '\\':
+                case '/':
+                case 'b':
+                case 'f':
+                case 'n':
+                case 'r':
+                case 't':
+                    break;
+                case 'u':
+                    if (length - i <= 4 || !LDi_isHexDigit(text[i + 1]) ||
+                        !LDi_isHexDigit(text[i + 2]) ||
+                        !LDi_isHexDigit(text[i + 3]) ||
+                        !LDi_isHexDigit(text[i + 4]))
+                    {
+                        return LDBooleanFalse;
+                    }
+
+                    i += 4;
+
+                    break;
+                default:
+                    return LDBooleanFalse;
+            }
+        }
+
+        i++;
+    }
+
+    return LDBooleanFalse;
+}
+
+static LDBoolean
+LDi_scanDigits(const char *const text, const size_t length, size_t *const offset)
+{
+    size_t i;
+
+    for (i = *offset; i < length && LDi_isDigit(text[i]); i++) {
+    }
+
+    if (i == *offset) {
+        return LDBooleanFalse;
+    }
+
+    *offset = i;
+
+    return LDBooleanTrue;
+}
+
+static LDBoolean
+LDi_scanNumber(const char *const text, const size_t length, size_t *const offset)
+{
+    size_t i;
+
+    i = *offset;
+
+    if (text[i] == '-') {
+        i++;
+    }
+
+    /* no leading zeros */
+    if (i < length && text[i] == '0') {
+        i++;
+    } else if (!LDi_scanDigits(text, length, &i)) {
+        return LDBooleanFalse;
+    }
+
+    if (i < length && text[i] == '.') {
+        i++;
+
+        if (!LDi_scanDigits(text, length, &i)) {
+            return LDBooleanFalse;
+        }
+    }
+
+    if (i < length && (text[i] == 'e' || text[i] == 'E')) {
+        i++;
+
+        if (i < length && (text[i] == '+' || text[i] == '-')) {
+            i++;
+        }
+
+        if (!LDi_scanDigits(text, length, &i)) {
+            return LDBooleanFalse;
+        }
+    }
+
+    *offset = i;
+
+    return LDBooleanTrue;
+}
+
+static LDBoolean
+LDi_scanLiteral(
+    const char *const text,
+    const size_t      length,
+    size_t *const     offset,
+    const char *const literal)
+{
+    const size_t literalLength = strlen(literal);
+
+    if (length - *offset < literalLength ||
+        memcmp(text + *offset, literal, literalLength) != 0)
+    {
+        return LDBooleanFalse;
+    }
+
+    *offset += literalLength;
+
+    return LDBooleanTrue;
+}
+
+/* Scans an object key and the colon after it, leaving offset at the value. */
+static LDBoolean
+LDi_scanKey(const char *const text, const size_t length, size_t *const offset)
+{
+    if (*offset >= length || text[*offset] != '"' ||
+        !LDi_scanString(text, length, offset))
+    {
+        return LDBooleanFalse;
+    }
+
+    *offset = LDi_skipWhitespace(text, length, *offset);
+
+    if (*offset >= length || text[*offset] != ':') {
+        return LDBooleanFalse;
+    }
+
+    *offset = LDi_skipWhitespace(text, length, *offset + 1);
+
+    return LDBooleanTrue;
+}
+
+LDBoolean
+LDi_validateJSON(const char *const text, const size_t length)
+{
+    /* the closing bracket of each open container */
+    char   closers[CJSON_NESTING_LIMIT];
+    size_t depth, offset;
+
+    LD_ASSERT(text);
+
+    depth  = 0;
+    offset = LDi_skipWhitespace(text, length, 0);
+
+    for (;;) {
+        /* a value starts at offset */
+        if (offset >= length) {
+            return LDBooleanFalse;
+        }
+
+        switch (text[offset]) {
+            case '{':
+            case '[':
+                if (depth == CJSON_NESTING_LIMIT) {
+                    return LDBooleanFalse;
+                }
+
+                closers[depth++] = text[offset] == '{' ? '}' : ']';
+
+                offset = LDi_skipWhitespace(text, length, offset + 1);
+
+                if (offset < length && text[offset] == closers[depth - 1]) {
+                    depth--;
+                    offset++;
+
+                    break;
+                }
+
+                if (closers[depth - 1] == '}' &&
+                    !LDi_scanKey(text, length, &offset))
+                {
+                    return LDBooleanFalse;
+                }
+
+                continue;
+            case '"':
+                if (!LDi_scanString(text, length, &offset)) {
+                    return LDBooleanFalse;
+                }
+
+                break;
+            case 't':
+                if (!LDi_scanLiteral(text, length, &offset, "true")) {
+                    return LDBooleanFalse;
+                }
+
+                break;
+            case 'f':
+                if (!LDi_scanLiteral(text, length, &offset, "false")) {
+                    return LDBooleanFalse;
+                }
+
+                break;
+            case 'n':
+                if (!LDi_scanLiteral(text, length, &offset, "null")) {
+                    return LDBooleanFalse;
+                }
+
+                break;
+            default:
+                if (!LDi_scanNumber(text, length, &offset)) {
+                    return LDBooleanFalse;
+                }
+
+                break;
+        }
+
+        /* a value ended before offset, close any containers it completes */
+        for (;;) {
+            offset = LDi_skipWhitespace(text, length, offset);
+
+            if (depth == 0) {
+                return offset == length;
+            }
+
+            if (offset >= length) {
+                return LDBooleanFalse;
+            }
+
+            if (text[offset] != closers[depth - 1]) {
+                break;
+            }
+
+            depth--;
+            offset++;
+        }
+
+        if (text[offset] != ',') {
+            return LDBooleanFalse;
+        }
+
+        offset = LDi_skipWhitespace(text, length, offset + 1);
+
+        if (closers[depth - 1] == '}' && !LDi_scanKey(text, length, &offset)) {
+            return LDBooleanFalse;
+        }
+    }
+}
+
+struct LDJSON *
+LDi_newRawJSON(const char *const text, const size_t length)
+{
+    cJSON *item;
+    char * copy;
+
+    LD_ASSERT(text);
+
+    /* allocated through the cJSON hooks, which free it with the node */
+    if (!(item = cJSON_CreateNull())) {
+        return NULL;
+    }
+
+    if (!(copy = (char *)cJSON_malloc(length + 1))) {
+        cJSON_Delete(item);
+
+        return NULL;
+    }
+
+    memcpy(copy, text, length);
+    copy[length] = '\0';
+
+    item->type        = cJSON_Raw;
+    item->valuestring = copy;
+
+    return (struct LDJSON *)item;
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <stddef.h>
+
+#include <launchdarkly/boolean.h>
+#include <launchdarkly/json.h>
+
+/* JSON text that is carried as is rather than parsed into a tree.
+ *
+ * A raw value is a cJSON_Raw node. It is written verbatim by the JSON
+ * writer, so the text must be validated first: a malformed value would
+ * make the whole document it is spliced into malformed. Raw values are not
+ * a type of the public LDJSON API and must only be stored and serialized. */
+
+/* Returns true if the length bytes of text are exactly one JSON value,
+ * optionally surrounded by whitespace. Does not allocate. Nesting deeper
+ * than CJSON_NESTING_LIMIT is rejected, as when parsing. */
+LDBoolean
+LDi_validateJSON(const char *const text, const size_t length);
+
+/* Copies length bytes of text, which must already be validated, into a raw
+ * value. Returns NULL on allocation failure. */
+struct LDJSON *
+LDi_newRawJSON(const char *const text, const size_t length);
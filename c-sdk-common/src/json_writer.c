@@ -0,0 +1,396 @@
+#include <locale.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <launchdarkly/memory.h>
+
+#include "assertion.h"
+#include "cJSON.h"
+#include "json_writer.h"
+
+#define LD_WRITER_INITIAL_CAPACITY 256
+
+/* cJSON prints integers of this magnitude and above with an exponent */
+#define LD_WRITER_INTEGER_LIMIT 1e15
+
+void
+LDi_writerInitialize(struct LDJSONWriter *const writer)
+{
+    LD_ASSERT(writer);
+
+    writer->buffer   = NULL;
+    writer->length   = 0;
+    writer->capacity = 0;
+}
+
+void
+LDi_writerDestroy(struct LDJSONWriter *const writer)
+{
+    if (writer) {
+        LDFree(writer->buffer);
+
+        LDi_writerInitialize(writer);
+    }
+}
+
+/* Ensures room for extra bytes plus a terminator. */
+static LDBoolean
+LDi_writerReserve(struct LDJSONWriter *const writer, const size_t extra)
+{
+    size_t capacity;
+    char * buffer;
+
+    if (writer->length + extra + 1 <= writer->capacity) {
+        return LDBooleanTrue;
+    }
+
+    capacity = writer->capacity ? writer->capacity : LD_WRITER_INITIAL_CAPACITY;
+
+    while (capacity < writer->length + extra + 1) {
+        capacity *= 2;
+    }
+
+    if (!(buffer = (char *)LDRealloc(writer->buffer, capacity))) {
+        return LDBooleanFalse;
+    }
+
+    writer->buffer   = buffer;
+    writer->capacity = capacity;
+
+    return LDBooleanTrue;
+}
+
+LDBoolean
+LDi_writerAppend(
+    struct LDJSONWriter *const writer,
+    const char *const          bytes,
+    const size_t               length)
+{
+    LD_ASSERT(writer);
+    LD_ASSERT(bytes || length == 0);
+
+    if (!LDi_writerReserve(writer, length)) {
+        return LDBooleanFalse;
+    }
+
+    memcpy(writer->buffer + writer->length, bytes, length);
+
+    writer->length += length;
+
+    return LDBooleanTrue;
+}
+
+static LDBoolean
+LDi_writerAppendChar(struct LDJSONWriter *const writer, const char character)
+{
+    if (!LDi_writerReserve(writer, 1)) {
+        return LDBooleanFalse;
+    }
+
+    writer->buffer[writer->length++] = character;
+
+    return LDBooleanTrue;
+}
+
+static LDBoolean
+LDi_isNegativeZero(const double number)
+{
+    static const double positiveZero = 0.0;
+
+    return number == 0 &&
+        memcmp(&number, &positiveZero, sizeof(double)) != 0;
+}
+
+/* Formats an integral value with magnitude below LD_WRITER_INTEGER_LIMIT.
+ * The value is split into two parts that each fit in 32 bits so this is
+ * exact on platforms where long is 32 bits. Returns a pointer to the first
+ * digit, the output ends at the end of the buffer. */
+static char *
+LDi_formatInteger(const double number, char *const end)
+{
+    double        magnitude, lowPart;
+    unsigned long high, low;
+    char *        cursor;
+    int           digits;
+
+    magnitude = number < 0 ? -number : number;
+    high      = (unsigned long)(magnitude / 1e9);
+    lowPart   = magnitude - (double)high * 1e9;
+
+    if (lowPart < 0) {
+        high--;
+        lowPart += 1e9;
+    } else if (lowPart >= 1e9) {
+        high++;
+        lowPart -= 1e9;
+    }
+
+    low    = (unsigned long)lowPart;
+    cursor = end;
+
+    if (high) {
+        for (digits = 0; digits < 9; digits++) {
+            *--cursor = (char)('0' + low % 10);
+            low /= 10;
+        }
+
+        low = high;
+    }
+
+    do {
+        *--cursor = (char)('0' + low % 10);
+        low /= 10;
+    } while (low);
+
+    if (number < 0) {
+        *--cursor = '-';
+    }
+
+    return cursor;
+}
+
+static LDBoolean
+LDi_writeNumber(struct LDJSONWriter *const writer, const double number)
+{
+    char   buffer[32];
+    char * start;
+    int    length, i;
+    char   decimalPoint;
+    double test;
+
+    /* NaN and infinity */
+    if ((number * 0) != 0) {
+        return LDi_writerAppend(writer, "null", 4);
+    }
+
+    if (number > -LD_WRITER_INTEGER_LIMIT && number < LD_WRITER_INTEGER_LIMIT &&
+        number == floor(number) && !LDi_isNegativeZero(number))
+    {
+        start = LDi_formatInteger(number, buffer + sizeof(buffer));
+
+        return LDi_writerAppend(
+            writer, start, (size_t)(buffer + sizeof(buffer) - start));
+    }
+
+    /* Same precision selection as cJSON: 15 significant digits when that
+     * round trips, otherwise 17. */
+    length = sprintf(buffer, "%1.15g", number);
+
+    test = strtod(buffer, NULL);
+
+    if (test != number) {
+        length = sprintf(buffer, "%1.17g", number);
+    }
+
+    if (length < 0 || length > (int)(sizeof(buffer) - 1)) {
+        return LDBooleanFalse;
+    }
+
+    decimalPoint = localeconv()->decimal_point[0];
+
+    if (decimalPoint != '.') {
+        for (i = 0; i < length; i++) {
+            if (buffer[i] == decimalPoint) {
+                buffer[i] = '.';
+            }
+        }
+    }
+
+    return LDi_writerAppend(writer, buffer, (size_t)length);
+}
+
+LDBoolean
+LDi_writerWriteString(struct LDJSONWriter *const writer, const char *const text)
+{
+    static const char hex[] = "0123456789abcdef";
+
+    const unsigned char *cursor, *run;
+
+    if (!text) {
+        return LDi_writerAppend(writer, "\"\"", 2);
+    }
+
+    if (!LDi_writerAppendChar(writer, '"')) {
+        return LDBooleanFalse;
+    }
+
+    cursor = (const unsigned char *)text;
+
+    for (;;) {
+        char escape[6];
+
+        for (run = cursor; *cursor > 31 && *cursor != '"' && *cursor != '\\';
+             cursor++)
+        {}
+
+        if (!LDi_writerAppend(
+                writer, (const char *)run, (size_t)(cursor - run)))
+        {
+            return LDBooleanFalse;
+        }
+
+        if (*cursor == '\0') {
+            break;
+        }
+
+        escape[0] = '\\';
+
+        switch (*cursor) {
+            case '\\':
+                escape[1] = '\\';
+                break;
+            case '"':
+                escape[1] = '"';
+                break;
+            case '\b':
+                escape[1] = 'b';
+                break;
+            case '\f':
+                escape[1] = 'f';
+                break;
+            case '\n':
+                escape[1] = 'n';
+                break;
+            case '\r':
+                escape[1] = 'r';
+                break;
+            case '\t':
+                escape[1] = 't';
+                break;
+            default:
+                escape[1] = 'u';
+                escape[2] = '0';
+                escape[3] = '0';
+                escape[4] = hex[*cursor >> 4];
+                escape[5] = hex[*cursor & 0xF];
+
+                if (!LDi_writerAppend(writer, escape, 6)) {
+                    return LDBooleanFalse;
+                }
+
+                cursor++;
+
+                continue;
+        }
+
+        if (!LDi_writerAppend(writer, escape, 2)) {
+            return LDBooleanFalse;
+        }
+
+        cursor++;
+    }
+
+    return LDi_writerAppendChar(writer, '"');
+}
+
+LDBoolean
+LDi_writerWriteValue(
+    struct LDJSONWriter *const writer, const struct LDJSON *const json)
+{
+    const cJSON *item, *child;
+
+    LD_ASSERT(writer);
+    LD_ASSERT(json);
+
+    item = (const cJSON *)json;
+
+    switch (item->type & 0xFF) {
+        case cJSON_False:
+            return LDi_writerAppend(writer, "false", 5);
+        case cJSON_True:
+            return LDi_writerAppend(writer, "true", 4);
+        case cJSON_NULL:
+            return LDi_writerAppend(writer, "null", 4);
+        case cJSON_Number:
+            return LDi_writeNumber(writer, item->valuedouble);
+        case cJSON_String:
+            return LDi_writerWriteString(writer, item->valuestring);
+        case cJSON_Raw:
+            if (!item->valuestring) {
+                return LDBooleanFalse;
+            }
+
+            return LDi_writerAppend(
+                writer, item->valuestring, strlen(item->valuestring));
+        case cJSON_Array:
+            if (!LDi_writerAppendChar(writer, '[')) {
+                return LDBooleanFalse;
+            }
+
+            for (child = item->child; child; child = child->next) {
+                if (child != item->child && !LDi_writerAppendChar(writer, ','))
+                {
+                    return LDBooleanFalse;
+                }
+
+                if (!LDi_writerWriteValue(writer, (const struct LDJSON *)child))
+                {
+                    return LDBooleanFalse;
+                }
+            }
+
+            return LDi_writerAppendChar(writer, ']');
+        case cJSON_Object:
+            if (!LDi_writerAppendChar(writer, '{')) {
+                return LDBooleanFalse;
+            }
+
+            for (child = item->child; child; child = child->next) {
+                if (child != item->child && !LDi_writerAppendChar(writer, ','))
+                {
+                    return LDBooleanFalse;
+                }
+
+                if (!LDi_writerWriteString(writer, child->string) ||
+                    !LDi_writerAppendChar(writer, ':') ||
+                    !LDi_writerWriteValue(writer, (const struct LDJSON *)child))
+                {
+                    return LDBooleanFalse;
+                }
+            }
+
+            return LDi_writerAppendChar(writer, '}');
+        default:
+            return LDBooleanFalse;
+    }
+}
+
+char *
+LDi_writerTake(struct LDJSONWriter *const writer)
+{
+    char *result;
+
+    LD_ASSERT(writer);
+
+    if (!LDi_writerReserve(writer, 0)) {
+        return NULL;
+    }
+
+    writer->buffer[writer->length] = '\0';
+
+    result = writer->buffer;
+
+    LDi_writerInitialize(writer);
+
+    return result;
+}
+
+char *
+LDi_serializeJSON(const struct LDJSON *const json)
+{
+    struct LDJSONWriter writer;
+
+    LD_ASSERT(json);
+
+    LDi_writerInitialize(&writer);
+
+    if (!LDi_writerWriteValue(&writer, json)) {
+        LDi_writerDestroy(&writer);
+
+        return NULL;
+    }
+
+    return LDi_writerTake(&writer);
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <stddef.h>
+
+#include <launchdarkly/boolean.h>
+#include <launchdarkly/json.h>
+
+/* Compact JSON serializer used by LDJSONSerialize.
+ *
+ * Output is byte for byte identical to cJSON_PrintUnformatted. Integral
+ * numbers that cJSON would print without an exponent, which covers
+ * timestamps, versions, variations and counters, are formatted without
+ * going through sprintf. Strings are copied in runs between characters
+ * that need escaping. */
+
+struct LDJSONWriter
+{
+    char * buffer;
+    size_t length;
+    size_t capacity;
+};
+
+void
+LDi_writerInitialize(struct LDJSONWriter *const writer);
+
+/* Frees the buffer, if the result has not been taken. */
+void
+LDi_writerDestroy(struct LDJSONWriter *const writer);
+
+LDBoolean
+LDi_writerAppend(
+    struct LDJSONWriter *const writer,
+    const char *const          bytes,
+    const size_t               length);
+
+/* Writes text as a quoted and escaped JSON string. */
+LDBoolean
+LDi_writerWriteString(
+    struct LDJSONWriter *const writer, const char *const text);
+
+LDBoolean
+LDi_writerWriteValue(
+    struct LDJSONWriter *const writer, const struct LDJSON *const json);
+
+/* Returns the NULL terminated output, transferring ownership to the caller
+ * who must release it with LDFree. */
+char *
+LDi_writerTake(struct LDJSONWriter *const writer);
+
+/* Serializes a value, the result must be released with LDFree. */
+char *
+LDi_serializeJSON(const struct LDJSON *const json);
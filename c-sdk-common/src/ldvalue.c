@@ -9,8 +9,10 @@
  */
 
 #include <launchdarkly/experimental/ldvalue.h>
+#include <launchdarkly/memory.h>
 #include "assertion.h"
 #include "cJSON.h"
+#include "json_writer.h"
 
 #define AS_CJSON(ptr) ((struct cJSON*)(ptr))
 
@@ -96,14 +98,27 @@ struct LDValue *LDValue_Clone(struct LDValue *source) {
 
 char *
 LDValue_SerializeFormattedJSON(struct LDValue *value) {
+    char *printed, *result;
+
     LD_ASSERT_API(value);
-    return cJSON_Print(AS_CJSON(value));
+
+    if (!(printed = cJSON_Print(AS_CJSON(value)))) {
+        return NULL;
+    }
+
+    /* cJSON allocates through its hooks, which may be the JSON pool, while
+     * callers release the result with LDFree */
+    result = LDStrDup(printed);
+
+    cJSON_free(printed);
+
+    return result;
 }
 
 char *
 LDValue_SerializeJSON(struct LDValue *value) {
     LD_ASSERT_API(value);
-    return cJSON_PrintUnformatted(AS_CJSON(value));
+    return LDi_serializeJSON((const struct LDJSON *)value);
 }
 
 LDBoolean LDValue_Equal(struct LDValue *left, struct LDValue *right) {
@@ -9,6 +9,7 @@
 #include <launchdarkly/memory.h>
 
 #include "assertion.h"
+#include "json_pool.h"
 #include "memory.h"
 
 void *(*LDi_customAlloc)(const size_t bytes) = malloc;
@@ -106,16 +107,25 @@ LDSetMemoryRoutines(
     LDi_customStrNDup = newStrNDup;
 }
 
+static LDBoolean LDi_globalInitialized = LDBooleanFalse;
+static LDBoolean LDi_jsonPooling       = LDBooleanFalse;
+
 void
-LDGlobalInit(void)
+LDEnableJSONPooling(void)
 {
-    static LDBoolean first = LDBooleanTrue;
+    if (!LDi_globalInitialized) {
+        LDi_jsonPooling = LDBooleanTrue;
+    }
+}
 
-    if (first) {
+void
+LDGlobalInit(void)
+{
+    if (!LDi_globalInitialized) {
         struct cJSON_Hooks hooks;
         CURLcode           status;
 
-        first = LDBooleanFalse;
+        LDi_globalInitialized = LDBooleanTrue;
 
         status = curl_global_init_mem(
             CURL_GLOBAL_DEFAULT,
@@ -127,8 +137,13 @@ LDGlobalInit(void)
 
         LD_ASSERT(!status);
 
-        hooks.malloc_fn = LDAlloc;
-        hooks.free_fn   = LDFree;
+        if (LDi_jsonPooling && LDi_jsonPoolInitialize()) {
+            hooks.malloc_fn = LDi_jsonPoolAllocate;
+            hooks.free_fn   = LDi_jsonPoolFree;
+        } else {
+            hooks.malloc_fn = LDAlloc;
+            hooks.free_fn   = LDFree;
+        }
 
         cJSON_InitHooks(&hooks);
     }
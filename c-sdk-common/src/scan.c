@@ -0,0 +1,213 @@
+#include "assertion.h"
+#include "scan.h"
+
+#if defined(__x86_64__) || defined(_M_X64) ||                                  \
+    (defined(__i386__) && defined(__SSE2__)) ||                                \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define LD_SCAN_SSE2
+#include <emmintrin.h>
+#endif
+
+/* AVX2 code is compiled per function with the target attribute, and only
+ * run after the CPU reports support for it. */
+#if defined(LD_SCAN_SSE2) &&                                                   \
+    (defined(__clang__) ||                                                     \
+     (defined(__GNUC__) &&                                                     \
+      (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))))
+#define LD_SCAN_AVX2
+#include <immintrin.h>
+#endif
+
+#if defined(__aarch64__) && defined(__GNUC__)
+#define LD_SCAN_NEON
+#include <arm_neon.h>
+#endif
+
+#if defined(_MSC_VER) && defined(LD_SCAN_SSE2)
+#include <intrin.h>
+#endif
+
+static size_t
+LDi_scanScalar(
+    const char *const buffer,
+    const size_t      length,
+    const char        first,
+    const char        second)
+{
+    size_t i;
+
+    for (i = 0; i < length; i++) {
+        if (buffer[i] == first || buffer[i] == second) {
+            return i;
+        }
+    }
+
+    return length;
+}
+
+#ifdef LD_SCAN_SSE2
+static unsigned int
+LDi_lowestSetBit(const unsigned int mask)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return (unsigned int)__builtin_ctz(mask);
+#elif defined(_MSC_VER)
+    unsigned long index;
+
+    _BitScanForward(&index, mask);
+
+    return (unsigned int)index;
+#else
+    unsigned int index;
+
+    for (index = 0; !(mask & (1u << index)); index++) {}
+
+    return index;
+#endif
+}
+
+static size_t
+LDi_scanSSE2(
+    const char *const buffer,
+    const size_t      length,
+    const char        first,
+    const char        second)
+{
+    size_t        i;
+    const __m128i matchFirst  = _mm_set1_epi8(first);
+    const __m128i matchSecond = _mm_set1_epi8(second);
+
+    for (i = 0; i + 16 <= length; i += 16) {
+        const __m128i chunk = _mm_loadu_si128((const __m128i *)(buffer + i));
+        const unsigned int mask = (unsigned int)_mm_movemask_epi8(_mm_or_si128(
+            _mm_cmpeq_epi8(chunk, matchFirst),
+            _mm_cmpeq_epi8(chunk, matchSecond)));
+
+        if (mask) {
+            return i + LDi_lowestSetBit(mask);
+        }
+    }
+
+    return i + LDi_scanScalar(buffer + i, length - i, first, second);
+}
+#endif
+
+#ifdef LD_SCAN_AVX2
+__attribute__((target("avx2"))) static size_t
+LDi_scanAVX2(
+    const char *const buffer,
+    const size_t      length,
+    const char        first,
+    const char        second)
+{
+    size_t        i;
+    const __m256i matchFirst  = _mm256_set1_epi8(first);
+    const __m256i matchSecond = _mm256_set1_epi8(second);
+
+    for (i = 0; i + 32 <= length; i += 32) {
+        const __m256i chunk =
+            _mm256_loadu_si256((const __m256i *)(buffer + i));
+        const unsigned int mask =
+            (unsigned int)_mm256_movemask_epi8(_mm256_or_si256(
+                _mm256_cmpeq_epi8(chunk, matchFirst),
+                _mm256_cmpeq_epi8(chunk, matchSecond)));
+
+        if (mask) {
+            return i + LDi_lowestSetBit(mask);
+        }
+    }
+
+    return i + LDi_scanSSE2(buffer + i, length - i, first, second);
+}
+#endif
+
+#ifdef LD_SCAN_NEON
+static size_t
+LDi_scanNEON(
+    const char *const buffer,
+    const size_t      length,
+    const char        first,
+    const char        second)
+{
+    size_t           i;
+    const uint8x16_t matchFirst  = vdupq_n_u8((uint8_t)first);
+    const uint8x16_t matchSecond = vdupq_n_u8((uint8_t)second);
+
+    for (i = 0; i + 16 <= length; i += 16) {
+        const uint8x16_t chunk = vld1q_u8((const uint8_t *)(buffer + i));
+        const uint8x16_t matches = vorrq_u8(
+            vceqq_u8(chunk, matchFirst), vceqq_u8(chunk, matchSecond));
+        /* narrow each byte lane to a nibble, giving a 64 bit mask */
+        const uint64_t mask = vget_lane_u64(
+            vreinterpret_u64_u8(
+                vshrn_n_u16(vreinterpretq_u16_u8(matches), 4)),
+            0);
+
+        if (mask) {
+            return i + (size_t)(__builtin_ctzl(mask) / 4);
+        }
+    }
+
+    return i + LDi_scanScalar(buffer + i, length - i, first, second);
+}
+#endif
+
+size_t
+LDi_scanForEither(
+    const char *const buffer,
+    const size_t      length,
+    const char        first,
+    const char        second)
+{
+    LD_ASSERT(buffer || length == 0);
+
+    if (length < 16) {
+        return LDi_scanScalar(buffer, length, first, second);
+    }
+
+#ifdef LD_SCAN_AVX2
+    /* reads a feature word initialized by the runtime, so it is cheap
+     * enough to check on every call */
+    if (length >= 32 && __builtin_cpu_supports("avx2")) {
+        return LDi_scanAVX2(buffer, length, first, second);
+    }
+#endif
+
+#if defined(LD_SCAN_SSE2)
+    return LDi_scanSSE2(buffer, length, first, second);
+#elif defined(LD_SCAN_NEON)
+    return LDi_scanNEON(buffer, length, first, second);
+#else
+    return LDi_scanScalar(buffer, length, first, second);
+#endif
+}
+
+size_t
+LDi_scanForNewline(const char *const buffer, const size_t length)
+{
+    return LDi_scanForEither(buffer, length, '\n', '\n');
+}
+
+size_t
+LDi_scanForQuoteOrBackslash(const char *const buffer, const size_t length)
+{
+    return LDi_scanForEither(buffer, length, '"', '\\');
+}
+
+const char *
+LDi_scanKernelName(void)
+{
+#ifdef LD_SCAN_AVX2
+    if (__builtin_cpu_supports("avx2")) {
+        return "avx2";
+    }
+#endif
+
+#if defined(LD_SCAN_SSE2)
+    return "sse2";
+#elif defined(LD_SCAN_NEON)
+    return "neon";
+#else
+    return "scalar";
+#endif
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <stddef.h>
+
+/* Byte scanning kernels used by the SSE parser and JSON string parsing.
+ * Each call selects the widest implementation the running CPU supports:
+ * AVX2 or SSE2 on x86, NEON on AArch64, and a scalar loop elsewhere. */
+
+/* Returns the offset of the first byte equal to either first or second,
+ * or length when no such byte exists. */
+size_t
+LDi_scanForEither(
+    const char *const buffer,
+    const size_t      length,
+    const char        first,
+    const char        second);
+
+/* Returns the offset of the first newline, or length when there is none. */
+size_t
+LDi_scanForNewline(const char *const buffer, const size_t length);
+
+/* Returns the offset of the first double quote or backslash, or length
+ * when there is neither. */
+size_t
+LDi_scanForQuoteOrBackslash(const char *const buffer, const size_t length);
+
+/* Returns the name of the kernel selected at runtime, for diagnostics. */
+const char *
+LDi_scanKernelName(void);
@@ -3,6 +3,7 @@
 #include <launchdarkly/memory.h>
 
 #include "assertion.h"
+#include "scan.h"
 #include "sse.h"
 
 void
@@ -37,7 +38,8 @@ LDSSEParserDestroy(struct LDSSEParser *const parser)
 }
 
 static LDBoolean
-LDi_processLine(struct LDSSEParser *const parser, const char *line)
+LDi_processLine(
+    struct LDSSEParser *const parser, const char *line, size_t lineSize)
 {
     LD_ASSERT(parser);
     LD_ASSERT(line);
@@ -71,15 +73,19 @@ LDi_processLine(struct LDSSEParser *const parser, const char *line)
         if (status == LDBooleanFalse) {
             return LDBooleanFalse;
         }
-    } else if (strncmp(line, "data:", 5) == 0) {
+    } else if (lineSize >= 5 && memcmp(line, "data:", 5) == 0) {
         char *    eventBodyTmp;
-        size_t    lineSize, currentBodySize;
+        size_t    currentBodySize;
         LDBoolean notEmpty;
 
         line += 5;
-        line += line[0] == ' ';
+        lineSize -= 5;
+
+        if (line[0] == ' ') {
+            line++;
+            lineSize--;
+        }
 
-        lineSize = strlen(line);
         notEmpty = parser->eventBody != NULL;
 
         if (notEmpty) {
@@ -104,7 +110,7 @@ LDi_processLine(struct LDSSEParser *const parser, const char *line)
         memcpy(parser->eventBody + currentBodySize + notEmpty, line, lineSize);
 
         parser->eventBody[currentBodySize + notEmpty + lineSize] = '\0';
-    } else if (strncmp(line, "event:", 6) == 0) {
+    } else if (lineSize >= 6 && memcmp(line, "event:", 6) == 0) {
         /* skip prefix and optional space*/
         line += 6;
         line += line[0] == ' ';
@@ -130,8 +136,7 @@ LDSSEParserProcess(
     const size_t              bufferSize)
 {
     void * bufferTmp;
-    char * newLineLocation;
-    size_t consumed;
+    size_t consumed, scanned, found;
 
     LD_ASSERT(parser);
 
@@ -149,23 +154,29 @@ LDSSEParserProcess(
 
     parser->buffer = bufferTmp;
     consumed       = 0;
+    /* bytes retained from earlier calls are known to not contain a newline,
+     * so large events delivered over many reads are only scanned once */
+    scanned        = parser->bufferSize;
 
     memcpy(&(parser->buffer[parser->bufferSize]), buffer, bufferSize);
 
     parser->bufferSize += bufferSize;
     parser->buffer[parser->bufferSize] = '\0';
 
-    while (
-        (newLineLocation = (char *)memchr(
-             parser->buffer + consumed, '\n', parser->bufferSize - consumed)))
+    while ((found = LDi_scanForNewline(
+                parser->buffer + scanned, parser->bufferSize - scanned)) <
+           parser->bufferSize - scanned)
     {
-        *newLineLocation = '\0';
+        const size_t lineSize = scanned + found - consumed;
+
+        parser->buffer[consumed + lineSize] = '\0';
 
-        if (!LDi_processLine(parser, parser->buffer + consumed)) {
+        if (!LDi_processLine(parser, parser->buffer + consumed, lineSize)) {
             return LDBooleanFalse;
         }
 
-        consumed = newLineLocation - parser->buffer + 1;
+        consumed += lineSize + 1;
+        scanned = consumed;
     }
 
     if (consumed) {
@@ -253,3 +253,62 @@ LDi_UUIDv4(char *const buffer)
 
     return LDBooleanTrue;
 }
+
+#define LD_ROTL32(x, r) (((x) << (r)) | ((x) >> (32 - (r))))
+
+/* 32 bit MurmurHash3 with a zero seed. Input is consumed four bytes at a
+ * time, assembled little endian so the result is platform independent. */
+unsigned int
+LDi_hash32(const void *const key, const size_t keyLength)
+{
+    const unsigned char *bytes;
+    size_t               i, blocks;
+    unsigned int         hash, k;
+
+    LD_ASSERT(key);
+
+    bytes  = (const unsigned char *)key;
+    blocks = keyLength / 4;
+    hash   = 0;
+
+    for (i = 0; i < blocks; i++) {
+        k = (unsigned int)bytes[i * 4] |
+            ((unsigned int)bytes[i * 4 + 1] << 8) |
+            ((unsigned int)bytes[i * 4 + 2] << 16) |
+            ((unsigned int)bytes[i * 4 + 3] << 24);
+
+        k *= 0xcc9e2d51u;
+        k = LD_ROTL32(k, 15);
+        k *= 0x1b873593u;
+
+        hash ^= k;
+        hash = LD_ROTL32(hash, 13);
+        hash = hash * 5 + 0xe6546b64u;
+    }
+
+    k = 0;
+
+    switch (keyLength & 3) {
+        case 3:
+            k ^= (unsigned int)bytes[blocks * 4 + 2] << 16;
+            /* fall through */
+        case 2:
+            k ^= (unsigned int)bytes[blocks * 4 + 1] << 8;
+            /* fall through */
+        case 1:
+            k ^= (unsigned int)bytes[blocks * 4];
+            k *= 0xcc9e2d51u;
+            k = LD_ROTL32(k, 15);
+            k *= 0x1b873593u;
+            hash ^= k;
+    }
+
+    hash ^= (unsigned int)keyLength;
+    hash ^= hash >> 16;
+    hash *= 0x85ebca6bu;
+    hash ^= hash >> 13;
+    hash *= 0xc2b2ae35u;
+    hash ^= hash >> 16;
+
+    return hash;
+}
@@ -64,6 +64,11 @@ LDi_random(unsigned int *const result);
 LDBoolean
 LDSetString(char **const target, const char *const value);
 
+/* Non cryptographic hash for in memory indexes. The result does not
+ * depend on platform endianness or word size. */
+unsigned int
+LDi_hash32(const void *const key, const size_t keyLength);
+
 double
 LDi_normalize(
     const double n,
@@ -0,0 +1,184 @@
+#include "commonfixture.h"
+#include "gtest/gtest.h"
+
+extern "C" {
+#include <stdio.h>
+
+#include <launchdarkly/json.h>
+#include <launchdarkly/memory.h>
+
+#include "cJSON.h"
+#include "json_index.h"
+}
+
+class JSONIndexFixture : public CommonFixture {
+};
+
+static struct LDJSON *
+makeObject(const unsigned int count)
+{
+    struct LDJSON *object;
+    char key[32];
+    unsigned int i;
+
+    object = LDNewObject();
+
+    for (i = 0; i < count; i++) {
+        snprintf(key, sizeof(key), "key-%u", i);
+        LDObjectSetKey(object, key, LDNewNumber(i));
+    }
+
+    return object;
+}
+
+static bool
+isIndexed(const struct LDJSON *const object)
+{
+    return ((const cJSON *)object)->index != NULL;
+}
+
+TEST_F(JSONIndexFixture, SmallObjectsAreNotIndexed)
+{
+    struct LDJSON *object;
+
+    ASSERT_TRUE(object = makeObject(LD_OBJECT_INDEX_THRESHOLD / 2));
+
+    ASSERT_TRUE(LDObjectLookup(object, "key-7"));
+    ASSERT_FALSE(LDObjectLookup(object, "missing"));
+    ASSERT_FALSE(isIndexed(object));
+
+    LDJSONFree(object);
+}
+
+TEST_F(JSONIndexFixture, LargeObjectLookupsUseIndex)
+{
+    struct LDJSON *object, *item;
+    char key[32];
+    unsigned int i;
+
+    ASSERT_TRUE(object = makeObject(500));
+
+    ASSERT_FALSE(LDObjectLookup(object, "missing"));
+    ASSERT_TRUE(isIndexed(object));
+
+    for (i = 0; i < 500; i++) {
+        snprintf(key, sizeof(key), "key-%u", i);
+        ASSERT_TRUE(item = LDObjectLookup(object, key));
+        ASSERT_EQ(LDGetNumber(item), i);
+    }
+
+    LDJSONFree(object);
+}
+
+TEST_F(JSONIndexFixture, IndexFollowsMutation)
+{
+    struct LDJSON *object, *item, *iter;
+    char key[32];
+    unsigned int i, count;
+
+    ASSERT_TRUE(object = makeObject(100));
+    ASSERT_FALSE(LDObjectLookup(object, "missing"));
+    ASSERT_TRUE(isIndexed(object));
+
+    /* replace */
+    ASSERT_TRUE(LDObjectSetKey(object, "key-50", LDNewText("replaced")));
+    ASSERT_STREQ(LDGetText(LDObjectLookup(object, "key-50")), "replaced");
+
+    /* delete, including the first and last members */
+    LDObjectDeleteKey(object, "key-0");
+    LDObjectDeleteKey(object, "key-10");
+    LDObjectDeleteKey(object, "key-50");
+    ASSERT_FALSE(LDObjectLookup(object, "key-0"));
+    ASSERT_FALSE(LDObjectLookup(object, "key-10"));
+    ASSERT_FALSE(LDObjectLookup(object, "key-50"));
+
+    ASSERT_TRUE(item = LDObjectDetachKey(object, "key-99"));
+    LDJSONFree(item);
+    ASSERT_FALSE(LDObjectLookup(object, "key-99"));
+
+    /* append after removing the tail */
+    ASSERT_TRUE(LDObjectSetKey(object, "appended", LDNewBool(LDBooleanTrue)));
+    ASSERT_TRUE(isIndexed(object));
+
+    for (i = 1; i < 99; i++) {
+        if (i == 10 || i == 50) {
+            continue;
+        }
+
+        snprintf(key, sizeof(key), "key-%u", i);
+        ASSERT_TRUE(item = LDObjectLookup(object, key));
+        ASSERT_EQ(LDGetNumber(item), i);
+    }
+
+    ASSERT_TRUE(LDObjectLookup(object, "appended"));
+
+    /* member order is unaffected */
+    count = 0;
+    for (iter = LDGetIter(object); iter; iter = LDIterNext(iter)) {
+        count++;
+    }
+    ASSERT_EQ(count, 97);
+    ASSERT_STREQ(LDIterKey(LDGetIter(object)), "key-1");
+
+    LDJSONFree(object);
+}
+
+TEST_F(JSONIndexFixture, DuplicateKeysResolveToFirst)
+{
+    struct LDJSON *object;
+    cJSON *raw;
+
+    ASSERT_TRUE(object = makeObject(40));
+    raw = (cJSON *)object;
+
+    /* cJSON permits duplicate members, a linear search returns the first */
+    cJSON_AddItemToObject(raw, "key-39", cJSON_CreateString("second"));
+
+    ASSERT_FALSE(LDObjectLookup(object, "missing"));
+    ASSERT_TRUE(isIndexed(object));
+    ASSERT_EQ(LDGetNumber(LDObjectLookup(object, "key-39")), 39);
+
+    LDObjectDeleteKey(object, "key-39");
+    ASSERT_STREQ(LDGetText(LDObjectLookup(object, "key-39")), "second");
+
+    LDJSONFree(object);
+}
+
+TEST_F(JSONIndexFixture, DuplicatedAndParsedObjectsAreIndependent)
+{
+    struct LDJSON *object, *copy, *parsed;
+    char *serialized;
+
+    ASSERT_TRUE(object = makeObject(64));
+    ASSERT_FALSE(LDObjectLookup(object, "missing"));
+
+    ASSERT_TRUE(copy = LDJSONDuplicate(object));
+    ASSERT_FALSE(isIndexed(copy));
+    ASSERT_TRUE(LDObjectLookup(copy, "key-63"));
+
+    ASSERT_TRUE(serialized = LDJSONSerialize(object));
+    ASSERT_TRUE(parsed = LDJSONDeserialize(serialized));
+    ASSERT_EQ(LDGetNumber(LDObjectLookup(parsed, "key-60")), 60);
+
+    LDJSONFree(object);
+    LDJSONFree(copy);
+    LDJSONFree(parsed);
+    LDFree(serialized);
+}
+
+TEST_F(JSONIndexFixture, ReferenceIndexIsFreed)
+{
+    struct LDJSON *object;
+    cJSON *reference;
+
+    ASSERT_TRUE(object = makeObject(500));
+    ASSERT_TRUE(reference =
+        cJSON_CreateObjectReference(((cJSON *)object)->child));
+
+    /* the reference indexes the shared children itself */
+    ASSERT_TRUE(LDObjectLookup((struct LDJSON *)reference, "key-250"));
+    ASSERT_TRUE(reference->index);
+
+    cJSON_Delete(reference);
+    LDJSONFree(object);
+}
@@ -0,0 +1,113 @@
+#include "commonfixture.h"
+#include "gtest/gtest.h"
+
+extern "C" {
+#include <string.h>
+
+#include <launchdarkly/json.h>
+#include <launchdarkly/memory.h>
+
+#include "assertion.h"
+#include "cJSON.h"
+#include "concurrency.h"
+#include "json_pool.h"
+#include "json_writer.h"
+}
+
+class JSONPoolFixture : public CommonFixture {
+protected:
+    void
+    SetUp() override
+    {
+        CommonFixture::SetUp();
+
+        ASSERT_TRUE(LDi_jsonPoolInitialize());
+    }
+};
+
+TEST_F(JSONPoolFixture, FreedBlocksAreReused)
+{
+    struct LDJSONPoolStatistics before, after;
+    void *first, *second;
+
+    ASSERT_TRUE(first = LDi_jsonPoolAllocate(40));
+    memset(first, 0xAB, 40);
+    LDi_jsonPoolFree(first);
+
+    LDi_jsonPoolStatistics(&before);
+
+    /* same size class as the freed block */
+    ASSERT_TRUE(second = LDi_jsonPoolAllocate(33));
+    ASSERT_EQ(first, second);
+
+    LDi_jsonPoolStatistics(&after);
+    ASSERT_EQ(before.hits + 1, after.hits);
+    ASSERT_EQ(before.misses, after.misses);
+
+    LDi_jsonPoolFree(second);
+}
+
+TEST_F(JSONPoolFixture, LargeBlocksAreNotPooled)
+{
+    struct LDJSONPoolStatistics before, after;
+    void *block;
+
+    LDi_jsonPoolStatistics(&before);
+
+    ASSERT_TRUE(block = LDi_jsonPoolAllocate(4096));
+    memset(block, 0, 4096);
+    LDi_jsonPoolFree(block);
+
+    LDi_jsonPoolStatistics(&after);
+    ASSERT_EQ(before.oversized + 1, after.oversized);
+    ASSERT_EQ(before.hits, after.hits);
+
+    LDi_jsonPoolFree(NULL);
+}
+
+static THREAD_RETURN
+threadFreeBlock(void *const block)
+{
+    LD_ASSERT(block);
+
+    LDi_jsonPoolFree(block);
+
+    return THREAD_RETURN_DEFAULT;
+}
+
+TEST_F(JSONPoolFixture, BlocksMayBeFreedOnAnotherThread)
+{
+    ld_thread_t thread;
+    void *block;
+
+    ASSERT_TRUE(block = LDi_jsonPoolAllocate(72));
+    memset(block, 0, 72);
+
+    /* the block is cached by the other thread, then released on exit */
+    ASSERT_TRUE(LDi_thread_create(&thread, threadFreeBlock, block));
+    ASSERT_TRUE(LDi_thread_join(&thread));
+}
+
+TEST_F(JSONPoolFixture, InstalledAsJSONHooks)
+{
+    struct cJSON_Hooks hooks;
+    struct LDJSON *object;
+    char *serialized;
+
+    hooks.malloc_fn = LDi_jsonPoolAllocate;
+    hooks.free_fn   = LDi_jsonPoolFree;
+    cJSON_InitHooks(&hooks);
+
+    ASSERT_TRUE(object = LDJSONDeserialize("{\"key\":\"value\",\"n\":[1,2]}"));
+    ASSERT_TRUE(LDObjectSetKey(object, "extra", LDNewText("text")));
+
+    ASSERT_TRUE(serialized = LDi_serializeJSON(object));
+    ASSERT_STREQ(serialized, "{\"key\":\"value\",\"n\":[1,2],\"extra\":\"text\"}");
+    LDFree(serialized);
+
+    LDJSONFree(object);
+
+    hooks.malloc_fn = LDAlloc;
+    hooks.free_fn   = LDFree;
+    cJSON_InitHooks(&hooks);
+}
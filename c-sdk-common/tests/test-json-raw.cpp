@@ -0,0 +1,89 @@
+#include "commonfixture.h"
+#include "gtest/gtest.h"
+
+extern "C" {
+#include <string.h>
+
+#include <launchdarkly/json.h>
+#include <launchdarkly/memory.h>
+
+#include "cJSON.h"
+#include "json_raw.h"
+}
+
+class JSONRawFixture : public CommonFixture {
+};
+
+static LDBoolean
+validate(const char *const text)
+{
+    return LDi_validateJSON(text, strlen(text));
+}
+
+TEST_F(JSONRawFixture, AcceptsValidDocuments)
+{
+    const char *const documents[] = {
+        "{}", "[]", " [ ] ", "true", "false", "null", "0", "-0", "12",
+        "-1.5e+10", "2E-3", "0.25", "\"\"", "\"a\\\"b\\\\c\\/\\b\\f\\n\\r\\t\"",
+        "\"\\u00e9\\uD83D\\uDE00\"", "\"caf\xc3\xa9\"",
+        "{\"a\":1,\"b\":[true,false,null],\"c\":{\"d\":\"e\"}}",
+        "\n{ \"a\" : [ 1 , { } , [ ] ] }\r\n", "[[[[[]]]]]", "[{},{}]"
+    };
+    size_t i;
+
+    for (i = 0; i < sizeof(documents) / sizeof(documents[0]); i++) {
+        EXPECT_TRUE(validate(documents[i])) << documents[i];
+    }
+}
+
+TEST_F(JSONRawFixture, RejectsInvalidDocuments)
+{
+    const char *const documents[] = {
+        "", " ", "{", "}", "[", "]", "[1,]", "[,1]", "{\"a\"}", "{\"a\":}",
+        "{\"a\":1,}", "{1:2}", "{\"a\" 1}", "[1 2]", "tru", "nul", "True",
+        "01", "-", "1.", ".5", "1e", "1e+", "+1", "0x10", "\"abc", "\"\\x\"",
+        "\"\\u12\"", "\"\\u12G4\"", "\"a\tb\"", "[1]]", "{}{}", "1 2",
+        "[\"a\",]", "{\"a\":1]", "[1}", "'a'", "NaN"
+    };
+    size_t i;
+
+    for (i = 0; i < sizeof(documents) / sizeof(documents[0]); i++) {
+        EXPECT_FALSE(validate(documents[i])) << documents[i];
+    }
+}
+
+TEST_F(JSONRawFixture, RespectsLengthAndNestingLimit)
+{
+    std::string nested;
+
+    /* bytes past the length are not part of the document */
+    ASSERT_TRUE(LDi_validateJSON("[1]garbage", 3));
+    ASSERT_FALSE(LDi_validateJSON("[1]", 2));
+    ASSERT_FALSE(LDi_validateJSON("[1,\0]", 5));
+
+    nested = std::string(CJSON_NESTING_LIMIT, '[') +
+        std::string(CJSON_NESTING_LIMIT, ']');
+    ASSERT_TRUE(LDi_validateJSON(nested.c_str(), nested.size()));
+
+    nested = "[" + nested + "]";
+    ASSERT_FALSE(LDi_validateJSON(nested.c_str(), nested.size()));
+}
+
+TEST_F(JSONRawFixture, RawValuesAreSerializedVerbatim)
+{
+    struct LDJSON *object, *raw, *copy;
+    char *serialized;
+
+    ASSERT_TRUE(object = LDNewObject());
+    ASSERT_TRUE(raw = LDi_newRawJSON("{\"a\": [1, 2.50]}garbage", 16));
+    ASSERT_TRUE(LDObjectSetKey(object, "data", raw));
+
+    ASSERT_TRUE(copy = LDJSONDuplicate(object));
+
+    ASSERT_TRUE(serialized = LDJSONSerialize(copy));
+    ASSERT_STREQ(serialized, "{\"data\":{\"a\": [1, 2.50]}}");
+
+    LDFree(serialized);
+    LDJSONFree(copy);
+    LDJSONFree(object);
+}
@@ -0,0 +1,131 @@
+#include "commonfixture.h"
+#include "gtest/gtest.h"
+
+extern "C" {
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <launchdarkly/json.h>
+#include <launchdarkly/memory.h>
+
+#include "cJSON.h"
+#include "json_writer.h"
+}
+
+class JSONWriterFixture : public CommonFixture {
+};
+
+static void
+expectMatchesCJSON(const struct LDJSON *const json)
+{
+    char *expected, *actual;
+
+    ASSERT_TRUE(expected = cJSON_PrintUnformatted((const cJSON *)json));
+    ASSERT_TRUE(actual = LDi_serializeJSON(json));
+
+    ASSERT_STREQ(actual, expected);
+
+    cJSON_free(expected);
+    LDFree(actual);
+}
+
+TEST_F(JSONWriterFixture, NumbersMatchCJSON)
+{
+    const double numbers[] = {
+        0, 1, -1, 7, 10, 99, 100, 123456789, 999999999, 1000000000,
+        1000000001, -1000000000, 1609459200000.0, -1609459200000.0,
+        999999999999999.0, -999999999999999.0, 1e15, -1e15, 1e16, 1e21,
+        9007199254740992.0, 0.5, -0.5, 0.1, 0.3, 1.0 / 3.0, 2.0 / 3.0,
+        0.1 + 0.2, 3.14159265358979, 1e-7, 5e-324, 1.7976931348623157e308,
+        123.456, 1609459200000.5, -0.0
+    };
+    size_t i;
+
+    for (i = 0; i < sizeof(numbers) / sizeof(numbers[0]); i++) {
+        struct LDJSON *json;
+
+        ASSERT_TRUE(json = LDNewNumber(numbers[i]));
+        expectMatchesCJSON(json);
+        LDJSONFree(json);
+    }
+}
+
+TEST_F(JSONWriterFixture, RandomNumbersMatchCJSON)
+{
+    size_t i;
+
+    srand(42);
+
+    for (i = 0; i < 20000; i++) {
+        struct LDJSON *json;
+        double number;
+
+        /* mix of integers across magnitudes and arbitrary fractions */
+        number = ldexp((double) rand() / RAND_MAX, rand() % 64 - 8);
+
+        if (i % 2) {
+            number = floor(number);
+        }
+
+        if (i % 3 == 0) {
+            number = -number;
+        }
+
+        ASSERT_TRUE(json = LDNewNumber(number));
+        expectMatchesCJSON(json);
+        LDJSONFree(json);
+    }
+}
+
+TEST_F(JSONWriterFixture, NonFiniteNumbersAreNull)
+{
+    struct LDJSON *json;
+    char *serialized;
+
+    ASSERT_TRUE(json = LDNewNumber(HUGE_VAL));
+    ASSERT_TRUE(serialized = LDJSONSerialize(json));
+    ASSERT_STREQ(serialized, "null");
+
+    LDFree(serialized);
+    LDJSONFree(json);
+}
+
+TEST_F(JSONWriterFixture, StringsMatchCJSON)
+{
+    const char *const strings[] = {
+        "", "plain", "quote \" and backslash \\",
+        "control \b \f \n \r \t \x01 \x1f end", "\x7f del",
+        "utf8 \xc3\xa9\xe2\x82\xac", "/slash/"
+    };
+    size_t i;
+
+    for (i = 0; i < sizeof(strings) / sizeof(strings[0]); i++) {
+        struct LDJSON *json;
+
+        ASSERT_TRUE(json = LDNewText(strings[i]));
+        expectMatchesCJSON(json);
+        LDJSONFree(json);
+    }
+}
+
+TEST_F(JSONWriterFixture, DocumentsMatchCJSON)
+{
+    const char *const documents[] = {
+        "{}", "[]", "[[],{}]", "true", "null",
+        "{\"kind\":\"feature\",\"creationDate\":1609459200000,"
+        "\"key\":\"flag\",\"value\":true,\"default\":false,\"version\":12,"
+        "\"variation\":1,\"user\":{\"key\":\"abc\",\"custom\":{\"a\":[1,2.5,"
+        "\"x\\ny\",null,false,{\"nested\":-3}]}}}",
+        "[0.1,1e300,-5,\"\\u0001\"]"
+    };
+    size_t i;
+
+    for (i = 0; i < sizeof(documents) / sizeof(documents[0]); i++) {
+        struct LDJSON *json;
+
+        ASSERT_TRUE(json = LDJSONDeserialize(documents[i]));
+        expectMatchesCJSON(json);
+        LDJSONFree(json);
+    }
+}
@@ -181,3 +181,45 @@ TEST_F(PlatformFixture, ConditionVars)
     ASSERT_TRUE(LDi_mutex_destroy(&conditionTestLock));
     ASSERT_TRUE(LDi_thread_join(&thread));
 }
+
+static LDBoolean conditionTestReady;
+
+static THREAD_RETURN
+threadWaitCondition(void *const condition)
+{
+    LD_ASSERT(condition);
+
+    LD_ASSERT(LDi_mutex_lock(&conditionTestLock));
+    while (!conditionTestReady) {
+        LD_ASSERT(LDi_cond_wait(
+            (ld_cond_t *)condition, &conditionTestLock, LD_COND_WAIT_FOREVER));
+    }
+    LD_ASSERT(LDi_mutex_unlock(&conditionTestLock));
+
+    return THREAD_RETURN_DEFAULT;
+}
+
+TEST_F(PlatformFixture, ConditionBroadcastWakesEveryWaiter)
+{
+    ld_cond_t   condition;
+    ld_thread_t first, second;
+
+    conditionTestReady = LDBooleanFalse;
+
+    ASSERT_TRUE(LDi_mutex_init(&conditionTestLock));
+    LDi_cond_init(&condition);
+
+    ASSERT_TRUE(LDi_thread_create(&first, threadWaitCondition, &condition));
+    ASSERT_TRUE(LDi_thread_create(&second, threadWaitCondition, &condition));
+
+    ASSERT_TRUE(LDi_mutex_lock(&conditionTestLock));
+    conditionTestReady = LDBooleanTrue;
+    ASSERT_TRUE(LDi_cond_broadcast(&condition));
+    ASSERT_TRUE(LDi_mutex_unlock(&conditionTestLock));
+
+    ASSERT_TRUE(LDi_thread_join(&first));
+    ASSERT_TRUE(LDi_thread_join(&second));
+
+    LDi_cond_destroy(&condition);
+    ASSERT_TRUE(LDi_mutex_destroy(&conditionTestLock));
+}
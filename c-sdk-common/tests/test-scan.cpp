@@ -0,0 +1,89 @@
+#include "commonfixture.h"
+#include "gtest/gtest.h"
+
+extern "C" {
+#include <string.h>
+
+#include <launchdarkly/json.h>
+#include <launchdarkly/memory.h>
+
+#include "scan.h"
+}
+
+class ScanFixture : public CommonFixture {
+};
+
+static size_t
+naiveScan(const char *const buffer, const size_t length, const char a, const char b)
+{
+    size_t i;
+
+    for (i = 0; i < length; i++) {
+        if (buffer[i] == a || buffer[i] == b) {
+            return i;
+        }
+    }
+
+    return length;
+}
+
+TEST_F(ScanFixture, MatchesNaiveScanAtEveryOffsetAndAlignment)
+{
+    char buffer[160];
+    size_t offset, length, match;
+
+    for (offset = 0; offset < 8; offset++) {
+        for (length = 0; length < sizeof(buffer) - offset; length++) {
+            for (match = 0; match <= length; match++) {
+                memset(buffer, 'x', sizeof(buffer));
+
+                if (match < length) {
+                    buffer[offset + match] = (match % 2) ? '"' : '\\';
+                }
+
+                ASSERT_EQ(
+                    LDi_scanForQuoteOrBackslash(buffer + offset, length),
+                    naiveScan(buffer + offset, length, '"', '\\'));
+            }
+        }
+    }
+}
+
+TEST_F(ScanFixture, FindsNewlineAfterLongRun)
+{
+    char buffer[1000];
+
+    memset(buffer, 'a', sizeof(buffer));
+    buffer[777] = '\n';
+
+    ASSERT_EQ(LDi_scanForNewline(buffer, sizeof(buffer)), 777);
+    ASSERT_EQ(LDi_scanForNewline(buffer, 777), 777);
+    ASSERT_EQ(LDi_scanForNewline(buffer, 0), 0);
+}
+
+TEST_F(ScanFixture, ParsesLongStringsWithEscapes)
+{
+    struct LDJSON *json;
+    const char *const raw =
+        "\"a fairly long string value that crosses several vector widths \\\" "
+        "then an escaped quote, a \\\\ backslash, a tab \\t and a unicode "
+        "\\u00e9 escape before ending after another long literal run\"";
+    const char *const expected =
+        "a fairly long string value that crosses several vector widths \" "
+        "then an escaped quote, a \\ backslash, a tab \t and a unicode "
+        "\xc3\xa9 escape before ending after another long literal run";
+
+    ASSERT_TRUE(json = LDJSONDeserialize(raw));
+    ASSERT_EQ(LDJSONGetType(json), LDText);
+    ASSERT_STREQ(LDGetText(json), expected);
+
+    LDJSONFree(json);
+}
+
+TEST_F(ScanFixture, RejectsUnterminatedStrings)
+{
+    ASSERT_FALSE(LDJSONDeserialize(
+        "\"an unterminated string that is longer than a single vector"));
+    ASSERT_FALSE(LDJSONDeserialize(
+        "\"an unterminated string that ends with an escape \\"));
+}
@@ -39,3 +39,24 @@ TEST_F(SseFixture, BasicEvent)
 
     LDSSEParserDestroy(&parser);
 }
+
+TEST_F(SseFixture, MultiLineEventSplitAcrossChunks)
+{
+    struct LDSSEParser parser;
+
+    LDSSEParserInitialize(&parser, mockDispatch, NULL);
+
+    const char *const first =
+        "event: put\n"
+        "data: the first line of a body that is longer than a vector\n"
+        "data:second";
+    const char *const second = " line\n\n";
+
+    ASSERT_TRUE(LDSSEParserProcess(&parser, first, strlen(first)));
+    ASSERT_TRUE(LDSSEParserProcess(&parser, second, strlen(second)));
+    ASSERT_STREQ(nameBuffer, "put");
+    ASSERT_STREQ(bodyBuffer,
+        "the first line of a body that is longer than a vector\nsecond line");
+
+    LDSSEParserDestroy(&parser);
+}
@@ -103,6 +103,15 @@ LDClientCPP::stringVariation(const std::string &key,
     return LDStringVariation(this->client, key.c_str(), def.c_str(), buf, len);
 }
 
+LDBorrowedStringCPP
+LDClientCPP::stringVariationBorrowed(const std::string &key,
+    const char *const def)
+{
+    LDBorrowedStringCPP result;
+    LDStringVariationBorrow(this->client, key.c_str(), def, &result.borrowed);
+    return result;
+}
+
 struct LDJSON *
 LDClientCPP::JSONVariationDetail(const std::string &key,
     const struct LDJSON *const def, LDVariationDetails *const details)
@@ -215,3 +224,19 @@ LDClientCPP::unregisterFeatureFlagListener(const std::string &name,
 {
     LDClientUnregisterFeatureFlagListener(this->client, name.c_str(), fn);
 }
+
+bool
+LDClientCPP::registerFlagChangeListener(const std::string &name,
+    LDFlagChangeListener fn, void *const context)
+{
+    return LDClientRegisterFlagChangeListener(
+        this->client, name.c_str(), fn, context);
+}
+
+void
+LDClientCPP::unregisterFlagChangeListener(const std::string &name,
+    LDFlagChangeListener fn, void *const context)
+{
+    LDClientUnregisterFlagChangeListener(
+        this->client, name.c_str(), fn, context);
+}
@@ -7,6 +7,66 @@
 
 #include <launchdarkly/api.h>
 
+#include <cstddef>
+#include <string>
+
+#if __cplusplus >= 201703L
+#include <string_view>
+#endif
+
+/**
+ * @brief A string flag value borrowed from the flag store, obtained with
+ * `LDClientCPP::stringVariationBorrowed`.
+ *
+ * The value stays valid until the guard is destroyed. Guards may be moved
+ * but not copied.
+ */
+class LDBorrowedStringCPP {
+    public:
+        LDBorrowedStringCPP() {
+            this->borrowed.value = "";
+            this->borrowed.length = 0;
+            this->borrowed.pin = NULL;
+        }
+
+        ~LDBorrowedStringCPP() {
+            LDBorrowedStringRelease(&this->borrowed);
+        }
+
+        LDBorrowedStringCPP(LDBorrowedStringCPP &&other) : borrowed(other.borrowed) {
+            other.borrowed.pin = NULL;
+        }
+
+        LDBorrowedStringCPP &operator=(LDBorrowedStringCPP &&other) {
+            if (this != &other) {
+                LDBorrowedStringRelease(&this->borrowed);
+                this->borrowed = other.borrowed;
+                other.borrowed.pin = NULL;
+            }
+            return *this;
+        }
+
+        LDBorrowedStringCPP(const LDBorrowedStringCPP &) = delete;
+        LDBorrowedStringCPP &operator=(const LDBorrowedStringCPP &) = delete;
+
+        /** @brief NULL terminated value. */
+        const char *c_str() const { return this->borrowed.value; }
+
+        /** @brief Length of the value in bytes. */
+        std::size_t size() const { return this->borrowed.length; }
+
+#if __cplusplus >= 201703L
+        /** @brief View of the value, valid for the lifetime of the guard. */
+        std::string_view view() const {
+            return std::string_view(this->borrowed.value, this->borrowed.length);
+        }
+#endif
+    private:
+        friend class LDClientCPP;
+
+        LDBorrowedString borrowed;
+};
+
 class LD_EXPORT(LDClientCPP) {
     public:
         /**
@@ -64,6 +124,12 @@ class LD_EXPORT(LDClientCPP) {
         char *stringVariation(const std::string &flagKey,
             const std::string &fallback, char *resultBuffer, size_t resultBufferSize);
 
+        /** @brief Evaluate String flag without copying the value.
+         * When the fallback is selected the result refers to `fallback`,
+         * which must outlive it. */
+        LDBorrowedStringCPP stringVariationBorrowed(const std::string &flagKey,
+            const char *fallback);
+
         /** @brief Evaluate JSON flag.
          * @return LDJSON pointer which must be freed with `LDJSONFree`.
          */
@@ -148,6 +214,14 @@ class LD_EXPORT(LDClientCPP) {
 
         /** @brief Unregister a callback registered with `LDClientRegisterFeatureFlagListener`. */
         void unregisterFeatureFlagListener(const std::string &name, LDlistenerfn fn);
+
+        /** @brief Register a callback receiving the old and new value when a flag is updated. */
+        bool registerFlagChangeListener(const std::string &name,
+            LDFlagChangeListener fn, void *const context);
+
+        /** @brief Unregister a callback registered with `registerFlagChangeListener`. */
+        void unregisterFlagChangeListener(const std::string &name,
+            LDFlagChangeListener fn, void *const context);
     private:
         struct LDClient *client;
 };
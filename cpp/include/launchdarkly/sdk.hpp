@@ -0,0 +1,445 @@
+/*!
+ * @file sdk.hpp
+ * @brief Header only C++17 bindings for the LaunchDarkly Client Side C/C++
+ * SDK.
+ *
+ * Unlike `api.hpp` this interface is not a singleton and does not copy flag
+ * values. Flag keys are hashed once, at compile time when the key is a
+ * constant expression, and string and JSON results are borrowed from the
+ * flag store through move-only guards.
+ *
+ * @code
+ * constexpr launchdarkly::FlagKey kCheckout("checkout-flow");
+ *
+ * launchdarkly::Client client(config, launchdarkly::User("user-key"), 0);
+ *
+ * if (client.variation(kCheckout, false)) { ... }
+ *
+ * auto banner = client.variation<std::string_view>("banner-text", "hello");
+ * render(banner.view());
+ * @endcode
+ */
+
+#pragma once
+
+#if __cplusplus < 201703L && !(defined(_MSVC_LANG) && _MSVC_LANG >= 201703L)
+#error "launchdarkly/sdk.hpp requires C++17, use launchdarkly/api.hpp instead"
+#endif
+
+#include <launchdarkly/api.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <utility>
+
+namespace launchdarkly {
+
+namespace detail {
+
+constexpr std::uint32_t rotl32(const std::uint32_t x, const int r) noexcept {
+    return (x << r) | (x >> (32 - r));
+}
+
+constexpr std::uint32_t scramble(std::uint32_t k) noexcept {
+    k *= 0xcc9e2d51u;
+    k = rotl32(k, 15);
+    k *= 0x1b873593u;
+    return k;
+}
+
+constexpr std::uint32_t byte(const std::string_view key, const std::size_t i) noexcept {
+    return static_cast<std::uint32_t>(static_cast<unsigned char>(key[i]));
+}
+
+/**
+ * @brief 32-bit MurmurHash3 with a seed of zero. Must match the hash the
+ * flag store uses, see `LDFlagKey`.
+ */
+constexpr std::uint32_t murmur3(const std::string_view key) noexcept {
+    const std::size_t blocks = key.size() / 4;
+    std::uint32_t hash = 0;
+    std::uint32_t k = 0;
+
+    for (std::size_t i = 0; i < blocks; i++) {
+        k = byte(key, i * 4) | (byte(key, i * 4 + 1) << 8) |
+            (byte(key, i * 4 + 2) << 16) | (byte(key, i * 4 + 3) << 24);
+
+        hash ^= scramble(k);
+        hash = rotl32(hash, 13);
+        hash = hash * 5 + 0xe6546b64u;
+    }
+
+    k = 0;
+
+    switch (key.size() & 3) {
+        case 3:
+            k ^= byte(key, blocks * 4 + 2) << 16;
+            [[fallthrough]];
+        case 2:
+            k ^= byte(key, blocks * 4 + 1) << 8;
+            [[fallthrough]];
+        case 1:
+            k ^= byte(key, blocks * 4);
+            hash ^= scramble(k);
+    }
+
+    hash ^= static_cast<std::uint32_t>(key.size());
+    hash ^= hash >> 16;
+    hash *= 0x85ebca6bu;
+    hash ^= hash >> 13;
+    hash *= 0xc2b2ae35u;
+    hash ^= hash >> 16;
+
+    return hash;
+}
+
+template <typename T>
+struct Variation;
+
+} // namespace detail
+
+/**
+ * @brief A flag key with its length and hash computed ahead of time.
+ *
+ * Declare keys `constexpr` to hash them at compile time. The key string
+ * must outlive the `FlagKey`, which string literals always do.
+ */
+class FlagKey {
+    public:
+        constexpr FlagKey(const char *const key, const std::size_t length) noexcept
+            : prepared{key, length,
+                  static_cast<unsigned int>(detail::murmur3(std::string_view(key, length))), 0} {}
+
+        explicit constexpr FlagKey(const char *const key) noexcept
+            : FlagKey(key, std::char_traits<char>::length(key)) {}
+
+        /** @brief Prepared key for the C `*VariationKey` functions. */
+        constexpr const LDFlagKey *get() const noexcept { return &this->prepared; }
+
+        constexpr std::string_view name() const noexcept {
+            return std::string_view(this->prepared.key, this->prepared.length);
+        }
+
+        constexpr unsigned int hash() const noexcept { return this->prepared.hash; }
+    private:
+        LDFlagKey prepared;
+};
+
+/**
+ * @brief A string flag value borrowed from the flag store.
+ *
+ * The value stays valid, even if the flag is updated, until the guard is
+ * destroyed. When the fallback was selected the guard refers to the caller's
+ * fallback, which must outlive it.
+ */
+class BorrowedString {
+    public:
+        BorrowedString() noexcept : borrowed{"", 0, nullptr} {}
+
+        ~BorrowedString() { LDBorrowedStringRelease(&this->borrowed); }
+
+        BorrowedString(BorrowedString &&other) noexcept
+            : borrowed(other.borrowed), fallback(other.fallback) {
+            other.borrowed.pin = nullptr;
+        }
+
+        BorrowedString &operator=(BorrowedString &&other) noexcept {
+            if (this != &other) {
+                LDBorrowedStringRelease(&this->borrowed);
+                this->borrowed = other.borrowed;
+                this->fallback = other.fallback;
+                other.borrowed.pin = nullptr;
+            }
+            return *this;
+        }
+
+        BorrowedString(const BorrowedString &) = delete;
+        BorrowedString &operator=(const BorrowedString &) = delete;
+
+        /** @brief View of the value, valid for the lifetime of the guard. */
+        std::string_view view() const noexcept {
+            if (this->borrowed.pin) {
+                return std::string_view(this->borrowed.value, this->borrowed.length);
+            }
+            return this->fallback;
+        }
+
+        operator std::string_view() const noexcept { return this->view(); }
+
+        /** @brief True if the value came from the flag store. */
+        bool fromStore() const noexcept { return this->borrowed.pin != nullptr; }
+    private:
+        friend struct detail::Variation<std::string_view>;
+
+        LDBorrowedString borrowed;
+        std::string_view fallback;
+};
+
+/**
+ * @brief A JSON flag value shared with the flag store.
+ *
+ * The value is immutable and stays valid until the guard is destroyed. When
+ * the fallback was selected the guard refers to the caller's fallback.
+ */
+class BorrowedJSON {
+    public:
+        BorrowedJSON() noexcept : borrowed{nullptr, nullptr} {}
+
+        ~BorrowedJSON() { LDBorrowedJSONRelease(&this->borrowed); }
+
+        BorrowedJSON(BorrowedJSON &&other) noexcept : borrowed(other.borrowed) {
+            other.borrowed.pin = nullptr;
+        }
+
+        BorrowedJSON &operator=(BorrowedJSON &&other) noexcept {
+            if (this != &other) {
+                LDBorrowedJSONRelease(&this->borrowed);
+                this->borrowed = other.borrowed;
+                other.borrowed.pin = nullptr;
+            }
+            return *this;
+        }
+
+        BorrowedJSON(const BorrowedJSON &) = delete;
+        BorrowedJSON &operator=(const BorrowedJSON &) = delete;
+
+        /** @brief The value, which must not be modified or freed. */
+        const struct LDJSON *get() const noexcept { return this->borrowed.value; }
+
+        /** @brief True if the value came from the flag store. */
+        bool fromStore() const noexcept { return this->borrowed.pin != nullptr; }
+    private:
+        friend struct detail::Variation<const struct LDJSON *>;
+
+        LDBorrowedJSON borrowed;
+};
+
+namespace detail {
+
+/* Keys and fallbacks shorter than this are terminated on the stack rather
+ * than the heap. */
+constexpr std::size_t inlineStringCapacity = 128;
+
+template <>
+struct Variation<bool> {
+    using Result = bool;
+
+    static bool evaluate(struct LDClient *const client, const LDFlagKey *const key,
+        const bool fallback) noexcept {
+        return LDBoolVariationKey(client, key,
+            fallback ? LDBooleanTrue : LDBooleanFalse) != LDBooleanFalse;
+    }
+};
+
+template <>
+struct Variation<int> {
+    using Result = int;
+
+    static int evaluate(struct LDClient *const client, const LDFlagKey *const key,
+        const int fallback) noexcept {
+        return LDIntVariationKey(client, key, fallback);
+    }
+};
+
+template <>
+struct Variation<double> {
+    using Result = double;
+
+    static double evaluate(struct LDClient *const client, const LDFlagKey *const key,
+        const double fallback) noexcept {
+        return LDDoubleVariationKey(client, key, fallback);
+    }
+};
+
+template <>
+struct Variation<std::string_view> {
+    using Result = BorrowedString;
+
+    /* Allocates, and so may throw, for fallbacks of 128 bytes or more. */
+    static BorrowedString evaluate(struct LDClient *const client,
+        const LDFlagKey *const key, const std::string_view fallback) {
+        BorrowedString result;
+
+        /* A fallback view need not be NULL terminated, so the C API, which
+         * reports the fallback in events, is given a terminated copy. The
+         * copy does not outlive the call, view() substitutes the caller's
+         * fallback whenever nothing was borrowed from the store. */
+        if (fallback.size() < inlineStringCapacity) {
+            char buffer[inlineStringCapacity];
+
+            std::memcpy(buffer, fallback.data(), fallback.size());
+            buffer[fallback.size()] = '\0';
+
+            LDStringVariationBorrowKey(client, key, buffer, &result.borrowed);
+        } else {
+            const std::string terminated(fallback);
+
+            LDStringVariationBorrowKey(
+                client, key, terminated.c_str(), &result.borrowed);
+        }
+
+        result.fallback = fallback;
+
+        return result;
+    }
+};
+
+template <>
+struct Variation<const struct LDJSON *> {
+    using Result = BorrowedJSON;
+
+    static BorrowedJSON evaluate(struct LDClient *const client,
+        const LDFlagKey *const key, const struct LDJSON *const fallback) noexcept {
+        BorrowedJSON result;
+
+        LDJSONVariationBorrowKey(client, key, fallback, &result.borrowed);
+
+        return result;
+    }
+};
+
+} // namespace detail
+
+/** @brief The type returned by `Client::variation<T>`. */
+template <typename T>
+using VariationResult = typename detail::Variation<T>::Result;
+
+/** @brief A user, owned until it is passed to a `Client`. */
+class User {
+    public:
+        explicit User(const char *const key) noexcept : user(LDUserNew(key)) {}
+
+        /** @brief Take ownership of a user created with the C API. */
+        explicit User(struct LDUser *const user) noexcept : user(user) {}
+
+        ~User() {
+            if (this->user) {
+                LDUserFree(this->user);
+            }
+        }
+
+        User(User &&other) noexcept : user(std::exchange(other.user, nullptr)) {}
+
+        User &operator=(User &&other) noexcept {
+            if (this != &other) {
+                if (this->user) {
+                    LDUserFree(this->user);
+                }
+                this->user = std::exchange(other.user, nullptr);
+            }
+            return *this;
+        }
+
+        User(const User &) = delete;
+        User &operator=(const User &) = delete;
+
+        /** @brief For use with the `LDUserSet*` functions. */
+        struct LDUser *get() const noexcept { return this->user; }
+
+        /** @brief Give up ownership of the user. */
+        struct LDUser *release() noexcept { return std::exchange(this->user, nullptr); }
+
+        explicit operator bool() const noexcept { return this->user != nullptr; }
+    private:
+        struct LDUser *user;
+};
+
+/**
+ * @brief An initialized client, closed when destroyed.
+ *
+ * As with `LDClientInit` only one client may exist at a time.
+ */
+class Client {
+    public:
+        /** @brief Initialize a client, see `LDClientInit`. Ownership of
+         * `config` and `user` passes to the client. */
+        Client(struct LDConfig *const config, User &&user,
+            const unsigned int maxWaitMilliseconds) noexcept
+            : client(LDClientInit(config, user.release(), maxWaitMilliseconds)) {}
+
+        /** @brief Take ownership of a client created with the C API. */
+        explicit Client(struct LDClient *const client) noexcept : client(client) {}
+
+        ~Client() {
+            if (this->client) {
+                LDClientClose(this->client);
+            }
+        }
+
+        Client(Client &&other) noexcept : client(std::exchange(other.client, nullptr)) {}
+
+        Client &operator=(Client &&other) noexcept {
+            if (this != &other) {
+                if (this->client) {
+                    LDClientClose(this->client);
+                }
+                this->client = std::exchange(other.client, nullptr);
+            }
+            return *this;
+        }
+
+        Client(const Client &) = delete;
+        Client &operator=(const Client &) = delete;
+
+        struct LDClient *get() const noexcept { return this->client; }
+
+        explicit operator bool() const noexcept { return this->client != nullptr; }
+
+        /**
+         * @brief Evaluate a flag with a prepared key.
+         *
+         * `T` is one of `bool`, `int`, `double`, `std::string_view` or
+         * `const LDJSON *`. String and JSON results are borrowed, see
+         * `BorrowedString` and `BorrowedJSON`.
+         */
+        template <typename T>
+        VariationResult<T> variation(const FlagKey &key, const T &fallback) const
+            noexcept(noexcept(detail::Variation<T>::evaluate(nullptr, nullptr, fallback))) {
+            return detail::Variation<T>::evaluate(this->client, key.get(), fallback);
+        }
+
+        /**
+         * @brief Evaluate a flag named by a string literal or a character
+         * array.
+         *
+         * The key ends at the first terminator, so an array larger than the
+         * string it holds may be passed. The key is hashed on every call.
+         * Declare a `constexpr FlagKey` for keys evaluated often, so the hash
+         * is computed at compile time.
+         */
+        template <typename T, std::size_t N>
+        VariationResult<T> variation(const char (&key)[N], const T &fallback) const
+            noexcept(noexcept(detail::Variation<T>::evaluate(nullptr, nullptr, fallback))) {
+            return this->variation<T>(FlagKey(key), fallback);
+        }
+
+        /**
+         * @brief Evaluate a flag named by a view.
+         *
+         * The key is hashed on every call and copied to add a terminator,
+         * which only allocates for keys of 128 bytes or more.
+         */
+        template <typename T>
+        VariationResult<T> variation(const std::string_view key, const T &fallback) const {
+            if (key.size() < detail::inlineStringCapacity) {
+                char buffer[detail::inlineStringCapacity];
+
+                std::memcpy(buffer, key.data(), key.size());
+                buffer[key.size()] = '\0';
+
+                return this->variation<T>(FlagKey(buffer, key.size()), fallback);
+            }
+
+            const std::string terminated(key);
+
+            return this->variation<T>(
+                FlagKey(terminated.c_str(), terminated.size()), fallback);
+        }
+    private:
+        struct LDClient *client;
+};
+
+} // namespace launchdarkly
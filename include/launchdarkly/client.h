@@ -44,6 +44,69 @@ typedef struct
     struct LDJSON *reason;
 } LDVariationDetails;
 
+/** @brief The category of an evaluation reason. */
+typedef enum
+{
+    /** @brief The flag did not include a reason, see
+     * `LDConfigSetUseEvaluationReasons`. */
+    LDReasonKindNone = 0,
+    /** @brief The flag is off. */
+    LDReasonKindOff,
+    /** @brief No targets or rules matched. */
+    LDReasonKindFallthrough,
+    /** @brief The user was individually targeted. */
+    LDReasonKindTargetMatch,
+    /** @brief The user matched a rule, see `ruleIndex` and `ruleId`. */
+    LDReasonKindRuleMatch,
+    /** @brief A prerequisite failed, see `prerequisiteKey`. */
+    LDReasonKindPrerequisiteFailed,
+    /** @brief The evaluation failed, see `errorKind`. */
+    LDReasonKindError,
+    /** @brief A kind this version of the SDK does not recognize. */
+    LDReasonKindUnknown
+} LDReasonKind;
+
+/** @brief The cause of an `LDReasonKindError` reason. */
+typedef enum
+{
+    LDReasonErrorNone = 0,
+    LDReasonErrorClientNotReady,
+    LDReasonErrorClientNotSpecified,
+    LDReasonErrorFlagNotSpecified,
+    LDReasonErrorFlagNotFound,
+    LDReasonErrorWrongType,
+    LDReasonErrorMalformedFlag,
+    LDReasonErrorException,
+    /** @brief An error this version of the SDK does not recognize. */
+    LDReasonErrorUnknown
+} LDReasonErrorKind;
+
+/** @brief An evaluation reason, decoded when the flag is received. */
+typedef struct
+{
+    LDReasonKind      kind;
+    LDReasonErrorKind errorKind;
+    /** @brief Index of the matched rule, or -1. */
+    int               ruleIndex;
+    /** @brief Identifier of the matched rule, or `NULL`. */
+    const char *      ruleId;
+    /** @brief Key of the failed prerequisite, or `NULL`. */
+    const char *      prerequisiteKey;
+    LDBoolean         inExperiment;
+} LDEvaluationReason;
+
+/** @brief Filled by the `*VariationReason` functions without allocating.
+ *
+ * Strings in `reason` belong to the flag store, and remain valid until
+ * released with `LDEvaluationDetailRelease`. */
+typedef struct
+{
+    int                variationIndex;
+    LDEvaluationReason reason;
+    /** @brief Internal. Keeps the reason alive. */
+    void *             pin;
+} LDEvaluationDetail;
+
 /** @brief Get a reference to the (single, global) client. */
 LD_EXPORT(struct LDClient *) LDClientGet(void);
 
@@ -108,6 +171,14 @@ LDClientIdentify(struct LDClient *const client, struct LDUser *const user);
  * does not block. */
 LD_EXPORT(void) LDClientFlush(struct LDClient *const client);
 
+/** @brief Returns the number of analytics events discarded because the event
+ * buffer was full, over the life of the client.
+ *
+ * The number dropped since the previous payload is also logged as a warning
+ * when the payload is prepared. See `LDConfigSetEventsOverflowPolicy`. */
+LD_EXPORT(unsigned long)
+LDClientGetDroppedEventCount(struct LDClient *const client);
+
 /** @brief Returns true if the client has been initialized. */
 LD_EXPORT(LDBoolean) LDClientIsInitialized(struct LDClient *const client);
 
@@ -191,10 +262,51 @@ LDClientTrackMetric(
     struct LDJSON *const   data,
     const double           metric);
 
+/** @brief Record a custom event with data that is already serialized JSON.
+ *
+ * The `length` bytes of `json` must be a single JSON value. They are
+ * validated without being parsed, copied, and included in the event
+ * payload verbatim, so no LDJSON tree is built. Returns false, recording
+ * no event, if the data is not valid JSON. */
+LD_EXPORT(LDBoolean)
+LDClientTrackRawJSON(
+    struct LDClient *const client,
+    const char *const      name,
+    const char *const      json,
+    const size_t           length);
+
+/** @brief Record a custom event with a metric and data that is already
+ * serialized JSON. See LDClientTrackRawJSON. */
+LD_EXPORT(LDBoolean)
+LDClientTrackMetricRawJSON(
+    struct LDClient *const client,
+    const char *const      name,
+    const char *const      json,
+    const size_t           length,
+    const double           metric);
+
 /** @brief  Returns an object of all flags. This must be freed with
  * `LDJSONFree`. */
 LD_EXPORT(struct LDJSON *) LDAllFlags(struct LDClient *const client);
 
+/** @brief Callback type for `LDClientForEachFlag`.
+ *
+ * `key` and `value` are borrowed and only valid during the call. Return
+ * false to stop visiting. */
+typedef LDBoolean (*LDFlagVisitor)(
+    const char *const key, const struct LDJSON *const value, void *const context);
+
+/** @brief Visit the key and value of every flag without copying them.
+ *
+ * All flags come from the version of the flag store current at the call.
+ * The visitor may call other client functions, changes they make are not
+ * visited. Returns false if the client is not valid. */
+LD_EXPORT(LDBoolean)
+LDClientForEachFlag(
+    struct LDClient *const client,
+    LDFlagVisitor          visitor,
+    void *const            context);
+
 /** @brief Evaluate Bool flag */
 LD_EXPORT(LDBoolean)
 LDBoolVariation(
@@ -234,6 +346,35 @@ LDStringVariation(
     char *const            resultBuffer,
     const size_t           resultBufferSize);
 
+/** @brief A string flag value borrowed from the flag store.
+ *
+ * The value remains valid, even if the flag is updated, until released with
+ * `LDBorrowedStringRelease`. */
+typedef struct
+{
+    /** @brief NULL terminated value. */
+    const char *value;
+    /** @brief Length of `value` in bytes, excluding the terminator. */
+    size_t      length;
+    /** @brief Internal. Keeps the value alive. */
+    void *      pin;
+} LDBorrowedString;
+
+/** @brief Evaluate String flag without copying the value.
+ *
+ * Fills `result`, which must later be passed to `LDBorrowedStringRelease`,
+ * and returns `result->value`. When the fallback is selected the result
+ * refers to `fallback` itself, so `fallback` must outlive the result. */
+LD_EXPORT(const char *)
+LDStringVariationBorrow(
+    struct LDClient *const  client,
+    const char *const       featureKey,
+    const char *const       fallback,
+    LDBorrowedString *const result);
+
+/** @brief Release a value obtained with `LDStringVariationBorrow`. */
+LD_EXPORT(void) LDBorrowedStringRelease(LDBorrowedString *const borrowed);
+
 /** @brief Evaluate JSON flag */
 LD_EXPORT(struct LDJSON *)
 LDJSONVariation(
@@ -293,6 +434,207 @@ LDJSONVariationDetail(
     const struct LDJSON *const fallback,
     LDVariationDetails *const  details);
 
+/** @brief A JSON flag value shared with the flag store.
+ *
+ * The value is immutable and remains valid, even if the flag is updated,
+ * until released with `LDBorrowedJSONRelease`. */
+typedef struct
+{
+    /** @brief The value, which must not be modified or freed. */
+    const struct LDJSON *value;
+    /** @brief Internal. Keeps the value alive. */
+    void *               pin;
+} LDBorrowedJSON;
+
+/** @brief Evaluate JSON flag without copying the value.
+ *
+ * Fills `result`, which must later be passed to `LDBorrowedJSONRelease`,
+ * and returns `result->value`. When the fallback is selected the result
+ * refers to `fallback` itself, so `fallback` must outlive the result. */
+LD_EXPORT(const struct LDJSON *)
+LDJSONVariationBorrow(
+    struct LDClient *const     client,
+    const char *const          featureKey,
+    const struct LDJSON *const fallback,
+    LDBorrowedJSON *const      result);
+
+/** @brief Evaluate JSON flag without copying the value, with details. */
+LD_EXPORT(const struct LDJSON *)
+LDJSONVariationBorrowDetail(
+    struct LDClient *const     client,
+    const char *const          featureKey,
+    const struct LDJSON *const fallback,
+    LDBorrowedJSON *const      result,
+    LDVariationDetails *const  details);
+
+struct LDValue;
+
+/** @brief View a borrowed value through the experimental `LDValue` API.
+ *
+ * The view is valid until the borrow is released, and must not be passed
+ * to `LDValue_Free`. */
+LD_EXPORT(struct LDValue *)
+LDBorrowedJSONAsValue(const LDBorrowedJSON *const borrowed);
+
+/** @brief Release a value obtained with `LDJSONVariationBorrow`. */
+LD_EXPORT(void) LDBorrowedJSONRelease(LDBorrowedJSON *const borrowed);
+
+/** @brief Evaluate Bool flag and obtain a structured reason.
+ *
+ * `detail` must later be passed to `LDEvaluationDetailRelease`. */
+LD_EXPORT(LDBoolean)
+LDBoolVariationReason(
+    struct LDClient *const    client,
+    const char *const         featureKey,
+    const LDBoolean           fallback,
+    LDEvaluationDetail *const detail);
+
+/** @brief Evaluate Int flag and obtain a structured reason. */
+LD_EXPORT(int)
+LDIntVariationReason(
+    struct LDClient *const    client,
+    const char *const         featureKey,
+    const int                 fallback,
+    LDEvaluationDetail *const detail);
+
+/** @brief Evaluate Double flag and obtain a structured reason. */
+LD_EXPORT(double)
+LDDoubleVariationReason(
+    struct LDClient *const    client,
+    const char *const         featureKey,
+    const double              fallback,
+    LDEvaluationDetail *const detail);
+
+/** @brief Evaluate String flag without copying the value, and obtain a
+ * structured reason. Both `result` and `detail` must be released. */
+LD_EXPORT(const char *)
+LDStringVariationBorrowReason(
+    struct LDClient *const    client,
+    const char *const         featureKey,
+    const char *const         fallback,
+    LDBorrowedString *const   result,
+    LDEvaluationDetail *const detail);
+
+/** @brief Evaluate JSON flag without copying the value, and obtain a
+ * structured reason. Both `result` and `detail` must be released. */
+LD_EXPORT(const struct LDJSON *)
+LDJSONVariationBorrowReason(
+    struct LDClient *const     client,
+    const char *const          featureKey,
+    const struct LDJSON *const fallback,
+    LDBorrowedJSON *const      result,
+    LDEvaluationDetail *const  detail);
+
+/** @brief Release an `LDEvaluationDetail`. */
+LD_EXPORT(void) LDEvaluationDetailRelease(LDEvaluationDetail *const detail);
+
+/** @brief Convert a reason to its JSON form, as used by
+ * `LDVariationDetails`. The result must be freed with `LDJSONFree`. */
+LD_EXPORT(struct LDJSON *)
+LDEvaluationReasonToJSON(const LDEvaluationReason *const reason);
+
+/** @brief Prepare a flag key for the `*VariationKey` functions. */
+LD_EXPORT(void) LDFlagKeyInit(LDFlagKey *const prepared, const char *const key);
+
+/** @brief Evaluate Bool flag using a prepared key */
+LD_EXPORT(LDBoolean)
+LDBoolVariationKey(
+    struct LDClient *const client,
+    const LDFlagKey *const key,
+    const LDBoolean        fallback);
+
+/** @brief Evaluate Int flag using a prepared key */
+LD_EXPORT(int)
+LDIntVariationKey(
+    struct LDClient *const client,
+    const LDFlagKey *const key,
+    const int              fallback);
+
+/** @brief Evaluate Double flag using a prepared key */
+LD_EXPORT(double)
+LDDoubleVariationKey(
+    struct LDClient *const client,
+    const LDFlagKey *const key,
+    const double           fallback);
+
+/** @brief Evaluate String flag without copying the value, using a prepared
+ * key. See `LDStringVariationBorrow`. */
+LD_EXPORT(const char *)
+LDStringVariationBorrowKey(
+    struct LDClient *const  client,
+    const LDFlagKey *const  key,
+    const char *const       fallback,
+    LDBorrowedString *const result);
+
+/** @brief Evaluate JSON flag without copying the value, using a prepared
+ * key. See `LDJSONVariationBorrow`. */
+LD_EXPORT(const struct LDJSON *)
+LDJSONVariationBorrowKey(
+    struct LDClient *const     client,
+    const LDFlagKey *const     key,
+    const struct LDJSON *const fallback,
+    LDBorrowedJSON *const      result);
+
+/** @brief A consistent view of every flag, taken at one point in time. */
+struct LDClientSnapshot;
+
+/** @brief Pin the current version of the flag store.
+ *
+ * Evaluations through the snapshot all see the same flag values, even if
+ * updates arrive in the meantime, and do not take the store lock. The
+ * snapshot must be released with `LDClientSnapshotRelease` before the
+ * client is closed. Returns NULL on allocation failure. */
+LD_EXPORT(struct LDClientSnapshot *)
+LDClientSnapshotAcquire(struct LDClient *const client);
+
+/** @brief Release a snapshot.
+ *
+ * Evaluations of flags that do not generate full events are counted in the
+ * snapshot, and added to the event summary here. */
+LD_EXPORT(void)
+LDClientSnapshotRelease(struct LDClientSnapshot *const snapshot);
+
+/** @brief Evaluate Bool flag against a snapshot */
+LD_EXPORT(LDBoolean)
+LDSnapshotBoolVariation(
+    struct LDClientSnapshot *const snapshot,
+    const char *const              featureKey,
+    const LDBoolean                fallback);
+
+/** @brief Evaluate Int flag against a snapshot */
+LD_EXPORT(int)
+LDSnapshotIntVariation(
+    struct LDClientSnapshot *const snapshot,
+    const char *const              featureKey,
+    const int                      fallback);
+
+/** @brief Evaluate Double flag against a snapshot */
+LD_EXPORT(double)
+LDSnapshotDoubleVariation(
+    struct LDClientSnapshot *const snapshot,
+    const char *const              featureKey,
+    const double                   fallback);
+
+/** @brief Evaluate String flag against a snapshot without copying.
+ *
+ * The result is valid until the snapshot is released, or refers to
+ * `fallback`. */
+LD_EXPORT(const char *)
+LDSnapshotStringVariation(
+    struct LDClientSnapshot *const snapshot,
+    const char *const              featureKey,
+    const char *const              fallback);
+
+/** @brief Evaluate JSON flag against a snapshot without copying.
+ *
+ * The result is valid until the snapshot is released, or refers to
+ * `fallback`. */
+LD_EXPORT(const struct LDJSON *)
+LDSnapshotJSONVariation(
+    struct LDClientSnapshot *const snapshot,
+    const char *const              featureKey,
+    const struct LDJSON *const     fallback);
+
 /** @brief Clear any memory associated with `LDVariationDetails`  */
 LD_EXPORT(void) LDFreeDetailContents(LDVariationDetails details);
 
@@ -316,3 +658,81 @@ LDClientUnregisterFeatureFlagListener(
     struct LDClient *const client,
     const char *const      flagKey,
     LDlistenerfn           listener);
+
+/** @brief Describes a flag update delivered to an `LDFlagChangeListener`.
+ *
+ * Values are borrowed from the flag store and only valid during the
+ * call. */
+typedef struct
+{
+    /** @brief Key of the flag that changed. */
+    const char *         key;
+    /** @brief True if the flag was deleted. */
+    LDBoolean            deleted;
+    /** @brief Previous value, NULL if the flag did not exist or was
+     * deleted. */
+    const struct LDJSON *oldValue;
+    /** @brief New value, NULL if the flag was deleted. */
+    const struct LDJSON *newValue;
+    /** @brief Previous version, -1 if the flag did not exist. */
+    int                  oldVersion;
+    /** @brief New version. */
+    int                  newVersion;
+    /** @brief Previous variation, -1 if there was no value. */
+    int                  oldVariation;
+    /** @brief New variation, -1 if the flag was deleted. */
+    int                  newVariation;
+} LDFlagChange;
+
+/** @brief Flag change listener callback type. Callbacks are not reentrant
+ * safe. */
+typedef void (*LDFlagChangeListener)(
+    const LDFlagChange *const change, void *const context);
+
+/** @brief Register a callback receiving the old and new value when a flag
+ * is updated.
+ *
+ * Unlike `LDClientRegisterFeatureFlagListener` the callback does not need
+ * to evaluate the flag again, so no evaluation events are generated. The
+ * combination of flag, listener and context is registered at most once. */
+LD_EXPORT(LDBoolean)
+LDClientRegisterFlagChangeListener(
+    struct LDClient *const client,
+    const char *const      flagKey,
+    LDFlagChangeListener   listener,
+    void *const            context);
+
+/** @brief Unregister a callback registered with
+ * `LDClientRegisterFlagChangeListener` */
+LD_EXPORT(void)
+LDClientUnregisterFlagChangeListener(
+    struct LDClient *const client,
+    const char *const      flagKey,
+    LDFlagChangeListener   listener,
+    void *const            context);
+
+/** @brief Counters describing delivery of flag change notifications.
+ *
+ * Listeners run after the flag store is unlocked, so they may evaluate
+ * flags. Changes to a flag made while an earlier change is waiting for
+ * delivery are combined into one notification. */
+typedef struct
+{
+    /** @brief Notifications delivered to listeners. */
+    unsigned long delivered;
+    /** @brief Changes combined with a notification that was pending. */
+    unsigned long coalesced;
+    /** @brief Notifications skipped because the value was unchanged, see
+     * `LDConfigSetSuppressUnchangedNotifications`. */
+    unsigned long suppressed;
+    /** @brief Milliseconds from the change to delivery, for the most recent
+     * notification. */
+    double        lastLatencyMilliseconds;
+    /** @brief Largest delivery latency observed. */
+    double        maxLatencyMilliseconds;
+} LDListenerStatistics;
+
+/** @brief Obtain flag change notification counters. */
+LD_EXPORT(LDBoolean)
+LDClientGetListenerStatistics(
+    struct LDClient *const client, LDListenerStatistics *const statistics);
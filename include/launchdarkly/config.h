@@ -5,6 +5,8 @@
 
 #pragma once
 
+#include <stddef.h>
+
 #include <launchdarkly/boolean.h>
 #include <launchdarkly/export.h>
 #include <launchdarkly/json.h>
@@ -56,12 +58,109 @@ LDConfigSetDisableBackgroundUpdating(
 LD_EXPORT(void)
 LDConfigSetEventsCapacity(struct LDConfig *const config, const int capacity);
 
+/** @brief What to do with an event when the event buffer is full. */
+typedef enum
+{
+    /** @brief Discard the new event. This is the default. */
+    LDEventsOverflowDropNewest = 0,
+    /** @brief Discard the oldest buffered event to make room. Recording an
+     * event never waits for a flush, so while the buffer is being flushed
+     * the new event is discarded instead. */
+    LDEventsOverflowDropOldest,
+    /** @brief Discard the oldest buffered event to make room with
+     * probability capacity / events seen since the last flush, otherwise
+     * discard the new event. Later events are admitted less often, so a
+     * burst does not entirely replace the events before it. This is not a
+     * uniform sample, the buffer always holds the most recently admitted
+     * events. */
+    LDEventsOverflowProbabilisticDropOldest
+} LDEventsOverflowPolicy;
+
+/** @brief Sets how events are handled once `LDConfigSetEventsCapacity` is
+ * reached. Every discarded event is counted, see
+ * `LDClientGetDroppedEventCount`. Defaults to
+ * `LDEventsOverflowDropNewest`. */
+LD_EXPORT(void)
+LDConfigSetEventsOverflowPolicy(
+    struct LDConfig *const config, const LDEventsOverflowPolicy policy);
+
+/** @brief Sets the number of buffered events that triggers a flush before
+ * the flush interval has elapsed.
+ *
+ * A value of 0 uses three quarters of the events capacity. A value above
+ * the capacity disables early flushes. */
+LD_EXPORT(void)
+LDConfigSetEventsHighWatermark(
+    struct LDConfig *const config, const unsigned int watermark);
+
 /** @brief Sets the maximum amount of time in milliseconds to wait in between
  * sending analytics events to LaunchDarkly. */
 LD_EXPORT(void)
 LDConfigSetEventsFlushIntervalMillis(
     struct LDConfig *const config, const int millis);
 
+/** @brief Sets the maximum size in bytes of each request sending analytics
+ * events.
+ *
+ * A flush larger than this is split into several requests, each with its
+ * own payload ID. A single event larger than the limit is sent on its own.
+ * A value of 0 sends each flush as one request. Defaults to 512 KiB. */
+LD_EXPORT(void)
+LDConfigSetEventsMaxPayloadBytes(
+    struct LDConfig *const config, const size_t bytes);
+
+/** @brief Sets the number of event payloads that may be in flight at once.
+ *
+ * Each payload is sent by its own delivery thread, so the events thread
+ * keeps bundling while earlier payloads are sent or retried. A payload is
+ * retried with jittered exponential backoff. If every attempt fails it is
+ * spooled, see `LDConfigSetEventsSpoolPath`, or discarded when there is no
+ * spool. A payload bundled while every delivery thread is busy is sent
+ * once one is free, except during the final flush on close, when it is
+ * spooled or discarded instead. Defaults to 2. */
+LD_EXPORT(void)
+LDConfigSetEventsMaxInFlightPayloads(
+    struct LDConfig *const config, const unsigned int payloads);
+
+/** @brief Sets the total size in bytes of the event payloads that may be in
+ * flight at once. A single larger payload is still sent on its own.
+ * Defaults to 1 MiB. */
+LD_EXPORT(void)
+LDConfigSetEventsMaxInFlightBytes(
+    struct LDConfig *const config, const size_t bytes);
+
+/** @brief Aggregates the metric values tracked for a custom event key.
+ *
+ * Instead of one event per LDClientTrackMetric call, the values tracked for
+ * `key` in each flush interval are combined into a single custom event for
+ * the user of the first call. Its `metricValue` is the mean, and its `data`
+ * is an object with the `count`, `sum`, `min`, and `max` of the values; the
+ * `data` passed to each call is discarded. Calls without a metric value are
+ * not aggregated. This function returns false on failure. */
+LD_EXPORT(LDBoolean)
+LDConfigAddAggregatedMetric(struct LDConfig *const config, const char *const key);
+
+/** @brief Enables spooling analytics events to disk while they cannot be
+ * delivered.
+ *
+ * Payloads that fail to send, or that are bundled while the client is
+ * offline, are appended to a file and replayed in order once delivery
+ * succeeds again, including after a restart. While the file holds
+ * undelivered payloads, new payloads are appended behind them. While
+ * delivery is healthy payloads are sent from memory and nothing is written,
+ * so a payload being sent when the process exits is lost. A replayed
+ * payload stays in the file until it is delivered. Each environment spools
+ * to its own file, named `path` followed by a dash and eight hex digits
+ * derived from its mobile key. Spooling is disabled by default. */
+LD_EXPORT(LDBoolean)
+LDConfigSetEventsSpoolPath(struct LDConfig *const config, const char *const path);
+
+/** @brief Sets the maximum size in bytes of each events spool file. When
+ * the spool is full the oldest payloads are discarded. Defaults to 1 MiB. */
+LD_EXPORT(void)
+LDConfigSetEventsSpoolMaxBytes(
+    struct LDConfig *const config, const size_t maxBytes);
+
 /** @brief Set the events uri for sending analytics to LaunchDarkly. You
  * probably don't need to set this unless instructed by LaunchDarkly. */
 LD_EXPORT(LDBoolean)
@@ -159,12 +258,80 @@ LD_EXPORT(void)
 LDConfigSetInlineUsersInEvents(
     struct LDConfig *const config, const LDBoolean inlineUsers);
 
+/** @brief Includes each inlined user once per request rather than in every
+ * event.
+ *
+ * When users are inlined, each request sending events carries one `index`
+ * event holding the user, unless an `identify` event already does, and the
+ * other events refer to the user by key. Every request carries the users
+ * it refers to, including when a flush is split by
+ * LDConfigSetEventsMaxPayloadBytes. Has no effect unless
+ * LDConfigSetInlineUsersInEvents is enabled. Defaults to false. */
+LD_EXPORT(void)
+LDConfigSetDeduplicateInlineUsers(
+    struct LDConfig *const config, const LDBoolean deduplicate);
+
 /** @brief Determines if Identify should automatically generate alias events.
  * When true LDClientIdentify will not generate alias events.
  * Defaults to false. */
 LD_EXPORT(void)
 LDConfigAutoAliasOptOut(struct LDConfig *const config, const LDBoolean optOut);
 
+/** @brief Determines if boolean and number evaluations are cached per thread
+ * until flags change.
+ *
+ * Repeated evaluations of a flag then skip the flag store, and are only
+ * counted towards the summary event. Flags that generate full feature
+ * events, and evaluations requesting details, are never cached.
+ * Defaults to false. */
+LD_EXPORT(void)
+LDConfigSetEvaluationCache(
+    struct LDConfig *const config, const LDBoolean enabled);
+
+/** @brief Determines if flag listeners are skipped when an update does not
+ * change the value of a flag.
+ *
+ * Applies to all listeners. A full refresh of flags from LaunchDarkly then
+ * only notifies listeners of flags whose value differs. Defaults to
+ * false. */
+LD_EXPORT(void)
+LDConfigSetSuppressUnchangedNotifications(
+    struct LDConfig *const config, const LDBoolean suppress);
+
+/** @brief A flag key with its length and hash computed ahead of time.
+ *
+ * Evaluating through a prepared key skips measuring and hashing the key on
+ * every call. The hash is 32-bit MurmurHash3 of the key bytes with a seed of
+ * zero, so it may also be computed at compile time, as the C++ wrapper in
+ * `launchdarkly/sdk.hpp` does. The key string must outlive the structure. */
+typedef struct
+{
+    /** @brief NULL terminated flag key. */
+    const char * key;
+    /** @brief Length of `key` in bytes, excluding the terminator. */
+    size_t       length;
+    /** @brief MurmurHash3 (x86, 32-bit, seed 0) of `key`. */
+    unsigned int hash;
+    /** @brief One more than the position of the key in the manifest given
+     * to `LDConfigSetFlagManifest`, or zero if it is not in a manifest.
+     * The slot is only used when evaluating through the manifest element
+     * itself, copies are looked up by hash. */
+    unsigned int slot;
+} LDFlagKey;
+
+/** @brief Declares the flags the application evaluates.
+ *
+ * The store resolves each key in the manifest whenever flags are received,
+ * so that evaluating through a key whose `slot` is set is a single array
+ * read. `ld-flag-codegen` generates a manifest and typed accessors from a
+ * JSON file of flags. The array is not copied and must outlive the client.
+ */
+LD_EXPORT(void)
+LDConfigSetFlagManifest(
+    struct LDConfig *const  config,
+    const LDFlagKey *const  keys,
+    const unsigned int      keyCount);
+
 /** @brief Sets the timeout, in milliseconds, for requests to LaunchDarkly.
  *  Applies to polling requests and sending events. A value of 0 specifies
  *  that the request will never timeout. Defaults to 30000. */
@@ -11,6 +11,9 @@
 
 #include <launchdarkly/api.h>
 
+#include "eval_cache.h"
+#include "event_processor_internal.h"
+#include "json_raw.h"
 #include "ldinternal.h"
 #include "uthash.h"
 
@@ -53,6 +56,10 @@ LDi_earlyinit(void)
     curl_global_init(CURL_GLOBAL_DEFAULT);
 
     LDi_initializerng();
+
+    LDi_evalCacheInitialize();
+
+    LDi_metricStripesInitialize();
 }
 
 struct LDClient *
@@ -81,6 +88,97 @@ LDClientGetForMobileKey(const char *const keyName)
     return lookup;
 }
 
+/* Closes delivery once queued payloads are sent, and joins its threads. */
+static void
+LDi_stopEventDelivery(struct LDClient *const client)
+{
+    unsigned int i;
+
+    LDi_deliveryClose(&client->delivery);
+
+    for (i = 0; i < client->deliveryThreadCount; i++) {
+        LDi_thread_join(&client->deliveryThreads[i]);
+    }
+
+    LDFree(client->deliveryThreads);
+
+    client->deliveryThreads     = NULL;
+    client->deliveryThreadCount = 0;
+
+    LDi_deliveryDestroy(&client->delivery);
+}
+
+/* Starts a delivery thread for each payload that may be in flight. */
+static LDBoolean
+LDi_startEventDelivery(
+    struct LDClient *const client, const struct LDConfig *const config)
+{
+    if (!LDi_deliveryInitialize(
+            &client->delivery,
+            config->eventsMaxInFlightPayloads,
+            config->eventsMaxInFlightBytes))
+    {
+        return LDBooleanFalse;
+    }
+
+    if (!(client->deliveryThreads =
+              LDAlloc(sizeof(ld_thread_t) * client->delivery.maxBatches)))
+    {
+        LDi_deliveryDestroy(&client->delivery);
+
+        return LDBooleanFalse;
+    }
+
+    while (client->deliveryThreadCount < client->delivery.maxBatches) {
+        if (!LDi_thread_create(
+                &client->deliveryThreads[client->deliveryThreadCount],
+                LDi_bgeventdelivery,
+                client))
+        {
+            LDi_stopEventDelivery(client);
+
+            return LDBooleanFalse;
+        }
+
+        client->deliveryThreadCount++;
+    }
+
+    return LDBooleanTrue;
+}
+
+/* Failing to open the spool is logged and leaves spooling disabled. */
+static void
+LDi_openEventSpool(
+    struct LDClient *const client, const struct LDConfig *const config)
+{
+    char *path;
+    size_t pathSize;
+
+    /* a dash, eight hex digits, and the terminator */
+    pathSize = strlen(config->eventsSpoolPath) + 10;
+
+    if (!(path = LDAlloc(pathSize))) {
+        LD_LOG(LD_LOG_ERROR, "alloc error");
+
+        return;
+    }
+
+    if (snprintf(path, pathSize, "%s-%08x", config->eventsSpoolPath,
+            LDi_hash32(client->mobileKey, strlen(client->mobileKey))) < 0)
+    {
+        LD_LOG(LD_LOG_ERROR, "snprintf event spool path failed");
+
+        LDFree(path);
+
+        return;
+    }
+
+    client->eventSpool =
+        LDi_eventSpoolOpen(path, config->eventsSpoolMaxBytes);
+
+    LDFree(path);
+}
+
 struct LDClient *
 LDi_clientInitIsolated(
     struct LDGlobal_i *const shared, const char *const mobileKey)
@@ -120,10 +218,20 @@ LDi_clientInitIsolated(
         goto err2;
     }
 
+    if (shared->sharedConfig->eventsSpoolPath) {
+        LDi_openEventSpool(client, shared->sharedConfig);
+    }
+
     if (!LDi_storeInitialize(&client->store)) {
         goto err3;
     }
 
+    client->store.suppressUnchanged =
+        shared->sharedConfig->suppressUnchangedNotifications;
+
+    LDi_storeSetManifest(&client->store, shared->sharedConfig->flagManifest,
+        shared->sharedConfig->flagManifestCount);
+
     if (!LDi_rwlock_init(&client->clientLock)) {
         goto err4;
     }
@@ -144,6 +252,8 @@ LDi_clientInitIsolated(
         goto err8;
     }
 
+    LDi_eventProcessorSetFlushSignal(client->eventProcessor, &client->eventCond);
+
     if (!LDi_cond_init(&client->pollCond)) {
         goto err9;
     }
@@ -152,20 +262,24 @@ LDi_clientInitIsolated(
         goto err10;
     }
 
-    if (!LDi_thread_create(&client->eventThread, LDi_bgeventsender, client)) {
+    if (!LDi_startEventDelivery(client, shared->sharedConfig)) {
         goto err11;
     }
+
+    if (!LDi_thread_create(&client->eventThread, LDi_bgeventsender, client)) {
+        goto err12;
+    }
     threadCount++;
 
     if (!LDi_thread_create(&client->pollingThread, LDi_bgfeaturepoller, client))
     {
-        goto err12;
+        goto err13;
     }
     threadCount++;
 
     if (!LDi_thread_create(
             &client->streamingThread, LDi_bgfeaturestreamer, client)) {
-        goto err12;
+        goto err13;
     }
     threadCount++;
 
@@ -174,14 +288,14 @@ LDi_clientInitIsolated(
     if (!LDi_identify(client->eventProcessor, shared->sharedUser)) {
         LDi_rwlock_rdunlock(&shared->sharedUserLock);
 
-        goto err12;
+        goto err13;
     }
 
     LDi_rwlock_rdunlock(&shared->sharedUserLock);
 
     return client;
 
-err12:
+err13:
     LDi_rwlock_wrlock(&client->clientLock);
     LDi_updatestatus(client, LDStatusShuttingdown);
     LDi_reinitializeconnection(client);
@@ -198,6 +312,8 @@ err12:
     if (threadCount > 2) {
         LDi_thread_join(&client->streamingThread);
     }
+err12:
+    LDi_stopEventDelivery(client);
 err11:
     LDi_cond_destroy(&client->streamCond);
 err10:
@@ -215,6 +331,7 @@ err5:
 err4:
     LDi_storeDestroy(&client->store);
 err3:
+    LDi_eventSpoolClose(client->eventSpool);
     LDi_freeEventProcessor(client->eventProcessor);
 err2:
     LDFree(client->mobileKey);
@@ -463,17 +580,22 @@ clientCloseIsolated(struct LDClient *const client)
     LDi_rwlock_wrunlock(&client->clientLock);
 
     LDi_mutex_lock(&client->condMtx);
-    LDi_cond_signal(&client->initCond);
-    LDi_cond_signal(&client->eventCond);
-    LDi_cond_signal(&client->pollCond);
-    LDi_cond_signal(&client->streamCond);
+    LDi_cond_broadcast(&client->initCond);
+    LDi_cond_broadcast(&client->eventCond);
+    LDi_cond_broadcast(&client->pollCond);
+    LDi_cond_broadcast(&client->streamCond);
     LDi_mutex_unlock(&client->condMtx);
 
     LDi_thread_join(&client->eventThread);
     LDi_thread_join(&client->pollingThread);
     LDi_thread_join(&client->streamingThread);
 
+    /* after the final flush has been handed to delivery */
+    LDi_stopEventDelivery(client);
+
+    LDi_evalCachePurge(client->eventProcessor);
     LDi_freeEventProcessor(client->eventProcessor);
+    LDi_eventSpoolClose(client->eventSpool);
     LDi_storeDestroy(&client->store);
 
     LDi_rwlock_destroy(&client->clientLock);
@@ -684,6 +806,34 @@ error:
     return NULL;
 }
 
+LDBoolean
+LDClientForEachFlag(
+    struct LDClient *const client,
+    LDFlagVisitor          visitor,
+    void *const            context)
+{
+    LD_ASSERT_API(client);
+    LD_ASSERT_API(visitor);
+
+#ifdef LAUNCHDARKLY_DEFENSIVE
+    if (client == NULL) {
+        LD_LOG(LD_LOG_WARNING, "LDClientForEachFlag NULL client");
+
+        return LDBooleanFalse;
+    }
+
+    if (visitor == NULL) {
+        LD_LOG(LD_LOG_WARNING, "LDClientForEachFlag NULL visitor");
+
+        return LDBooleanFalse;
+    }
+#endif
+
+    LDi_storeForEach(&client->store, visitor, context);
+
+    return LDBooleanTrue;
+}
+
 static void
 fillDetails(
     const struct LDClient *const    client,
@@ -737,6 +887,44 @@ fillDetails(
     }
 }
 
+/* Structured counterpart of fillDetails. Takes ownership of the reference
+ * to node, if any. */
+static void
+LDi_fillEvaluationDetail(
+    const struct LDClient *const client,
+    const char *const            flagKey,
+    struct LDStoreNode *const    node,
+    LDEvaluationDetail *const    detail,
+    const LDJSONType             type)
+{
+    LD_ASSERT(detail);
+
+    detail->variationIndex = -1;
+    detail->pin            = NULL;
+
+    if (!client) {
+        LDi_reasonError(&detail->reason, LDReasonErrorClientNotSpecified);
+    } else if (!flagKey) {
+        LDi_reasonError(&detail->reason, LDReasonErrorFlagNotSpecified);
+    } else if (!node) {
+        LDi_reasonError(&detail->reason, LDReasonErrorFlagNotFound);
+    } else if (type == LDNull || LDJSONGetType(node->flag.value) == type ||
+               LDJSONGetType(node->flag.value) == LDNull)
+    {
+        detail->variationIndex = node->flag.variation;
+        detail->reason         = node->reason;
+        detail->pin            = node;
+
+        return;
+    } else {
+        LDi_reasonError(&detail->reason, LDReasonErrorWrongType);
+    }
+
+    if (node) {
+        LDi_rc_decrement(&node->rc);
+    }
+}
+
 /**
  * Invokes the appropriate JSON getter function on source, depending on the 'type' parameter.
  *
@@ -779,16 +967,22 @@ LDi_castJSONToValue(void **const destination, struct LDJSON *const source, LDJSO
     }
 }
 
+/* Evaluates a flag. When selected is provided the node is returned with a
+ * reference the caller must release. Detailed controls whether a feature
+ * event includes the evaluation reason. */
 static LDBoolean
-LDi_evalInternal(
+LDi_evaluate(
     struct LDClient *const     client,
-    const char *const          flagKey,
+    const LDFlagKey *const     flagKey,
     const LDJSONType           variationKind,
     void *const                fallbackValue,
     void **const               resultValue,
-    struct LDStoreNode **const selected)
+    struct LDStoreNode **const selected,
+    const LDBoolean            detailed)
 {
     struct LDStoreNode *node;
+    LDBoolean           cacheable;
+    unsigned long       generation;
 
     LD_ASSERT_API(client);
     LD_ASSERT_API(flagKey);
@@ -799,6 +993,8 @@ LDi_evalInternal(
         *selected = NULL;
     }
 
+    generation = 0;
+
 #ifdef LAUNCHDARKLY_DEFENSIVE
     if (client == NULL) {
         LD_LOG(LD_LOG_WARNING, "LDi_evalInternal NULL client");
@@ -808,7 +1004,7 @@ LDi_evalInternal(
         return LDBooleanFalse;
     }
 
-    if (flagKey == NULL) {
+    if (flagKey == NULL || flagKey->key == NULL) {
         LD_LOG(LD_LOG_WARNING, "LDi_evalInternal NULL flagKey");
 
         *resultValue = fallbackValue;
@@ -817,7 +1013,21 @@ LDi_evalInternal(
     }
 #endif
 
-    node = LDi_storeGet(&client->store, flagKey);
+    cacheable = selected == NULL &&
+        client->shared->sharedConfig->evaluationCache &&
+        (variationKind == LDBool || variationKind == LDNumber);
+
+    if (cacheable) {
+        if (LDi_evalCacheGet(&client->store, client->eventProcessor, flagKey,
+                variationKind, *resultValue))
+        {
+            return LDBooleanTrue;
+        }
+
+        generation = LDi_storeGeneration(&client->store);
+    }
+
+    node = LDi_storeGetKey(&client->store, flagKey);
 
     if (node && (variationKind == LDNull ||
                  LDJSONGetType(node->flag.value) == variationKind))
@@ -836,15 +1046,20 @@ LDi_evalInternal(
     LDi_processEvalEvent(
         client->eventProcessor,
         client->shared->sharedUser,
-        flagKey,
+        flagKey->key,
         variationKind,
         node,
         *(const void **)resultValue,
         fallbackValue,
-        selected != NULL);
+        detailed);
 
     LDi_rwlock_rdunlock(&client->shared->sharedUserLock);
 
+    if (cacheable && node && *resultValue != fallbackValue) {
+        LDi_evalCachePut(&client->store, client->eventProcessor, flagKey,
+            variationKind, generation, node, *resultValue, fallbackValue);
+    }
+
     if (selected) {
         *selected = node;
     } else if (node) {
@@ -854,6 +1069,120 @@ LDi_evalInternal(
     return LDBooleanTrue;
 }
 
+/* Fills prepared from key, or returns NULL if there is no key so that
+ * LDi_evaluate reports it. */
+static const LDFlagKey *
+LDi_prepareKey(LDFlagKey *const prepared, const char *const key)
+{
+    if (key == NULL) {
+        return NULL;
+    }
+
+    prepared->key    = key;
+    prepared->length = strlen(key);
+    prepared->hash   = LDi_flagIndexHash(key, prepared->length);
+    prepared->slot   = 0;
+
+    return prepared;
+}
+
+static LDBoolean
+LDi_evalInternal(
+    struct LDClient *const     client,
+    const char *const          flagKey,
+    const LDJSONType           variationKind,
+    void *const                fallbackValue,
+    void **const               resultValue,
+    struct LDStoreNode **const selected)
+{
+    LDFlagKey prepared;
+
+    return LDi_evaluate(client, LDi_prepareKey(&prepared, flagKey),
+        variationKind, fallbackValue, resultValue, selected, selected != NULL);
+}
+
+void
+LDFlagKeyInit(LDFlagKey *const prepared, const char *const key)
+{
+    LD_ASSERT_API(prepared);
+    LD_ASSERT_API(key);
+
+#ifdef LAUNCHDARKLY_DEFENSIVE
+    if (prepared == NULL) {
+        LD_LOG(LD_LOG_WARNING, "LDFlagKeyInit NULL prepared");
+
+        return;
+    }
+#endif
+
+    if (LDi_prepareKey(prepared, key) == NULL) {
+        prepared->key    = NULL;
+        prepared->length = 0;
+        prepared->hash   = 0;
+        prepared->slot   = 0;
+    }
+}
+
+LDBoolean
+LDBoolVariationKey(
+    struct LDClient *const client,
+    const LDFlagKey *const key,
+    const LDBoolean        fallback)
+{
+    LDBoolean value, *valueRef, fallbackCast;
+
+    LD_ASSERT_API(client);
+    LD_ASSERT_API(key);
+
+    fallbackCast = fallback;
+    valueRef     = &value;
+
+    LDi_evaluate(client, key, LDBool, &fallbackCast, (void **)&valueRef, NULL,
+        LDBooleanFalse);
+
+    return *valueRef;
+}
+
+int
+LDIntVariationKey(
+    struct LDClient *const client,
+    const LDFlagKey *const key,
+    const int              fallback)
+{
+    double value, *valueRef, fallbackCast;
+
+    LD_ASSERT_API(client);
+    LD_ASSERT_API(key);
+
+    valueRef     = &value;
+    fallbackCast = fallback;
+
+    LDi_evaluate(client, key, LDNumber, &fallbackCast, (void **)&valueRef,
+        NULL, LDBooleanFalse);
+
+    return *valueRef;
+}
+
+double
+LDDoubleVariationKey(
+    struct LDClient *const client,
+    const LDFlagKey *const key,
+    const double           fallback)
+{
+    double value, *valueRef, fallbackCast;
+
+    LD_ASSERT_API(client);
+    LD_ASSERT_API(key);
+
+    valueRef     = &value;
+    fallbackCast = fallback;
+
+    LDi_evaluate(client, key, LDNumber, &fallbackCast, (void **)&valueRef,
+        NULL, LDBooleanFalse);
+
+    return *valueRef;
+}
+
 LDBoolean
 LDBoolVariationDetail(
     struct LDClient *const    client,
@@ -1090,6 +1419,102 @@ LDStringVariationAlloc(
     return LDStrDup(value);
 }
 
+static const char *
+LDi_borrowString(
+    struct LDClient *const  client,
+    const LDFlagKey *const  key,
+    const char *const       fallback,
+    LDBorrowedString *const result)
+{
+    char *              value;
+    struct LDStoreNode *selected;
+
+    value    = NULL;
+    selected = NULL;
+
+    LDi_evaluate(client, key, LDText, (void *)fallback, (void **)&value,
+        &selected, LDBooleanFalse);
+
+    if (selected && value != fallback) {
+        result->value  = value;
+        result->length = selected->valueLength;
+        result->pin    = selected;
+    } else {
+        if (selected) {
+            LDi_rc_decrement(&selected->rc);
+        }
+
+        result->value  = value;
+        result->length = strlen(value);
+        result->pin    = NULL;
+    }
+
+    return result->value;
+}
+
+const char *
+LDStringVariationBorrow(
+    struct LDClient *const  client,
+    const char *const       key,
+    const char *const       fallback,
+    LDBorrowedString *const result)
+{
+    LDFlagKey prepared;
+
+    LD_ASSERT_API(client);
+    LD_ASSERT_API(key);
+    LD_ASSERT_API(fallback);
+    LD_ASSERT_API(result);
+
+#ifdef LAUNCHDARKLY_DEFENSIVE
+    if (result == NULL) {
+        LD_LOG(LD_LOG_WARNING, "LDStringVariationBorrow NULL result");
+
+        return fallback;
+    }
+#endif
+
+    return LDi_borrowString(
+        client, LDi_prepareKey(&prepared, key), fallback, result);
+}
+
+const char *
+LDStringVariationBorrowKey(
+    struct LDClient *const  client,
+    const LDFlagKey *const  key,
+    const char *const       fallback,
+    LDBorrowedString *const result)
+{
+    LD_ASSERT_API(client);
+    LD_ASSERT_API(key);
+    LD_ASSERT_API(fallback);
+    LD_ASSERT_API(result);
+
+#ifdef LAUNCHDARKLY_DEFENSIVE
+    if (result == NULL) {
+        LD_LOG(LD_LOG_WARNING, "LDStringVariationBorrowKey NULL result");
+
+        return fallback;
+    }
+#endif
+
+    return LDi_borrowString(client, key, fallback, result);
+}
+
+void
+LDBorrowedStringRelease(LDBorrowedString *const borrowed)
+{
+    if (borrowed) {
+        if (borrowed->pin) {
+            LDi_rc_decrement(&((struct LDStoreNode *)borrowed->pin)->rc);
+        }
+
+        borrowed->value  = NULL;
+        borrowed->length = 0;
+        borrowed->pin    = NULL;
+    }
+}
+
 struct LDJSON *
 LDJSONVariationDetail(
     struct LDClient *const     client,
@@ -1146,25 +1571,693 @@ LDJSONVariation(
     return LDJSONDuplicate(value);
 }
 
-void
-LDClientAlias(
+static const struct LDJSON *
+LDi_borrowJSON(
     struct LDClient *const     client,
-    const struct LDUser *const currentUser,
-    const struct LDUser *const previousUser)
+    const LDFlagKey *const     key,
+    const struct LDJSON *const fallback,
+    LDBorrowedJSON *const      result,
+    LDVariationDetails *const  details)
 {
-    LD_ASSERT_API(client);
-    LD_ASSERT_API(currentUser);
-    LD_ASSERT_API(previousUser);
+    const struct LDJSON *value;
+    struct LDStoreNode * selected;
 
-#ifdef LAUNCHDARKLY_DEFENSIVE
-    if (client == NULL) {
-        LD_LOG(LD_LOG_WARNING, "LDClientAlias NULL client");
+    value    = NULL;
+    selected = NULL;
 
-        return;
+    LDi_evaluate(client, key, LDNull, (void *)fallback, (void **)&value,
+        &selected, details != NULL);
+
+    if (details) {
+        fillDetails(client, key->key, selected, details, LDNull);
     }
 
-    if (currentUser == NULL) {
-        LD_LOG(LD_LOG_WARNING, "LDClientAlias NULL currentUser");
+    result->value = value;
+    result->pin   = NULL;
+
+    if (selected) {
+        if (value != fallback) {
+            result->pin = selected;
+        } else {
+            LDi_rc_decrement(&selected->rc);
+        }
+    }
+
+    return result->value;
+}
+
+const struct LDJSON *
+LDJSONVariationBorrow(
+    struct LDClient *const     client,
+    const char *const          key,
+    const struct LDJSON *const fallback,
+    LDBorrowedJSON *const      result)
+{
+    LDFlagKey prepared;
+
+    LD_ASSERT_API(client);
+    LD_ASSERT_API(key);
+    LD_ASSERT_API(fallback);
+    LD_ASSERT_API(result);
+
+#ifdef LAUNCHDARKLY_DEFENSIVE
+    if (result == NULL) {
+        LD_LOG(LD_LOG_WARNING, "LDJSONVariationBorrow NULL result");
+
+        return fallback;
+    }
+#endif
+
+    return LDi_borrowJSON(
+        client, LDi_prepareKey(&prepared, key), fallback, result, NULL);
+}
+
+const struct LDJSON *
+LDJSONVariationBorrowKey(
+    struct LDClient *const     client,
+    const LDFlagKey *const     key,
+    const struct LDJSON *const fallback,
+    LDBorrowedJSON *const      result)
+{
+    LD_ASSERT_API(client);
+    LD_ASSERT_API(key);
+    LD_ASSERT_API(fallback);
+    LD_ASSERT_API(result);
+
+#ifdef LAUNCHDARKLY_DEFENSIVE
+    if (result == NULL) {
+        LD_LOG(LD_LOG_WARNING, "LDJSONVariationBorrowKey NULL result");
+
+        return fallback;
+    }
+#endif
+
+    return LDi_borrowJSON(client, key, fallback, result, NULL);
+}
+
+const struct LDJSON *
+LDJSONVariationBorrowDetail(
+    struct LDClient *const     client,
+    const char *const          key,
+    const struct LDJSON *const fallback,
+    LDBorrowedJSON *const      result,
+    LDVariationDetails *const  details)
+{
+    LDFlagKey prepared;
+
+    LD_ASSERT_API(client);
+    LD_ASSERT_API(key);
+    LD_ASSERT_API(fallback);
+    LD_ASSERT_API(result);
+    LD_ASSERT_API(details);
+
+#ifdef LAUNCHDARKLY_DEFENSIVE
+    if (result == NULL) {
+        LD_LOG(LD_LOG_WARNING, "LDJSONVariationBorrowDetail NULL result");
+
+        return fallback;
+    }
+
+    if (details == NULL) {
+        LD_LOG(LD_LOG_WARNING, "LDJSONVariationBorrowDetail NULL details");
+
+        return LDi_borrowJSON(
+            client, LDi_prepareKey(&prepared, key), fallback, result, NULL);
+    }
+#endif
+
+    return LDi_borrowJSON(
+        client, LDi_prepareKey(&prepared, key), fallback, result, details);
+}
+
+LDBoolean
+LDBoolVariationReason(
+    struct LDClient *const    client,
+    const char *const         key,
+    const LDBoolean           fallback,
+    LDEvaluationDetail *const detail)
+{
+    LDBoolean           value, *valueRef, fallbackCast;
+    struct LDStoreNode *selected;
+
+    LD_ASSERT_API(client);
+    LD_ASSERT_API(key);
+    LD_ASSERT_API(detail);
+
+    fallbackCast = fallback;
+    valueRef     = &value;
+
+    LDi_evalInternal(
+        client, key, LDBool, &fallbackCast, (void **)&valueRef, &selected);
+    LDi_fillEvaluationDetail(client, key, selected, detail, LDBool);
+
+    return *valueRef;
+}
+
+int
+LDIntVariationReason(
+    struct LDClient *const    client,
+    const char *const         key,
+    const int                 fallback,
+    LDEvaluationDetail *const detail)
+{
+    double              value, *valueRef, fallbackCast;
+    struct LDStoreNode *selected;
+
+    LD_ASSERT_API(client);
+    LD_ASSERT_API(key);
+    LD_ASSERT_API(detail);
+
+    valueRef     = &value;
+    fallbackCast = fallback;
+
+    LDi_evalInternal(
+        client, key, LDNumber, &fallbackCast, (void **)&valueRef, &selected);
+    LDi_fillEvaluationDetail(client, key, selected, detail, LDNumber);
+
+    return *valueRef;
+}
+
+double
+LDDoubleVariationReason(
+    struct LDClient *const    client,
+    const char *const         key,
+    const double              fallback,
+    LDEvaluationDetail *const detail)
+{
+    double              value, *valueRef, fallbackCast;
+    struct LDStoreNode *selected;
+
+    LD_ASSERT_API(client);
+    LD_ASSERT_API(key);
+    LD_ASSERT_API(detail);
+
+    valueRef     = &value;
+    fallbackCast = fallback;
+
+    LDi_evalInternal(
+        client, key, LDNumber, &fallbackCast, (void **)&valueRef, &selected);
+    LDi_fillEvaluationDetail(client, key, selected, detail, LDNumber);
+
+    return *valueRef;
+}
+
+const char *
+LDStringVariationBorrowReason(
+    struct LDClient *const    client,
+    const char *const         key,
+    const char *const         fallback,
+    LDBorrowedString *const   result,
+    LDEvaluationDetail *const detail)
+{
+    char *              value;
+    struct LDStoreNode *selected;
+
+    LD_ASSERT_API(client);
+    LD_ASSERT_API(key);
+    LD_ASSERT_API(fallback);
+    LD_ASSERT_API(result);
+    LD_ASSERT_API(detail);
+
+    value    = NULL;
+    selected = NULL;
+
+    LDi_evalInternal(
+        client, key, LDText, (void *)fallback, (void **)&value, &selected);
+
+    result->value = value;
+    result->pin   = NULL;
+
+    if (selected && value != fallback) {
+        /* the borrowed string holds its own reference */
+        LDi_rc_increment(&selected->rc);
+
+        result->length = selected->valueLength;
+        result->pin    = selected;
+    } else {
+        result->length = strlen(value);
+    }
+
+    LDi_fillEvaluationDetail(client, key, selected, detail, LDText);
+
+    return result->value;
+}
+
+const struct LDJSON *
+LDJSONVariationBorrowReason(
+    struct LDClient *const     client,
+    const char *const          key,
+    const struct LDJSON *const fallback,
+    LDBorrowedJSON *const      result,
+    LDEvaluationDetail *const  detail)
+{
+    const struct LDJSON *value;
+    struct LDStoreNode * selected;
+
+    LD_ASSERT_API(client);
+    LD_ASSERT_API(key);
+    LD_ASSERT_API(fallback);
+    LD_ASSERT_API(result);
+    LD_ASSERT_API(detail);
+
+    value    = NULL;
+    selected = NULL;
+
+    LDi_evalInternal(
+        client, key, LDNull, (void *)fallback, (void **)&value, &selected);
+
+    result->value = value;
+    result->pin   = NULL;
+
+    if (selected && value != fallback) {
+        LDi_rc_increment(&selected->rc);
+
+        result->pin = selected;
+    }
+
+    LDi_fillEvaluationDetail(client, key, selected, detail, LDNull);
+
+    return result->value;
+}
+
+void
+LDEvaluationDetailRelease(LDEvaluationDetail *const detail)
+{
+    if (detail) {
+        if (detail->pin) {
+            LDi_rc_decrement(&((struct LDStoreNode *)detail->pin)->rc);
+        }
+
+        detail->pin = NULL;
+
+        LDi_reasonDecode(NULL, &detail->reason);
+    }
+}
+
+struct LDJSON *
+LDEvaluationReasonToJSON(const LDEvaluationReason *const reason)
+{
+    LD_ASSERT_API(reason);
+
+#ifdef LAUNCHDARKLY_DEFENSIVE
+    if (reason == NULL) {
+        LD_LOG(LD_LOG_WARNING, "LDEvaluationReasonToJSON NULL reason");
+
+        return NULL;
+    }
+#endif
+
+    return LDi_reasonToJSON(reason);
+}
+
+struct LDValue *
+LDBorrowedJSONAsValue(const LDBorrowedJSON *const borrowed)
+{
+    LD_ASSERT_API(borrowed);
+
+#ifdef LAUNCHDARKLY_DEFENSIVE
+    if (borrowed == NULL) {
+        LD_LOG(LD_LOG_WARNING, "LDBorrowedJSONAsValue NULL borrowed");
+
+        return NULL;
+    }
+#endif
+
+    /* LDValue shares the LDJSON representation */
+    return (struct LDValue *)borrowed->value;
+}
+
+void
+LDBorrowedJSONRelease(LDBorrowedJSON *const borrowed)
+{
+    if (borrowed) {
+        if (borrowed->pin) {
+            LDi_rc_decrement(&((struct LDStoreNode *)borrowed->pin)->rc);
+        }
+
+        borrowed->value = NULL;
+        borrowed->pin   = NULL;
+    }
+}
+
+/* Distinct evaluations counted in a snapshot before they are sent to the
+ * event processor individually. */
+#define LD_SNAPSHOT_TALLIES 32
+
+struct LDSnapshotTally
+{
+    const struct LDStoreNode *node;
+    LDJSONType                type;
+    LDBoolean                 boolFallback;
+    double                    numberFallback;
+    unsigned long             count;
+};
+
+struct LDClientSnapshot
+{
+    struct LDClient *      client;
+    /* NULL when the store was empty */
+    struct LDStoreTable *  table;
+    unsigned int           tallyCount;
+    struct LDSnapshotTally tallies[LD_SNAPSHOT_TALLIES];
+};
+
+struct LDClientSnapshot *
+LDClientSnapshotAcquire(struct LDClient *const client)
+{
+    struct LDClientSnapshot *snapshot;
+
+    LD_ASSERT_API(client);
+
+#ifdef LAUNCHDARKLY_DEFENSIVE
+    if (client == NULL) {
+        LD_LOG(LD_LOG_WARNING, "LDClientSnapshotAcquire NULL client");
+
+        return NULL;
+    }
+#endif
+
+    if (!(snapshot = LDAlloc(sizeof(struct LDClientSnapshot)))) {
+        LD_LOG(LD_LOG_ERROR, "LDClientSnapshotAcquire failed to allocate");
+
+        return NULL;
+    }
+
+    snapshot->client     = client;
+    snapshot->table      = LDi_storeAcquireTable(&client->store);
+    snapshot->tallyCount = 0;
+
+    return snapshot;
+}
+
+void
+LDClientSnapshotRelease(struct LDClientSnapshot *const snapshot)
+{
+    unsigned int           i;
+    struct EventProcessor *processor;
+
+    if (snapshot == NULL) {
+        return;
+    }
+
+    processor = snapshot->client->eventProcessor;
+
+    for (i = 0; i < snapshot->tallyCount; i++) {
+        const struct LDSnapshotTally *const tally = &snapshot->tallies[i];
+
+        LDBoolean boolValue;
+        double    numberValue;
+
+        boolValue   = LDBooleanFalse;
+        numberValue = 0;
+
+        if (tally->type == LDBool) {
+            boolValue = LDGetBool(tally->node->flag.value);
+        } else {
+            numberValue = LDGetNumber(tally->node->flag.value);
+        }
+
+        LDi_mutex_lock(&processor->lock);
+
+        if (!LDi_summarizeEvents(
+                processor,
+                tally->node->flag.key,
+                tally->node,
+                tally->type,
+                tally->type == LDBool ? (const void *)&tally->boolFallback
+                                      : (const void *)&tally->numberFallback,
+                tally->type == LDBool ? (const void *)&boolValue
+                                      : (const void *)&numberValue,
+                tally->count))
+        {
+            LD_LOG(LD_LOG_ERROR, "failed to summarize snapshot evaluations");
+        }
+
+        LDi_mutex_unlock(&processor->lock);
+    }
+
+    LDi_storeReleaseTable(snapshot->table);
+
+    LDFree(snapshot);
+}
+
+/* Counts an evaluation that only contributes to the summary. Returns false
+ * if the evaluation must be sent to the event processor instead. */
+static LDBoolean
+LDi_snapshotTally(
+    struct LDClientSnapshot *const  snapshot,
+    const struct LDStoreNode *const node,
+    const LDJSONType                type,
+    const void *const               fallback)
+{
+    unsigned int            i;
+    struct LDSnapshotTally *tally;
+
+    if (node->flag.trackEvents || node->flag.debugEventsUntilDate != 0) {
+        return LDBooleanFalse;
+    }
+
+    for (i = 0; i < snapshot->tallyCount; i++) {
+        tally = &snapshot->tallies[i];
+
+        if (tally->node == node && tally->type == type &&
+            (type == LDBool
+                 ? tally->boolFallback == *(const LDBoolean *)fallback
+                 : tally->numberFallback == *(const double *)fallback))
+        {
+            tally->count++;
+
+            return LDBooleanTrue;
+        }
+    }
+
+    if (snapshot->tallyCount == LD_SNAPSHOT_TALLIES) {
+        return LDBooleanFalse;
+    }
+
+    tally = &snapshot->tallies[snapshot->tallyCount++];
+
+    tally->node           = node;
+    tally->type           = type;
+    tally->boolFallback   = LDBooleanFalse;
+    tally->numberFallback = 0;
+    tally->count          = 1;
+
+    if (type == LDBool) {
+        tally->boolFallback = *(const LDBoolean *)fallback;
+    } else {
+        tally->numberFallback = *(const double *)fallback;
+    }
+
+    return LDBooleanTrue;
+}
+
+static void
+LDi_snapshotEvaluate(
+    struct LDClientSnapshot *const snapshot,
+    const char *const              flagKey,
+    const LDJSONType               variationKind,
+    void *const                    fallbackValue,
+    void **const                   resultValue)
+{
+    struct LDStoreNode *node;
+    struct LDClient *   client;
+
+    LD_ASSERT(snapshot);
+    LD_ASSERT(flagKey);
+    LD_ASSERT(resultValue);
+
+    client = snapshot->client;
+    node   = LDi_storeTableGet(snapshot->table, flagKey);
+
+    if (node && (variationKind == LDNull ||
+                 LDJSONGetType(node->flag.value) == variationKind))
+    {
+        if (variationKind == LDNull) {
+            *((struct LDJSON * *const) resultValue) = node->flag.value;
+        } else {
+            LDi_castJSONToValue(resultValue, node->flag.value, variationKind);
+        }
+
+        if ((variationKind == LDBool || variationKind == LDNumber) &&
+            LDi_snapshotTally(snapshot, node, variationKind, fallbackValue))
+        {
+            return;
+        }
+    } else {
+        *resultValue = fallbackValue;
+    }
+
+    LDi_rwlock_rdlock(&client->shared->sharedUserLock);
+
+    LDi_processEvalEvent(
+        client->eventProcessor,
+        client->shared->sharedUser,
+        flagKey,
+        variationKind,
+        node,
+        *(const void **)resultValue,
+        fallbackValue,
+        LDBooleanFalse);
+
+    LDi_rwlock_rdunlock(&client->shared->sharedUserLock);
+}
+
+LDBoolean
+LDSnapshotBoolVariation(
+    struct LDClientSnapshot *const snapshot,
+    const char *const              key,
+    const LDBoolean                fallback)
+{
+    LDBoolean value, *valueRef, fallbackCast;
+
+    LD_ASSERT_API(snapshot);
+    LD_ASSERT_API(key);
+
+#ifdef LAUNCHDARKLY_DEFENSIVE
+    if (snapshot == NULL || key == NULL) {
+        LD_LOG(LD_LOG_WARNING, "LDSnapshotBoolVariation NULL argument");
+
+        return fallback;
+    }
+#endif
+
+    fallbackCast = fallback;
+    valueRef     = &value;
+
+    LDi_snapshotEvaluate(
+        snapshot, key, LDBool, &fallbackCast, (void **)&valueRef);
+
+    return *valueRef;
+}
+
+int
+LDSnapshotIntVariation(
+    struct LDClientSnapshot *const snapshot,
+    const char *const              key,
+    const int                      fallback)
+{
+    double value, *valueRef, fallbackCast;
+
+    LD_ASSERT_API(snapshot);
+    LD_ASSERT_API(key);
+
+#ifdef LAUNCHDARKLY_DEFENSIVE
+    if (snapshot == NULL || key == NULL) {
+        LD_LOG(LD_LOG_WARNING, "LDSnapshotIntVariation NULL argument");
+
+        return fallback;
+    }
+#endif
+
+    fallbackCast = fallback;
+    valueRef     = &value;
+
+    LDi_snapshotEvaluate(
+        snapshot, key, LDNumber, &fallbackCast, (void **)&valueRef);
+
+    return *valueRef;
+}
+
+double
+LDSnapshotDoubleVariation(
+    struct LDClientSnapshot *const snapshot,
+    const char *const              key,
+    const double                   fallback)
+{
+    double value, *valueRef, fallbackCast;
+
+    LD_ASSERT_API(snapshot);
+    LD_ASSERT_API(key);
+
+#ifdef LAUNCHDARKLY_DEFENSIVE
+    if (snapshot == NULL || key == NULL) {
+        LD_LOG(LD_LOG_WARNING, "LDSnapshotDoubleVariation NULL argument");
+
+        return fallback;
+    }
+#endif
+
+    fallbackCast = fallback;
+    valueRef     = &value;
+
+    LDi_snapshotEvaluate(
+        snapshot, key, LDNumber, &fallbackCast, (void **)&valueRef);
+
+    return *valueRef;
+}
+
+const char *
+LDSnapshotStringVariation(
+    struct LDClientSnapshot *const snapshot,
+    const char *const              key,
+    const char *const              fallback)
+{
+    const char *value;
+
+    LD_ASSERT_API(snapshot);
+    LD_ASSERT_API(key);
+    LD_ASSERT_API(fallback);
+
+#ifdef LAUNCHDARKLY_DEFENSIVE
+    if (snapshot == NULL || key == NULL) {
+        LD_LOG(LD_LOG_WARNING, "LDSnapshotStringVariation NULL argument");
+
+        return fallback;
+    }
+#endif
+
+    LDi_snapshotEvaluate(
+        snapshot, key, LDText, (void *)fallback, (void **)&value);
+
+    return value;
+}
+
+const struct LDJSON *
+LDSnapshotJSONVariation(
+    struct LDClientSnapshot *const snapshot,
+    const char *const              key,
+    const struct LDJSON *const     fallback)
+{
+    struct LDJSON *value;
+
+    LD_ASSERT_API(snapshot);
+    LD_ASSERT_API(key);
+    LD_ASSERT_API(fallback);
+
+#ifdef LAUNCHDARKLY_DEFENSIVE
+    if (snapshot == NULL || key == NULL) {
+        LD_LOG(LD_LOG_WARNING, "LDSnapshotJSONVariation NULL argument");
+
+        return fallback;
+    }
+#endif
+
+    LDi_snapshotEvaluate(
+        snapshot, key, LDNull, (void *)fallback, (void **)&value);
+
+    return value;
+}
+
+void
+LDClientAlias(
+    struct LDClient *const     client,
+    const struct LDUser *const currentUser,
+    const struct LDUser *const previousUser)
+{
+    LD_ASSERT_API(client);
+    LD_ASSERT_API(currentUser);
+    LD_ASSERT_API(previousUser);
+
+#ifdef LAUNCHDARKLY_DEFENSIVE
+    if (client == NULL) {
+        LD_LOG(LD_LOG_WARNING, "LDClientAlias NULL client");
+
+        return;
+    }
+
+    if (currentUser == NULL) {
+        LD_LOG(LD_LOG_WARNING, "LDClientAlias NULL currentUser");
 
         return;
     }
@@ -1279,6 +2372,112 @@ LDClientTrackMetric(
     LDi_rwlock_rdunlock(&client->shared->sharedUserLock);
 }
 
+static LDBoolean
+LDi_trackRawJSON(
+    struct LDClient *const client,
+    const char *const      name,
+    const char *const      json,
+    const size_t           length,
+    const double           metric,
+    const LDBoolean        hasMetric)
+{
+    struct LDJSON *data;
+    LDBoolean      tracked;
+
+    if (!LDi_validateJSON(json, length)) {
+        LD_LOG(LD_LOG_ERROR, "custom event data is not valid JSON");
+
+        return LDBooleanFalse;
+    }
+
+    if (!(data = LDi_newRawJSON(json, length))) {
+        LD_LOG(LD_LOG_ERROR, "alloc error");
+
+        return LDBooleanFalse;
+    }
+
+    LDi_rwlock_rdlock(&client->shared->sharedUserLock);
+    tracked = LDi_track(
+        client->eventProcessor,
+        client->shared->sharedUser,
+        name,
+        data,
+        metric,
+        hasMetric);
+    LDi_rwlock_rdunlock(&client->shared->sharedUserLock);
+
+    return tracked;
+}
+
+LDBoolean
+LDClientTrackRawJSON(
+    struct LDClient *const client,
+    const char *const      name,
+    const char *const      json,
+    const size_t           length)
+{
+    LD_ASSERT_API(client);
+    LD_ASSERT_API(name);
+    LD_ASSERT_API(json);
+
+#ifdef LAUNCHDARKLY_DEFENSIVE
+    if (client == NULL) {
+        LD_LOG(LD_LOG_WARNING, "LDClientTrackRawJSON NULL client");
+
+        return LDBooleanFalse;
+    }
+
+    if (name == NULL) {
+        LD_LOG(LD_LOG_WARNING, "LDClientTrackRawJSON NULL name");
+
+        return LDBooleanFalse;
+    }
+
+    if (json == NULL) {
+        LD_LOG(LD_LOG_WARNING, "LDClientTrackRawJSON NULL json");
+
+        return LDBooleanFalse;
+    }
+#endif
+
+    return LDi_trackRawJSON(client, name, json, length, 0, LDBooleanFalse);
+}
+
+LDBoolean
+LDClientTrackMetricRawJSON(
+    struct LDClient *const client,
+    const char *const      name,
+    const char *const      json,
+    const size_t           length,
+    const double           metric)
+{
+    LD_ASSERT_API(client);
+    LD_ASSERT_API(name);
+    LD_ASSERT_API(json);
+
+#ifdef LAUNCHDARKLY_DEFENSIVE
+    if (client == NULL) {
+        LD_LOG(LD_LOG_WARNING, "LDClientTrackMetricRawJSON NULL client");
+
+        return LDBooleanFalse;
+    }
+
+    if (name == NULL) {
+        LD_LOG(LD_LOG_WARNING, "LDClientTrackMetricRawJSON NULL name");
+
+        return LDBooleanFalse;
+    }
+
+    if (json == NULL) {
+        LD_LOG(LD_LOG_WARNING, "LDClientTrackMetricRawJSON NULL json");
+
+        return LDBooleanFalse;
+    }
+#endif
+
+    return LDi_trackRawJSON(client, name, json, length, metric, LDBooleanTrue);
+}
+
 void
 LDClientFlush(struct LDClient *const client)
 {
@@ -1300,6 +2499,22 @@ LDClientFlush(struct LDClient *const client)
     }
 }
 
+unsigned long
+LDClientGetDroppedEventCount(struct LDClient *const client)
+{
+    LD_ASSERT_API(client);
+
+#ifdef LAUNCHDARKLY_DEFENSIVE
+    if (client == NULL) {
+        LD_LOG(LD_LOG_WARNING, "LDClientGetDroppedEventCount NULL client");
+
+        return 0;
+    }
+#endif
+
+    return LDi_droppedEventCount(client->eventProcessor);
+}
+
 LDBoolean
 LDClientRegisterFeatureFlagListener(
     struct LDClient *const client, const char *const key, LDlistenerfn fn)
@@ -1370,6 +2585,104 @@ LDClientUnregisterFeatureFlagListener(
     LDi_storeUnregisterListener(&client->store, key, fn);
 }
 
+LDBoolean
+LDClientRegisterFlagChangeListener(
+    struct LDClient *const client,
+    const char *const      key,
+    LDFlagChangeListener   fn,
+    void *const            context)
+{
+    LD_ASSERT_API(client);
+    LD_ASSERT_API(key);
+    LD_ASSERT_API(fn);
+
+#ifdef LAUNCHDARKLY_DEFENSIVE
+    if (client == NULL) {
+        LD_LOG(LD_LOG_WARNING, "LDClientRegisterFlagChangeListener NULL client");
+
+        return LDBooleanFalse;
+    }
+
+    if (key == NULL) {
+        LD_LOG(LD_LOG_WARNING, "LDClientRegisterFlagChangeListener NULL key");
+
+        return LDBooleanFalse;
+    }
+
+    if (fn == NULL) {
+        LD_LOG(
+            LD_LOG_WARNING, "LDClientRegisterFlagChangeListener NULL listener");
+
+        return LDBooleanFalse;
+    }
+#endif
+
+    return LDi_storeRegisterChangeListener(&client->store, key, fn, context);
+}
+
+void
+LDClientUnregisterFlagChangeListener(
+    struct LDClient *const client,
+    const char *const      key,
+    LDFlagChangeListener   fn,
+    void *const            context)
+{
+    LD_ASSERT_API(client);
+    LD_ASSERT_API(key);
+    LD_ASSERT_API(fn);
+
+#ifdef LAUNCHDARKLY_DEFENSIVE
+    if (client == NULL) {
+        LD_LOG(
+            LD_LOG_WARNING, "LDClientUnregisterFlagChangeListener NULL client");
+
+        return;
+    }
+
+    if (key == NULL) {
+        LD_LOG(LD_LOG_WARNING, "LDClientUnregisterFlagChangeListener NULL key");
+
+        return;
+    }
+
+    if (fn == NULL) {
+        LD_LOG(
+            LD_LOG_WARNING,
+            "LDClientUnregisterFlagChangeListener NULL listener");
+
+        return;
+    }
+#endif
+
+    LDi_storeUnregisterChangeListener(&client->store, key, fn, context);
+}
+
+LDBoolean
+LDClientGetListenerStatistics(
+    struct LDClient *const client, LDListenerStatistics *const statistics)
+{
+    LD_ASSERT_API(client);
+    LD_ASSERT_API(statistics);
+
+#ifdef LAUNCHDARKLY_DEFENSIVE
+    if (client == NULL) {
+        LD_LOG(LD_LOG_WARNING, "LDClientGetListenerStatistics NULL client");
+
+        return LDBooleanFalse;
+    }
+
+    if (statistics == NULL) {
+        LD_LOG(LD_LOG_WARNING, "LDClientGetListenerStatistics NULL statistics");
+
+        return LDBooleanFalse;
+    }
+#endif
+
+    LDi_storeListenerStatistics(&client->store, statistics);
+
+    return LDBooleanTrue;
+}
+
 void
 LDi_updatestatus(struct LDClient *const client, const LDStatus status)
 {
@@ -1381,7 +2694,7 @@ LDi_updatestatus(struct LDClient *const client, const LDStatus status)
             LDi_rwlock_wrlock(&client->clientLock);
         }
     }
-    LDi_cond_signal(&client->initCond);
+    LDi_cond_broadcast(&client->initCond);
 }
 
 void
@@ -3,6 +3,8 @@
 #include "uthash.h"
 
 #include "config.h"
+#include "event_delivery.h"
+#include "event_spool.h"
 #include "store.h"
 #include "user.h"
 #include "socket.h"
@@ -34,6 +36,12 @@ struct LDClient
     LDBoolean              shouldstopstreaming;
     struct ld_socket_state streamhandle;
     struct EventProcessor *eventProcessor;
+    /* NULL unless spooling is configured */
+    struct LDEventSpool *  eventSpool;
+    /* payloads bundled by eventThread, sent by deliveryThreads */
+    struct LDEventDelivery delivery;
+    ld_thread_t *          deliveryThreads;
+    unsigned int           deliveryThreadCount;
     struct LDStore         store;
     ld_cond_t              initCond;
     ld_mutex_t             initCondMtx;
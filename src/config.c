@@ -62,6 +62,13 @@ LDConfigNew(const char *const mobileKey)
     config->disableBackgroundUpdating       = LDBooleanFalse;
     config->eventsCapacity                  = 100;
     config->eventsFlushIntervalMillis       = 30000;
+    config->eventsOverflowPolicy            = LDEventsOverflowDropNewest;
+    config->eventsHighWatermark             = 0;
+    config->eventsSpoolPath                 = NULL;
+    config->eventsSpoolMaxBytes             = 1024 * 1024;
+    config->eventsMaxPayloadBytes           = 512 * 1024;
+    config->eventsMaxInFlightPayloads       = 2;
+    config->eventsMaxInFlightBytes          = 1024 * 1024;
     config->offline                         = LDBooleanFalse;
     config->pollingIntervalMillis           = 30 * 1000;
     config->privateAttributeNames           = NULL;
@@ -72,12 +79,18 @@ LDConfigNew(const char *const mobileKey)
     config->verifyPeer                      = LDBooleanTrue;
     config->certFile                        = NULL;
     config->inlineUsersInEvents             = LDBooleanFalse;
+    config->deduplicateInlineUsers          = LDBooleanFalse;
     config->appURI                          = NULL;
     config->eventsURI                       = NULL;
     config->mobileKey                       = NULL;
     config->streamURI                       = NULL;
     config->secondaryMobileKeys             = NULL;
     config->autoAliasOptOut                 = 0;
+    config->evaluationCache                 = LDBooleanFalse;
+    config->suppressUnchangedNotifications  = LDBooleanFalse;
+    config->flagManifest                    = NULL;
+    config->flagManifestCount               = 0;
+    config->aggregatedMetrics               = NULL;
 
     if (!LDSetString(&config->appURI, "https://app.launchdarkly.com")) {
         goto error;
@@ -270,6 +283,198 @@ LDConfigSetEventsFlushIntervalMillis(
     config->eventsFlushIntervalMillis = millis;
 }
 
+void
+LDConfigSetEventsOverflowPolicy(
+    struct LDConfig *const config, const LDEventsOverflowPolicy policy)
+{
+    LD_ASSERT_API(config);
+
+#ifdef LAUNCHDARKLY_DEFENSIVE
+    if (config == NULL) {
+        LD_LOG(LD_LOG_WARNING, "LDConfigSetEventsOverflowPolicy NULL config");
+
+        return;
+    }
+
+    if (policy != LDEventsOverflowDropNewest &&
+        policy != LDEventsOverflowDropOldest &&
+        policy != LDEventsOverflowProbabilisticDropOldest)
+    {
+        LD_LOG(LD_LOG_WARNING, "LDConfigSetEventsOverflowPolicy unknown policy");
+
+        return;
+    }
+#endif
+
+    config->eventsOverflowPolicy = policy;
+}
+
+void
+LDConfigSetEventsHighWatermark(
+    struct LDConfig *const config, const unsigned int watermark)
+{
+    LD_ASSERT_API(config);
+
+#ifdef LAUNCHDARKLY_DEFENSIVE
+    if (config == NULL) {
+        LD_LOG(LD_LOG_WARNING, "LDConfigSetEventsHighWatermark NULL config");
+
+        return;
+    }
+#endif
+
+    config->eventsHighWatermark = watermark;
+}
+
+void
+LDConfigSetEventsMaxPayloadBytes(
+    struct LDConfig *const config, const size_t bytes)
+{
+    LD_ASSERT_API(config);
+
+#ifdef LAUNCHDARKLY_DEFENSIVE
+    if (config == NULL) {
+        LD_LOG(LD_LOG_WARNING, "LDConfigSetEventsMaxPayloadBytes NULL config");
+
+        return;
+    }
+#endif
+
+    config->eventsMaxPayloadBytes = bytes;
+}
+
+void
+LDConfigSetEventsMaxInFlightPayloads(
+    struct LDConfig *const config, const unsigned int payloads)
+{
+    LD_ASSERT_API(config);
+    LD_ASSERT_API(payloads > 0);
+
+#ifdef LAUNCHDARKLY_DEFENSIVE
+    if (config == NULL) {
+        LD_LOG(
+            LD_LOG_WARNING, "LDConfigSetEventsMaxInFlightPayloads NULL config");
+
+        return;
+    }
+
+    if (payloads == 0) {
+        LD_LOG(
+            LD_LOG_WARNING,
+            "LDConfigSetEventsMaxInFlightPayloads payloads must be positive");
+
+        return;
+    }
+#endif
+
+    config->eventsMaxInFlightPayloads = payloads;
+}
+
+void
+LDConfigSetEventsMaxInFlightBytes(
+    struct LDConfig *const config, const size_t bytes)
+{
+    LD_ASSERT_API(config);
+
+#ifdef LAUNCHDARKLY_DEFENSIVE
+    if (config == NULL) {
+        LD_LOG(LD_LOG_WARNING, "LDConfigSetEventsMaxInFlightBytes NULL config");
+
+        return;
+    }
+#endif
+
+    config->eventsMaxInFlightBytes = bytes;
+}
+
+LDBoolean
+LDConfigAddAggregatedMetric(struct LDConfig *const config, const char *const key)
+{
+    struct LDJSON *tmp;
+
+    LD_ASSERT_API(config);
+    LD_ASSERT_API(key);
+
+#ifdef LAUNCHDARKLY_DEFENSIVE
+    if (config == NULL) {
+        LD_LOG(LD_LOG_WARNING, "LDConfigAddAggregatedMetric NULL config");
+
+        return LDBooleanFalse;
+    }
+
+    if (key == NULL) {
+        LD_LOG(LD_LOG_WARNING, "LDConfigAddAggregatedMetric NULL key");
+
+        return LDBooleanFalse;
+    }
+#endif
+
+    if (!config->aggregatedMetrics) {
+        if (!(config->aggregatedMetrics = LDNewObject())) {
+            LD_LOG(
+                LD_LOG_ERROR, "LDConfigAddAggregatedMetric failed to allocate");
+
+            return LDBooleanFalse;
+        }
+    }
+
+    if (!(tmp = LDNewBool(LDBooleanTrue))) {
+        LD_LOG(LD_LOG_ERROR, "LDConfigAddAggregatedMetric failed to allocate");
+
+        return LDBooleanFalse;
+    }
+
+    if (!LDObjectSetKey(config->aggregatedMetrics, key, tmp)) {
+        LDJSONFree(tmp);
+
+        LD_LOG(LD_LOG_ERROR, "LDConfigAddAggregatedMetric failed to add key");
+
+        return LDBooleanFalse;
+    }
+
+    return LDBooleanTrue;
+}
+
+LDBoolean
+LDConfigSetEventsSpoolPath(struct LDConfig *const config, const char *const path)
+{
+    LD_ASSERT_API(config);
+    LD_ASSERT_API(path);
+
+#ifdef LAUNCHDARKLY_DEFENSIVE
+    if (config == NULL) {
+        LD_LOG(LD_LOG_WARNING, "LDConfigSetEventsSpoolPath NULL config");
+
+        return LDBooleanFalse;
+    }
+
+    if (path == NULL) {
+        LD_LOG(LD_LOG_WARNING, "LDConfigSetEventsSpoolPath NULL path");
+
+        return LDBooleanFalse;
+    }
+#endif
+
+    return LDSetString(&config->eventsSpoolPath, path);
+}
+
+void
+LDConfigSetEventsSpoolMaxBytes(
+    struct LDConfig *const config, const size_t maxBytes)
+{
+    LD_ASSERT_API(config);
+
+#ifdef LAUNCHDARKLY_DEFENSIVE
+    if (config == NULL) {
+        LD_LOG(LD_LOG_WARNING, "LDConfigSetEventsSpoolMaxBytes NULL config");
+
+        return;
+    }
+#endif
+
+    config->eventsSpoolMaxBytes = maxBytes;
+}
+
 LDBoolean
 LDConfigSetEventsURI(struct LDConfig *const config, const char *const uri)
 {
@@ -588,6 +793,86 @@ LDConfigSetInlineUsersInEvents(
     config->inlineUsersInEvents = inlineUsers;
 }
 
+void
+LDConfigSetDeduplicateInlineUsers(
+    struct LDConfig *const config, const LDBoolean deduplicate)
+{
+    LD_ASSERT_API(config);
+
+#ifdef LAUNCHDARKLY_DEFENSIVE
+    if (config == NULL) {
+        LD_LOG(LD_LOG_WARNING, "LDConfigSetDeduplicateInlineUsers NULL config");
+
+        return;
+    }
+#endif
+
+    config->deduplicateInlineUsers = deduplicate;
+}
+
+void
+LDConfigSetEvaluationCache(
+    struct LDConfig *const config, const LDBoolean enabled)
+{
+    LD_ASSERT_API(config);
+
+#ifdef LAUNCHDARKLY_DEFENSIVE
+    if (config == NULL) {
+        LD_LOG(LD_LOG_WARNING, "LDConfigSetEvaluationCache NULL config");
+
+        return;
+    }
+#endif
+
+    config->evaluationCache = enabled;
+}
+
+void
+LDConfigSetSuppressUnchangedNotifications(
+    struct LDConfig *const config, const LDBoolean suppress)
+{
+    LD_ASSERT_API(config);
+
+#ifdef LAUNCHDARKLY_DEFENSIVE
+    if (config == NULL) {
+        LD_LOG(
+            LD_LOG_WARNING,
+            "LDConfigSetSuppressUnchangedNotifications NULL config");
+
+        return;
+    }
+#endif
+
+    config->suppressUnchangedNotifications = suppress;
+}
+
+void
+LDConfigSetFlagManifest(
+    struct LDConfig *const config,
+    const LDFlagKey *const keys,
+    const unsigned int     keyCount)
+{
+    LD_ASSERT_API(config);
+    LD_ASSERT_API(keys || keyCount == 0);
+
+#ifdef LAUNCHDARKLY_DEFENSIVE
+    if (config == NULL) {
+        LD_LOG(LD_LOG_WARNING, "LDConfigSetFlagManifest NULL config");
+
+        return;
+    }
+
+    if (keys == NULL && keyCount != 0) {
+        LD_LOG(LD_LOG_WARNING, "LDConfigSetFlagManifest NULL keys");
+
+        return;
+    }
+#endif
+
+    config->flagManifest      = keys;
+    config->flagManifestCount = keyCount;
+}
+
 void
 LDConfigAutoAliasOptOut(struct LDConfig *const config, const LDBoolean optOut)
 {
@@ -614,8 +899,10 @@ LDConfigFree(struct LDConfig *const config)
         LDFree(config->streamURI);
         LDFree(config->proxyURI);
         LDFree(config->certFile);
+        LDFree(config->eventsSpoolPath);
         LDJSONFree(config->privateAttributeNames);
         LDJSONFree(config->secondaryMobileKeys);
+        LDJSONFree(config->aggregatedMetrics);
         LDFree(config);
     }
 }
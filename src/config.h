@@ -1,6 +1,7 @@
 #pragma once
 
 #include <launchdarkly/boolean.h>
+#include <launchdarkly/config.h>
 #include <launchdarkly/json.h>
 
 struct LDConfig
@@ -13,6 +14,13 @@ struct LDConfig
     LDBoolean    disableBackgroundUpdating;
     unsigned int eventsCapacity;
     int          eventsFlushIntervalMillis;
+    LDEventsOverflowPolicy eventsOverflowPolicy;
+    unsigned int eventsHighWatermark;
+    char *       eventsSpoolPath;
+    size_t       eventsSpoolMaxBytes;
+    size_t       eventsMaxPayloadBytes;
+    unsigned int eventsMaxInFlightPayloads;
+    size_t       eventsMaxInFlightBytes;
     char *       eventsURI;
     char *       mobileKey;
     LDBoolean    offline;
@@ -25,11 +33,19 @@ struct LDConfig
     LDBoolean    useReasons;
     char *       certFile;
     LDBoolean    inlineUsersInEvents;
+    LDBoolean    deduplicateInlineUsers;
     LDBoolean    autoAliasOptOut;
+    LDBoolean    evaluationCache;
+    LDBoolean    suppressUnchangedNotifications;
+    /* not owned, see LDConfigSetFlagManifest */
+    const LDFlagKey *flagManifest;
+    unsigned int     flagManifestCount;
     /* map of name -> key */
     struct LDJSON *secondaryMobileKeys;
     /* array of strings */
     struct LDJSON *privateAttributeNames;
+    /* map of custom event key -> true, NULL if none */
+    struct LDJSON *aggregatedMetrics;
 };
 
 
@@ -0,0 +1,390 @@
+#include <string.h>
+
+#include <launchdarkly/memory.h>
+
+#include "assertion.h"
+#include "concurrency.h"
+#include "eval_cache.h"
+#include "event_processor_internal.h"
+#include "utility.h"
+
+/* Must be a power of two. */
+#define LD_EVAL_CACHE_SLOTS 64
+/* Longer keys are not cached. */
+#define LD_EVAL_CACHE_KEY 48
+
+struct LDEvalCacheEntry
+{
+    /* NULL when the entry is empty */
+    const struct LDStore * store;
+    struct EventProcessor *processor;
+    unsigned long          generation;
+    unsigned int           hash;
+    LDJSONType             type;
+    LDBoolean              boolValue;
+    LDBoolean              boolFallback;
+    double                 numberValue;
+    double                 numberFallback;
+    int                    version;
+    int                    flagVersion;
+    int                    variation;
+    /* evaluations not yet added to the summary */
+    unsigned long          pending;
+    char                   key[LD_EVAL_CACHE_KEY];
+};
+
+struct LDEvalCache
+{
+    ld_mutex_t               lock;
+    struct LDEvalCache *     previous;
+    struct LDEvalCache *     next;
+    struct LDEvalCacheEntry entries[LD_EVAL_CACHE_SLOTS];
+};
+
+static LDBoolean           LDi_evalCacheReady = LDBooleanFalse;
+/* Guards the list of thread caches. Ordered before a cache lock, which is
+ * ordered before an event processor lock. */
+static ld_mutex_t          LDi_evalCachesLock;
+static struct LDEvalCache *LDi_evalCaches = NULL;
+
+/* Adds pending evaluations of an entry to its processor's summary. Called
+ * with the cache lock held. */
+static void
+LDi_evalCacheFold(struct LDEvalCacheEntry *const entry)
+{
+    struct LDStoreNode node;
+
+    if (entry->store == NULL || entry->pending == 0) {
+        return;
+    }
+
+    /* the summary only reads the versions and variation of a node */
+    memset(&node, 0, sizeof(node));
+    node.flag.key         = entry->key;
+    node.flag.version     = entry->version;
+    node.flag.flagVersion = entry->flagVersion;
+    node.flag.variation   = entry->variation;
+
+    LDi_mutex_lock(&entry->processor->lock);
+
+    if (!LDi_summarizeEvents(
+            entry->processor,
+            entry->key,
+            &node,
+            entry->type,
+            entry->type == LDBool ? (const void *)&entry->boolFallback
+                                  : (const void *)&entry->numberFallback,
+            entry->type == LDBool ? (const void *)&entry->boolValue
+                                  : (const void *)&entry->numberValue,
+            entry->pending))
+    {
+        LD_LOG(LD_LOG_ERROR, "failed to summarize cached evaluations");
+    }
+
+    LDi_mutex_unlock(&entry->processor->lock);
+
+    entry->pending = 0;
+}
+
+static void
+LDi_evalCacheDestroy(struct LDEvalCache *const cache)
+{
+    size_t i;
+
+    LDi_mutex_lock(&LDi_evalCachesLock);
+
+    if (cache->previous) {
+        cache->previous->next = cache->next;
+    } else {
+        LDi_evalCaches = cache->next;
+    }
+
+    if (cache->next) {
+        cache->next->previous = cache->previous;
+    }
+
+    LDi_mutex_lock(&cache->lock);
+
+    for (i = 0; i < LD_EVAL_CACHE_SLOTS; i++) {
+        LDi_evalCacheFold(&cache->entries[i]);
+    }
+
+    LDi_mutex_unlock(&cache->lock);
+
+    LDi_mutex_unlock(&LDi_evalCachesLock);
+
+    LDi_mutex_destroy(&cache->lock);
+
+    LDFree(cache);
+}
+
+#ifdef _WIN32
+static DWORD LDi_evalCacheKey = FLS_OUT_OF_INDEXES;
+
+static void WINAPI
+LDi_evalCacheDestroyCallback(void *const cache)
+{
+    if (cache) {
+        LDi_evalCacheDestroy((struct LDEvalCache *)cache);
+    }
+}
+
+#define LD_EVAL_CACHE_GET()                                                    \
+    ((struct LDEvalCache *)FlsGetValue(LDi_evalCacheKey))
+#define LD_EVAL_CACHE_SET(cache) (FlsSetValue(LDi_evalCacheKey, (cache)) != 0)
+#else
+static pthread_key_t LDi_evalCacheKey;
+
+static void
+LDi_evalCacheDestroyCallback(void *const cache)
+{
+    LDi_evalCacheDestroy((struct LDEvalCache *)cache);
+}
+
+#define LD_EVAL_CACHE_GET()                                                    \
+    ((struct LDEvalCache *)pthread_getspecific(LDi_evalCacheKey))
+#define LD_EVAL_CACHE_SET(cache)                                               \
+    (pthread_setspecific(LDi_evalCacheKey, (cache)) == 0)
+#endif
+
+void
+LDi_evalCacheInitialize(void)
+{
+    if (!LDi_mutex_init(&LDi_evalCachesLock)) {
+        return;
+    }
+
+#ifdef _WIN32
+    if ((LDi_evalCacheKey = FlsAlloc(LDi_evalCacheDestroyCallback)) ==
+        FLS_OUT_OF_INDEXES)
+    {
+        LDi_mutex_destroy(&LDi_evalCachesLock);
+
+        return;
+    }
+#else
+    if (pthread_key_create(&LDi_evalCacheKey, LDi_evalCacheDestroyCallback))
+    {
+        LDi_mutex_destroy(&LDi_evalCachesLock);
+
+        return;
+    }
+#endif
+
+    LDi_evalCacheReady = LDBooleanTrue;
+}
+
+/* Returns the calling thread's cache, creating it on first use. */
+static struct LDEvalCache *
+LDi_evalCacheForThread(void)
+{
+    struct LDEvalCache *cache;
+
+    if (!LDi_evalCacheReady) {
+        return NULL;
+    }
+
+    if ((cache = LD_EVAL_CACHE_GET())) {
+        return cache;
+    }
+
+    if (!(cache = (struct LDEvalCache *)LDAlloc(sizeof(struct LDEvalCache)))) {
+        return NULL;
+    }
+
+    memset(cache, 0, sizeof(struct LDEvalCache));
+
+    if (!LDi_mutex_init(&cache->lock)) {
+        LDFree(cache);
+
+        return NULL;
+    }
+
+    if (!LD_EVAL_CACHE_SET(cache)) {
+        LDi_mutex_destroy(&cache->lock);
+        LDFree(cache);
+
+        return NULL;
+    }
+
+    LDi_mutex_lock(&LDi_evalCachesLock);
+
+    cache->next = LDi_evalCaches;
+
+    if (LDi_evalCaches) {
+        LDi_evalCaches->previous = cache;
+    }
+
+    LDi_evalCaches = cache;
+
+    LDi_mutex_unlock(&LDi_evalCachesLock);
+
+    return cache;
+}
+
+LDBoolean
+LDi_evalCacheGet(
+    struct LDStore *const        store,
+    struct EventProcessor *const processor,
+    const LDFlagKey *const       key,
+    const LDJSONType             type,
+    void *const                  result)
+{
+    struct LDEvalCache *     cache;
+    struct LDEvalCacheEntry *entry;
+    unsigned long            generation;
+    LDBoolean                hit;
+
+    LD_ASSERT(store);
+    LD_ASSERT(processor);
+    LD_ASSERT(key);
+    LD_ASSERT(result);
+
+    if (key->length >= LD_EVAL_CACHE_KEY) {
+        return LDBooleanFalse;
+    }
+
+    if (!(cache = LDi_evalCacheForThread())) {
+        return LDBooleanFalse;
+    }
+
+    entry      = &cache->entries[key->hash & (LD_EVAL_CACHE_SLOTS - 1)];
+    generation = LDi_storeGeneration(store);
+    hit        = LDBooleanFalse;
+
+    LDi_mutex_lock(&cache->lock);
+
+    if (entry->store == store && entry->processor == processor &&
+        entry->generation == generation && entry->type == type &&
+        entry->hash == key->hash && strcmp(entry->key, key->key) == 0)
+    {
+        if (type == LDBool) {
+            *(LDBoolean *)result = entry->boolValue;
+        } else {
+            *(double *)result = entry->numberValue;
+        }
+
+        entry->pending++;
+
+        hit = LDBooleanTrue;
+    }
+
+    LDi_mutex_unlock(&cache->lock);
+
+    return hit;
+}
+
+void
+LDi_evalCachePut(
+    struct LDStore *const           store,
+    struct EventProcessor *const    processor,
+    const LDFlagKey *const          key,
+    const LDJSONType                type,
+    const unsigned long             generation,
+    const struct LDStoreNode *const node,
+    const void *const               value,
+    const void *const               fallback)
+{
+    struct LDEvalCache *     cache;
+    struct LDEvalCacheEntry *entry;
+
+    LD_ASSERT(store);
+    LD_ASSERT(processor);
+    LD_ASSERT(key);
+    LD_ASSERT(node);
+    LD_ASSERT(value);
+    LD_ASSERT(fallback);
+
+    if (type != LDBool && type != LDNumber) {
+        return;
+    }
+
+    /* these evaluations generate full events */
+    if (node->flag.trackEvents || node->flag.debugEventsUntilDate != 0) {
+        return;
+    }
+
+    if (key->length >= LD_EVAL_CACHE_KEY) {
+        return;
+    }
+
+    if (!(cache = LDi_evalCacheForThread())) {
+        return;
+    }
+
+    entry = &cache->entries[key->hash & (LD_EVAL_CACHE_SLOTS - 1)];
+
+    LDi_mutex_lock(&cache->lock);
+
+    LDi_evalCacheFold(entry);
+
+    entry->store       = store;
+    entry->processor   = processor;
+    entry->generation  = generation;
+    entry->hash        = key->hash;
+    entry->type        = type;
+    entry->version     = node->flag.version;
+    entry->flagVersion = node->flag.flagVersion;
+    entry->variation   = node->flag.variation;
+    entry->pending     = 0;
+
+    if (type == LDBool) {
+        entry->boolValue    = *(const LDBoolean *)value;
+        entry->boolFallback = *(const LDBoolean *)fallback;
+    } else {
+        entry->numberValue    = *(const double *)value;
+        entry->numberFallback = *(const double *)fallback;
+    }
+
+    memcpy(entry->key, key->key, key->length + 1);
+
+    LDi_mutex_unlock(&cache->lock);
+}
+
+static void
+LDi_evalCacheVisit(
+    struct EventProcessor *const processor, const LDBoolean forget)
+{
+    struct LDEvalCache *cache;
+    size_t              i;
+
+    LD_ASSERT(processor);
+
+    if (!LDi_evalCacheReady) {
+        return;
+    }
+
+    LDi_mutex_lock(&LDi_evalCachesLock);
+
+    for (cache = LDi_evalCaches; cache; cache = cache->next) {
+        LDi_mutex_lock(&cache->lock);
+
+        for (i = 0; i < LD_EVAL_CACHE_SLOTS; i++) {
+            struct LDEvalCacheEntry *const entry = &cache->entries[i];
+
+            if (entry->processor == processor) {
+                LDi_evalCacheFold(entry);
+
+                if (forget) {
+                    memset(entry, 0, sizeof(struct LDEvalCacheEntry));
+                }
+            }
+        }
+
+        LDi_mutex_unlock(&cache->lock);
+    }
+
+    LDi_mutex_unlock(&LDi_evalCachesLock);
+}
+
+void
+LDi_evalCacheFlush(struct EventProcessor *const processor)
+{
+    LDi_evalCacheVisit(processor, LDBooleanFalse);
+}
+
+void
+LDi_evalCachePurge(struct EventProcessor *const processor)
+{
+    LDi_evalCacheVisit(processor, LDBooleanTrue);
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <launchdarkly/api.h>
+
+#include "event_processor.h"
+#include "store.h"
+
+/* Optional per thread cache of boolean and number evaluation results,
+ * enabled with LDConfigSetEvaluationCache.
+ *
+ * Each thread owns a small direct mapped table. Entries remember the store
+ * generation they were read at, so any change to the store invalidates
+ * them. A hit skips the store and the event processor, and only counts the
+ * evaluation in the entry. Pending counts are added to the summary when the
+ * entry is replaced, when the thread exits, and before the event processor
+ * bundles a payload.
+ *
+ * Flags that produce full feature events are never cached. */
+
+/* Called once from LDi_earlyinit. */
+void
+LDi_evalCacheInitialize(void);
+
+/* On a hit writes an LDBoolean or double, depending on type, to result. */
+LDBoolean
+LDi_evalCacheGet(
+    struct LDStore *const        store,
+    struct EventProcessor *const processor,
+    const LDFlagKey *const       key,
+    const LDJSONType             type,
+    void *const                  result);
+
+/* Records the result of a store evaluation. Generation must have been read
+ * before the node was obtained from the store. Must not be called with the
+ * event processor lock held. */
+void
+LDi_evalCachePut(
+    struct LDStore *const           store,
+    struct EventProcessor *const    processor,
+    const LDFlagKey *const          key,
+    const LDJSONType                type,
+    const unsigned long             generation,
+    const struct LDStoreNode *const node,
+    const void *const               value,
+    const void *const               fallback);
+
+/* Adds pending counts for processor, on every thread, to its summary. Must
+ * not be called with the event processor lock held. */
+void
+LDi_evalCacheFlush(struct EventProcessor *const processor);
+
+/* Flushes, then forgets all entries for processor before it is freed. */
+void
+LDi_evalCachePurge(struct EventProcessor *const processor);
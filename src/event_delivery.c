@@ -0,0 +1,288 @@
+#include <string.h>
+
+#include <launchdarkly/memory.h>
+
+#include "assertion.h"
+#include "event_delivery.h"
+
+struct LDEventBatch *
+LDi_newEventBatch(char *const payload, const char *const payloadId)
+{
+    struct LDEventBatch *batch;
+
+    LD_ASSERT(payload);
+    LD_ASSERT(payloadId);
+    LD_ASSERT(strlen(payloadId) == LD_UUID_SIZE);
+
+    if (!(batch = LDAlloc(sizeof(struct LDEventBatch)))) {
+        LDFree(payload);
+
+        return NULL;
+    }
+
+    batch->payload = payload;
+    batch->size    = strlen(payload);
+    batch->spooled = LDBooleanFalse;
+    batch->next    = NULL;
+
+    memcpy(batch->payloadId, payloadId, LD_UUID_SIZE + 1);
+
+    return batch;
+}
+
+void
+LDi_freeEventBatch(struct LDEventBatch *const batch)
+{
+    if (batch) {
+        LDFree(batch->payload);
+        LDFree(batch);
+    }
+}
+
+LDBoolean
+LDi_deliveryInitialize(
+    struct LDEventDelivery *const delivery,
+    const unsigned int            maxBatches,
+    const size_t                  maxBytes)
+{
+    LD_ASSERT(delivery);
+
+    delivery->head          = NULL;
+    delivery->tail          = NULL;
+    delivery->inFlight      = 0;
+    delivery->inFlightBytes = 0;
+    delivery->maxBatches    = maxBatches ? maxBatches : 1;
+    delivery->maxBytes      = maxBytes;
+    delivery->healthy       = LDBooleanTrue;
+    delivery->closing       = LDBooleanFalse;
+
+    if (!LDi_mutex_init(&delivery->lock)) {
+        return LDBooleanFalse;
+    }
+
+    if (!LDi_cond_init(&delivery->pushed)) {
+        LDi_mutex_destroy(&delivery->lock);
+
+        return LDBooleanFalse;
+    }
+
+    if (!LDi_cond_init(&delivery->done)) {
+        LDi_cond_destroy(&delivery->pushed);
+        LDi_mutex_destroy(&delivery->lock);
+
+        return LDBooleanFalse;
+    }
+
+    if (!LDi_cond_init(&delivery->closed)) {
+        LDi_cond_destroy(&delivery->done);
+        LDi_cond_destroy(&delivery->pushed);
+        LDi_mutex_destroy(&delivery->lock);
+
+        return LDBooleanFalse;
+    }
+
+    return LDBooleanTrue;
+}
+
+void
+LDi_deliveryDestroy(struct LDEventDelivery *const delivery)
+{
+    struct LDEventBatch *batch, *next;
+
+    LD_ASSERT(delivery);
+
+    for (batch = delivery->head; batch; batch = next) {
+        next = batch->next;
+
+        LDi_freeEventBatch(batch);
+    }
+
+    LDi_cond_destroy(&delivery->closed);
+    LDi_cond_destroy(&delivery->done);
+    LDi_cond_destroy(&delivery->pushed);
+    LDi_mutex_destroy(&delivery->lock);
+}
+
+void
+LDi_deliveryClose(struct LDEventDelivery *const delivery)
+{
+    LD_ASSERT(delivery);
+
+    LDi_mutex_lock(&delivery->lock);
+    delivery->closing = LDBooleanTrue;
+    LDi_cond_broadcast(&delivery->pushed);
+    LDi_cond_broadcast(&delivery->done);
+    LDi_cond_broadcast(&delivery->closed);
+    LDi_mutex_unlock(&delivery->lock);
+}
+
+static LDBoolean
+LDi_deliveryHasRoom(
+    const struct LDEventDelivery *const delivery, const size_t size)
+{
+    if (delivery->inFlight == 0) {
+        return LDBooleanTrue;
+    }
+
+    return delivery->inFlight < delivery->maxBatches &&
+        delivery->inFlightBytes + size <= delivery->maxBytes;
+}
+
+LDBoolean
+LDi_deliveryPush(
+    struct LDEventDelivery *const delivery,
+    struct LDEventBatch *const    batch,
+    const LDBoolean               wait)
+{
+    LD_ASSERT(delivery);
+    LD_ASSERT(batch);
+
+    LDi_mutex_lock(&delivery->lock);
+
+    while (!delivery->closing && !LDi_deliveryHasRoom(delivery, batch->size)) {
+        if (!wait) {
+            break;
+        }
+
+        LDi_cond_wait(&delivery->done, &delivery->lock, LD_COND_WAIT_FOREVER);
+    }
+
+    if (delivery->closing || !LDi_deliveryHasRoom(delivery, batch->size)) {
+        LDi_mutex_unlock(&delivery->lock);
+
+        return LDBooleanFalse;
+    }
+
+    batch->next = NULL;
+
+    if (delivery->tail) {
+        delivery->tail->next = batch;
+    } else {
+        delivery->head = batch;
+    }
+
+    delivery->tail = batch;
+    delivery->inFlight++;
+    delivery->inFlightBytes += batch->size;
+
+    LDi_cond_signal(&delivery->pushed);
+    LDi_mutex_unlock(&delivery->lock);
+
+    return LDBooleanTrue;
+}
+
+struct LDEventBatch *
+LDi_deliveryPop(struct LDEventDelivery *const delivery)
+{
+    struct LDEventBatch *batch;
+
+    LD_ASSERT(delivery);
+
+    LDi_mutex_lock(&delivery->lock);
+
+    while (!delivery->head && !delivery->closing) {
+        LDi_cond_wait(&delivery->pushed, &delivery->lock, LD_COND_WAIT_FOREVER);
+    }
+
+    if ((batch = delivery->head)) {
+        delivery->head = batch->next;
+
+        if (!delivery->head) {
+            delivery->tail = NULL;
+        }
+
+        batch->next = NULL;
+    }
+
+    LDi_mutex_unlock(&delivery->lock);
+
+    return batch;
+}
+
+void
+LDi_deliveryDone(
+    struct LDEventDelivery *const delivery,
+    struct LDEventBatch *const    batch,
+    const LDBoolean               delivered)
+{
+    LD_ASSERT(delivery);
+    LD_ASSERT(batch);
+
+    LDi_mutex_lock(&delivery->lock);
+
+    LD_ASSERT(delivery->inFlight > 0);
+    LD_ASSERT(delivery->inFlightBytes >= batch->size);
+
+    delivery->inFlight--;
+    delivery->inFlightBytes -= batch->size;
+    delivery->healthy = delivered;
+
+    LDi_cond_signal(&delivery->done);
+    LDi_mutex_unlock(&delivery->lock);
+}
+
+LDBoolean
+LDi_deliveryHealthy(struct LDEventDelivery *const delivery)
+{
+    LDBoolean healthy;
+
+    LD_ASSERT(delivery);
+
+    LDi_mutex_lock(&delivery->lock);
+    healthy = delivery->healthy;
+    LDi_mutex_unlock(&delivery->lock);
+
+    return healthy;
+}
+
+LDBoolean
+LDi_deliverySleep(
+    struct LDEventDelivery *const delivery, const unsigned int milliseconds)
+{
+    double    now, until;
+    LDBoolean closing;
+
+    LD_ASSERT(delivery);
+
+    LDi_getMonotonicMilliseconds(&now);
+
+    until = now + milliseconds;
+
+    LDi_mutex_lock(&delivery->lock);
+
+    while (!(closing = delivery->closing) && now < until) {
+        LDi_cond_wait(&delivery->closed, &delivery->lock, (int)(until - now));
+
+        LDi_getMonotonicMilliseconds(&now);
+    }
+
+    LDi_mutex_unlock(&delivery->lock);
+
+    return !closing;
+}
+
+unsigned int
+LDi_deliveryBackoff(const unsigned int attempt, const unsigned int maximum)
+{
+    unsigned int delay, rng;
+
+    LD_ASSERT(attempt > 0);
+
+    delay = 1000;
+
+    if (attempt - 1 < 16) {
+        delay <<= attempt - 1;
+    } else {
+        delay = maximum;
+    }
+
+    if (delay > maximum) {
+        delay = maximum;
+    }
+
+    if (!LDi_random(&rng)) {
+        return delay;
+    }
+
+    return delay / 2 + rng % (delay / 2 + 1);
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <stddef.h>
+
+#include <launchdarkly/boolean.h>
+
+#include "concurrency.h"
+#include "utility.h"
+
+/* Serialized payloads handed from the event thread to the delivery
+ * threads.
+ *
+ * A batch counts against the bounds from the moment it is pushed until the
+ * delivery thread that popped it marks it done, so the bounds cover both
+ * queued batches and batches being sent. A single batch larger than the
+ * byte bound is still accepted when nothing else is in flight. */
+
+struct LDEventBatch
+{
+    char *               payload;
+    size_t               size;
+    char                 payloadId[LD_UUID_SIZE + 1];
+    /* whether the payload is kept in the spool until it is delivered */
+    LDBoolean            spooled;
+    struct LDEventBatch *next;
+};
+
+struct LDEventDelivery
+{
+    ld_mutex_t           lock;
+    /* signaled when a batch is pushed */
+    ld_cond_t            pushed;
+    /* signaled when a batch is done */
+    ld_cond_t            done;
+    /* signaled when closing, wakes sleepers */
+    ld_cond_t            closed;
+    struct LDEventBatch *head;
+    struct LDEventBatch *tail;
+    unsigned int         inFlight;
+    size_t               inFlightBytes;
+    unsigned int         maxBatches;
+    size_t               maxBytes;
+    /* whether the most recent batch to finish was delivered */
+    LDBoolean            healthy;
+    LDBoolean            closing;
+};
+
+/* Takes ownership of payload. Returns NULL on failure, in which case the
+ * payload is freed. */
+struct LDEventBatch *
+LDi_newEventBatch(char *const payload, const char *const payloadId);
+
+void
+LDi_freeEventBatch(struct LDEventBatch *const batch);
+
+LDBoolean
+LDi_deliveryInitialize(
+    struct LDEventDelivery *const delivery,
+    const unsigned int            maxBatches,
+    const size_t                  maxBytes);
+
+/* Frees any batches still queued. */
+void
+LDi_deliveryDestroy(struct LDEventDelivery *const delivery);
+
+/* Stops accepting batches. Delivery threads pop the remaining batches and
+ * then exit. */
+void
+LDi_deliveryClose(struct LDEventDelivery *const delivery);
+
+/* Queues a batch, taking ownership of it, waiting for room when wait is
+ * true. Returns false without taking ownership if the batch does not fit
+ * or delivery is closing. */
+LDBoolean
+LDi_deliveryPush(
+    struct LDEventDelivery *const delivery,
+    struct LDEventBatch *const    batch,
+    const LDBoolean               wait);
+
+/* Waits for the oldest batch. Returns NULL once delivery is closing and no
+ * batches remain. */
+struct LDEventBatch *
+LDi_deliveryPop(struct LDEventDelivery *const delivery);
+
+/* Releases the room held by a popped batch, recording whether it was
+ * delivered. The caller keeps ownership of the batch. */
+void
+LDi_deliveryDone(
+    struct LDEventDelivery *const delivery,
+    struct LDEventBatch *const    batch,
+    const LDBoolean               delivered);
+
+LDBoolean
+LDi_deliveryHealthy(struct LDEventDelivery *const delivery);
+
+/* Sleeps for up to milliseconds. Returns false, possibly early, if delivery
+ * is closing. */
+LDBoolean
+LDi_deliverySleep(
+    struct LDEventDelivery *const delivery, const unsigned int milliseconds);
+
+/* Exponential backoff with jitter. Attempt one waits between a half and a
+ * whole second, each further attempt doubles that, up to maximum. */
+unsigned int
+LDi_deliveryBackoff(const unsigned int attempt, const unsigned int maximum);
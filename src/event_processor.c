@@ -1,8 +1,10 @@
 #include <stdio.h>
 #include <string.h>
 
+#include "eval_cache.h"
 #include "event_processor.h"
 #include "event_processor_internal.h"
+#include "json_writer.h"
 #include "ldinternal.h"
 #include "utility.h"
 
@@ -16,6 +18,54 @@ LDi_getFlagVersion(const struct LDFlag *const flag)
     return flag->version;
 }
 
+static LDBoolean
+LDi_newMetricAggregates(struct EventProcessor *const context)
+{
+    struct LDJSON *iter;
+    unsigned int   count;
+
+    count = LDCollectionGetSize(context->config->aggregatedMetrics);
+
+    if (count == 0) {
+        return LDBooleanTrue;
+    }
+
+    if (!(context->metrics = (struct LDMetricAggregate *)LDAlloc(
+              sizeof(struct LDMetricAggregate) * count)))
+    {
+        return LDBooleanFalse;
+    }
+
+    for (iter = LDGetIter(context->config->aggregatedMetrics); iter;
+         iter = LDIterNext(iter))
+    {
+        if (!LDi_metricInitialize(
+                &context->metrics[context->metricCount], LDIterKey(iter)))
+        {
+            return LDBooleanFalse;
+        }
+
+        context->metricCount++;
+    }
+
+    return LDBooleanTrue;
+}
+
+static struct LDMetricAggregate *
+LDi_lookupMetricAggregate(
+    struct EventProcessor *const context, const char *const key)
+{
+    unsigned int i;
+
+    for (i = 0; i < context->metricCount; i++) {
+        if (strcmp(context->metrics[i].key, key) == 0) {
+            return &context->metrics[i];
+        }
+    }
+
+    return NULL;
+}
+
 struct EventProcessor *
 LDi_newEventProcessor(const struct LDConfig *const config)
 {
@@ -27,14 +77,37 @@ LDi_newEventProcessor(const struct LDConfig *const config)
         goto error;
     }
 
+    context->events           = NULL;
+    context->summaryCounters  = NULL;
+    context->queue.cells      = NULL;
     context->summaryStart     = 0;
     context->lastUserKeyFlush = 0;
     context->lastServerTime   = 0;
     context->config           = config;
+    context->flushRequested   = 0;
+    context->flushSignal      = NULL;
+    context->popping          = 0;
+    context->offered          = 0;
+    context->dropped          = 0;
+    context->droppedTotal     = 0;
+    context->metrics          = NULL;
+    context->metricCount      = 0;
+
+    if (config->eventsHighWatermark) {
+        context->highWatermark = config->eventsHighWatermark;
+    } else {
+        context->highWatermark =
+            config->eventsCapacity - config->eventsCapacity / 4;
+    }
 
     LDi_getMonotonicMilliseconds(&context->lastUserKeyFlush);
+    LDi_mutex_init(&context->flushLock);
     LDi_mutex_init(&context->lock);
 
+    if (!LDi_eventQueueInitialize(&context->queue, config->eventsCapacity)) {
+        goto error;
+    }
+
     if (!(context->events = LDNewArray())) {
         goto error;
     }
@@ -43,6 +116,12 @@ LDi_newEventProcessor(const struct LDConfig *const config)
         goto error;
     }
 
+    if (config->aggregatedMetrics) {
+        if (!LDi_newMetricAggregates(context)) {
+            goto error;
+        }
+    }
+
     return context;
 
 error:
@@ -54,28 +133,160 @@ error:
 void
 LDi_freeEventProcessor(struct EventProcessor *const context)
 {
+    unsigned int i;
+
     if (context) {
+        for (i = 0; i < context->metricCount; i++) {
+            LDi_metricDestroy(&context->metrics[i]);
+        }
+
+        LDFree(context->metrics);
         LDi_mutex_destroy(&context->lock);
+        LDi_mutex_destroy(&context->flushLock);
+        LDi_eventQueueDestroy(&context->queue);
         LDJSONFree(context->events);
         LDJSONFree(context->summaryCounters);
         LDFree(context);
     }
 }
 
+void
+LDi_eventProcessorSetFlushSignal(
+    struct EventProcessor *const context, ld_cond_t *const signal)
+{
+    LD_ASSERT(context);
+    LD_ASSERT(signal);
+
+    context->flushSignal = signal;
+}
+
+LDBoolean
+LDi_eventProcessorFlushRequested(struct EventProcessor *const context)
+{
+    LD_ASSERT(context);
+
+    return LD_ATOMIC_LOAD_ULONG(&context->flushRequested) != 0;
+}
+
+unsigned long
+LDi_droppedEventCount(struct EventProcessor *const context)
+{
+    LD_ASSERT(context);
+
+    return LD_ATOMIC_LOAD_ULONG(&context->droppedTotal);
+}
+
+static void
+LDi_countDroppedEvent(struct EventProcessor *const context)
+{
+    LD_ATOMIC_INCREMENT_ULONG(&context->droppedTotal);
+
+    /* only the first drop of each flush interval is logged, the total is
+     * logged when the payload is bundled */
+    if (LD_ATOMIC_INCREMENT_ULONG(&context->dropped) == 1) {
+        LD_LOG(LD_LOG_WARNING, "event capacity exceeded, dropping events");
+    }
+}
+
+/* Takes the number of events dropped since the last call. */
+static unsigned long
+LDi_takeDroppedEvents(struct EventProcessor *const context)
+{
+    unsigned long dropped;
+
+    do {
+        dropped = LD_ATOMIC_LOAD_ULONG(&context->dropped);
+    } while (!LD_ATOMIC_CAS_ULONG(&context->dropped, dropped, 0));
+
+    return dropped;
+}
+
+/* Frees the oldest queued event, unless another thread is popping, such as
+ * a bundle in progress, which empties the queue anyway. Never waits. */
+static LDBoolean
+LDi_dropOldestEvent(struct EventProcessor *const context)
+{
+    struct LDJSON *event;
+
+    if (!LD_ATOMIC_CAS_ULONG(&context->popping, 0, 1)) {
+        return LDBooleanFalse;
+    }
+
+    event = LDi_eventQueuePop(&context->queue);
+    LD_ATOMIC_STORE_ULONG(&context->popping, 0);
+
+    if (event) {
+        LDJSONFree(event);
+
+        LDi_countDroppedEvent(context);
+    }
+
+    return event != NULL;
+}
+
+/* Decides whether an event offered to a full queue should displace the
+ * oldest event, with probability capacity / offered. The queue is FIFO so
+ * only the oldest event can be displaced. */
+static LDBoolean
+LDi_admitOverflowEvent(
+    struct EventProcessor *const context, const unsigned long offered)
+{
+    unsigned int rng;
+
+    if (!LDi_random(&rng)) {
+        return LDBooleanFalse;
+    }
+
+    return rng % offered < context->queue.capacity;
+}
+
 void
 LDi_addEvent(struct EventProcessor *const context, struct LDJSON *const event)
 {
+    unsigned long offered, depth;
+    LDBoolean     evict;
+
     LD_ASSERT(context);
     LD_ASSERT(event);
 
-    /* sanity check */
-    LD_ASSERT(LDJSONGetType(context->events) == LDArray);
+    offered = LD_ATOMIC_INCREMENT_ULONG(&context->offered);
+
+    while (!LDi_eventQueuePush(&context->queue, event)) {
+        switch (context->config->eventsOverflowPolicy) {
+        case LDEventsOverflowDropOldest:
+            evict = LDBooleanTrue;
+            break;
+        case LDEventsOverflowProbabilisticDropOldest:
+            evict = LDi_admitOverflowEvent(context, offered);
+            break;
+        default:
+            evict = LDBooleanFalse;
+            break;
+        }
 
-    if (LDCollectionGetSize(context->events) >= context->config->eventsCapacity)
+        /* an empty queue here has only unpublished cells left, and while
+         * another thread pops the newest event is dropped instead */
+        if (!evict || !LDi_dropOldestEvent(context)) {
+            LDJSONFree(event);
+
+            LDi_countDroppedEvent(context);
+
+            return;
+        }
+
+        /* only the first attempt is decided randomly */
+        offered = context->queue.capacity;
+    }
+
+    depth = LD_ATOMIC_LOAD_ULONG(&context->queue.tail) -
+        LD_ATOMIC_LOAD_ULONG(&context->queue.head);
+
+    if (depth >= context->highWatermark && context->flushSignal &&
+        LD_ATOMIC_CAS_ULONG(&context->flushRequested, 0, 1))
     {
-        LD_LOG(LD_LOG_WARNING, "event capacity exceeded, dropping event");
-    } else {
-        LDArrayPush(context->events, event);
+        LD_LOG(LD_LOG_TRACE, "event buffer reached high watermark");
+
+        LDi_cond_signal(context->flushSignal);
     }
 }
 
@@ -255,12 +466,8 @@ LDi_identify(
         return LDBooleanFalse;
     }
 
-    LDi_mutex_lock(&context->lock);
-
     LDi_addEvent(context, event);
 
-    LDi_mutex_unlock(&context->lock);
-
     return LDBooleanTrue;
 }
 
@@ -431,30 +638,48 @@ LDi_track(
     const double                 metric,
     const LDBoolean              hasMetric)
 {
-    struct LDJSON *event;
-    double         now;
+    struct LDJSON *           event;
+    struct LDMetricAggregate *aggregate;
+    double                    now;
 
     LD_ASSERT(context);
     LD_ASSERT(user);
 
     LDi_getUnixMilliseconds(&now);
 
-    LDi_mutex_lock(&context->lock);
+    if (hasMetric && (aggregate = LDi_lookupMetricAggregate(context, key))) {
+        /* only the first sample of an interval builds the event */
+        if (LDi_metricNeedsEvent(aggregate)) {
+            if (!(event = LDi_newCustomEvent(
+                      context, user, key, NULL, 0, LDBooleanFalse, now)))
+            {
+                LD_LOG(LD_LOG_ERROR, "failed to construct custom event");
+
+                LDJSONFree(data);
+
+                return LDBooleanFalse;
+            }
+
+            LDi_metricSetEvent(aggregate, event);
+        }
+
+        LDi_metricAdd(aggregate, metric);
+
+        LDJSONFree(data);
+
+        return LDBooleanTrue;
+    }
 
     if (!(event = LDi_newCustomEvent(
               context, user, key, data, metric, hasMetric, now)))
     {
         LD_LOG(LD_LOG_ERROR, "failed to construct custom event");
 
-        LDi_mutex_unlock(&context->lock);
-
         return LDBooleanFalse;
     }
 
     LDi_addEvent(context, event);
 
-    LDi_mutex_unlock(&context->lock);
-
     return LDBooleanTrue;
 }
 
@@ -473,25 +698,19 @@ LDi_alias(
 
     LDi_getUnixMilliseconds(&now);
 
-    LDi_mutex_lock(&context->lock);
-
     if (!(event = LDi_newAliasEvent(currentUser, previousUser, now))) {
         LD_LOG(LD_LOG_ERROR, "failed to construct alias event");
 
-        LDi_mutex_unlock(&context->lock);
-
         return LDBooleanFalse;
     }
 
     LDi_addEvent(context, event);
 
-    LDi_mutex_unlock(&context->lock);
-
     return LDBooleanTrue;
 }
 
 struct LDJSON *
-LDi_objectToArray(const struct LDJSON *const object)
+LDi_objectToArray(struct LDJSON *const object)
 {
     struct LDJSON *iter, *array;
 
@@ -504,37 +723,31 @@ LDi_objectToArray(const struct LDJSON *const object)
     if (!(array = LDNewArray())) {
         LD_LOG(LD_LOG_ERROR, "alloc error");
 
+        LDJSONFree(object);
+
         return NULL;
     }
 
-    for (iter = LDGetIter(object); iter; iter = LDIterNext(iter)) {
-        struct LDJSON *dupe;
-
-        if (!(dupe = LDJSONDuplicate(iter))) {
-            LD_LOG(LD_LOG_ERROR, "alloc error");
-
-            LDJSONFree(array);
-
-            return NULL;
-        }
-
-        LDArrayPush(array, dupe);
+    while ((iter = LDGetIter(object))) {
+        LDArrayPush(array, LDCollectionDetachIter(object, iter));
     }
 
+    LDJSONFree(object);
+
     return array;
 }
 
 struct LDJSON *
-LDi_prepareSummaryEvent(struct EventProcessor *const context, const double now)
+LDi_prepareSummaryEvent(
+    struct LDJSON *const counters, const double start, const double now)
 {
-    struct LDJSON *tmp, *summary, *iter, *counters;
+    struct LDJSON *tmp, *summary, *iter;
 
-    LD_ASSERT(context);
+    LD_ASSERT(counters);
 
-    tmp      = NULL;
-    summary  = NULL;
-    iter     = NULL;
-    counters = NULL;
+    tmp     = NULL;
+    summary = NULL;
+    iter    = NULL;
 
     if (!(summary = LDNewObject())) {
         LD_LOG(LD_LOG_ERROR, "alloc error");
@@ -556,7 +769,7 @@ LDi_prepareSummaryEvent(struct EventProcessor *const context, const double now)
         goto error;
     }
 
-    if (!(tmp = LDNewNumber(context->summaryStart))) {
+    if (!(tmp = LDNewNumber(start))) {
         LD_LOG(LD_LOG_ERROR, "alloc error");
 
         goto error;
@@ -584,12 +797,7 @@ LDi_prepareSummaryEvent(struct EventProcessor *const context, const double now)
         goto error;
     }
 
-    if (!(counters = LDJSONDuplicate(context->summaryCounters))) {
-        LD_LOG(LD_LOG_ERROR, "alloc error");
-
-        goto error;
-    }
-
+    /* the counters are owned, so are converted in place */
     for (iter = LDGetIter(counters); iter; iter = LDIterNext(iter)) {
         struct LDJSON *countersObject, *countersArray;
 
@@ -599,13 +807,9 @@ LDi_prepareSummaryEvent(struct EventProcessor *const context, const double now)
         if (!(countersArray = LDi_objectToArray(countersObject))) {
             LD_LOG(LD_LOG_ERROR, "alloc error");
 
-            LDJSONFree(countersObject);
-
             goto error;
         }
 
-        LDJSONFree(countersObject);
-
         if (!LDObjectSetKey(iter, "counters", countersArray)) {
             LD_LOG(LD_LOG_ERROR, "alloc error");
 
@@ -630,80 +834,427 @@ error:
     return NULL;
 }
 
+static LDBoolean
+LDi_setNumber(
+    struct LDJSON *const object, const char *const key, const double value)
+{
+    struct LDJSON *tmp;
+
+    if (!(tmp = LDNewNumber(value))) {
+        return LDBooleanFalse;
+    }
+
+    if (!LDObjectSetKey(object, key, tmp)) {
+        LDJSONFree(tmp);
+
+        return LDBooleanFalse;
+    }
+
+    return LDBooleanTrue;
+}
+
+/* Completes the event of each aggregated metric tracked since the last
+ * bundle, and resets the aggregates. Called with flushLock held. */
+static unsigned int
+LDi_bundleMetricEvents(struct EventProcessor *const context)
+{
+    struct LDMetricTotals totals;
+    struct LDJSON *       event, *data;
+    unsigned int          i, count;
+
+    count = 0;
+
+    for (i = 0; i < context->metricCount; i++) {
+        LDi_metricTake(&context->metrics[i], &totals, &event);
+
+        if (!event) {
+            continue;
+        }
+
+        /* the event may be installed just before its first sample */
+        if (totals.count == 0) {
+            LDi_metricSetEvent(&context->metrics[i], event);
+
+            continue;
+        }
+
+        if (!(data = LDNewObject()) ||
+            !LDi_setNumber(data, "count", totals.count) ||
+            !LDi_setNumber(data, "sum", totals.sum) ||
+            !LDi_setNumber(data, "min", totals.min) ||
+            !LDi_setNumber(data, "max", totals.max) ||
+            !LDObjectSetKey(event, "data", data))
+        {
+            LD_LOG(LD_LOG_ERROR, "alloc error");
+
+            LDJSONFree(data);
+            LDJSONFree(event);
+
+            continue;
+        }
+
+        if (!LDi_setNumber(event, "metricValue", totals.sum / totals.count)) {
+            LD_LOG(LD_LOG_ERROR, "alloc error");
+
+            LDJSONFree(event);
+
+            continue;
+        }
+
+        LDArrayPush(context->events, event);
+
+        count++;
+    }
+
+    return count;
+}
+
 LDBoolean
 LDi_bundleEventPayload(
     struct EventProcessor *const context, struct LDJSON **const result)
 {
-    struct LDJSON *nextEvents, *nextSummaryCounters, *summaryEvent;
-    double         now;
+    struct LDJSON *nextEvents, *nextSummaryCounters, *summaryCounters,
+        *summaryEvent, *event;
+    double        now, summaryStart;
+    unsigned      size;
+    unsigned long dropped;
 
     LD_ASSERT(context);
     LD_ASSERT(result);
 
-    nextEvents          = NULL;
-    nextSummaryCounters = NULL;
-    *result             = NULL;
-    summaryEvent        = NULL;
+    *result = NULL;
 
     LDi_getUnixMilliseconds(&now);
 
+    LDi_evalCacheFlush(context);
+
+    /* allocated up front so that the swap below cannot fail */
+    nextEvents          = LDNewArray();
+    nextSummaryCounters = LDNewObject();
+
+    if (!nextEvents || !nextSummaryCounters) {
+        LD_LOG(LD_LOG_ERROR, "alloc error");
+
+        LDJSONFree(nextEvents);
+        LDJSONFree(nextSummaryCounters);
+
+        return LDBooleanFalse;
+    }
+
+    LDi_mutex_lock(&context->flushLock);
+
+    /* later events may request another flush, and are admitted afresh */
+    LD_ATOMIC_STORE_ULONG(&context->flushRequested, 0);
+    LD_ATOMIC_STORE_ULONG(&context->offered, 0);
+
+    size = LDCollectionGetSize(context->events);
+
+    /* a producer holds the token only for a single pop */
+    while (!LD_ATOMIC_CAS_ULONG(&context->popping, 0, 1)) {
+        LDi_sleepMilliseconds(0);
+    }
+
+    while ((event = LDi_eventQueuePop(&context->queue))) {
+        /* a failed flush may have left events behind */
+        if (size >= context->config->eventsCapacity) {
+            LDJSONFree(event);
+
+            LDi_countDroppedEvent(context);
+
+            continue;
+        }
+
+        LDArrayPush(context->events, event);
+
+        size++;
+    }
+
+    LD_ATOMIC_STORE_ULONG(&context->popping, 0);
+
+    size += LDi_bundleMetricEvents(context);
+
+    /* the only work done under the summary lock is a swap */
     LDi_mutex_lock(&context->lock);
 
-    if (LDCollectionGetSize(context->events) == 0 &&
-        LDCollectionGetSize(context->summaryCounters) == 0)
-    {
-        LDi_mutex_unlock(&context->lock);
+    summaryStart    = context->summaryStart;
+    summaryCounters = NULL;
+
+    if (summaryStart != 0) {
+        summaryCounters          = context->summaryCounters;
+        context->summaryCounters = nextSummaryCounters;
+        context->summaryStart    = 0;
+        nextSummaryCounters      = NULL;
+    }
+
+    LDi_mutex_unlock(&context->lock);
+
+    if ((dropped = LDi_takeDroppedEvents(context))) {
+        LD_LOG_1(LD_LOG_WARNING, "dropped %lu events since the last flush",
+            dropped);
+    }
+
+    LDJSONFree(nextSummaryCounters);
+
+    if (size == 0 && summaryCounters == NULL) {
+        LDi_mutex_unlock(&context->flushLock);
+
+        LDJSONFree(nextEvents);
 
         /* succesful but no events to send */
 
         return LDBooleanTrue;
     }
 
-    if (!(nextEvents = LDNewArray())) {
-        LD_LOG(LD_LOG_ERROR, "alloc error");
+    if (summaryCounters) {
+        if (!(summaryEvent = LDi_prepareSummaryEvent(
+                  summaryCounters, summaryStart, now)))
+        {
+            LD_LOG(LD_LOG_ERROR, "failed to prepare summary");
 
-        LDi_mutex_unlock(&context->lock);
+            LDi_mutex_unlock(&context->flushLock);
+
+            LDJSONFree(nextEvents);
+
+            return LDBooleanFalse;
+        }
+
+        LDArrayPush(context->events, summaryEvent);
+    }
+
+    *result = context->events;
+
+    context->events = nextEvents;
+
+    LDi_mutex_unlock(&context->flushLock);
+
+    return LDBooleanTrue;
+}
+
+/* Returns the key of the user inlined in an event, or NULL if it has none. */
+static const char *
+LDi_inlinedUserKey(const struct LDJSON *const event)
+{
+    const struct LDJSON *user, *key;
+
+    if (LDJSONGetType(event) != LDObject) {
+        return NULL;
+    }
+
+    if (!(user = LDObjectLookup(event, "user")) ||
+        LDJSONGetType(user) != LDObject)
+    {
+        return NULL;
+    }
+
+    if (!(key = LDObjectLookup(user, "key")) || LDJSONGetType(key) != LDText) {
+        return NULL;
+    }
+
+    return LDGetText(key);
+}
+
+static LDBoolean
+LDi_isIdentifyEvent(const struct LDJSON *const event)
+{
+    const struct LDJSON *kind;
+
+    kind = LDObjectLookup(event, "kind");
 
+    return kind && LDJSONGetType(kind) == LDText &&
+        strcmp(LDGetText(kind), "identify") == 0;
+}
+
+static LDBoolean
+LDi_writeMember(
+    struct LDJSONWriter *const writer,
+    const char *const          key,
+    const struct LDJSON *const value)
+{
+    return LDi_writerWriteString(writer, key) &&
+        LDi_writerAppend(writer, ":", 1) &&
+        LDi_writerWriteValue(writer, value);
+}
+
+/* Writes an index event carrying the user inlined in event. */
+static LDBoolean
+LDi_writeIndexEvent(
+    struct LDJSONWriter *const writer, const struct LDJSON *const event)
+{
+    const struct LDJSON *creationDate;
+
+    if (!LDi_writerAppend(writer, "{\"kind\":\"index\",", 16)) {
         return LDBooleanFalse;
     }
 
-    if (context->summaryStart != 0) {
-        if (!(nextSummaryCounters = LDNewObject())) {
-            LD_LOG(LD_LOG_ERROR, "alloc error");
+    if ((creationDate = LDObjectLookup(event, "creationDate"))) {
+        if (!LDi_writeMember(writer, "creationDate", creationDate) ||
+            !LDi_writerAppend(writer, ",", 1))
+        {
+            return LDBooleanFalse;
+        }
+    }
 
-            LDi_mutex_unlock(&context->lock);
+    return LDi_writeMember(writer, "user", LDObjectLookup(event, "user")) &&
+        LDi_writerAppend(writer, "}", 1);
+}
 
-            LDJSONFree(nextEvents);
+/* Writes an event with its inlined user replaced by the user's key. */
+static LDBoolean
+LDi_writeEventWithUserKey(
+    struct LDJSONWriter *const writer,
+    const struct LDJSON *const event,
+    const char *const          userKey)
+{
+    const struct LDJSON *iter;
+
+    if (!LDi_writerAppend(writer, "{", 1)) {
+        return LDBooleanFalse;
+    }
 
+    for (iter = LDGetIter(event); iter; iter = LDIterNext(iter)) {
+        if (iter != LDGetIter(event) && !LDi_writerAppend(writer, ",", 1)) {
             return LDBooleanFalse;
         }
 
-        if (!(summaryEvent = LDi_prepareSummaryEvent(context, now))) {
-            LD_LOG(LD_LOG_ERROR, "failed to prepare summary");
+        if (strcmp(LDIterKey(iter), "user") == 0) {
+            if (!LDi_writerWriteString(writer, "userKey") ||
+                !LDi_writerAppend(writer, ":", 1) ||
+                !LDi_writerWriteString(writer, userKey))
+            {
+                return LDBooleanFalse;
+            }
+        } else if (!LDi_writeMember(writer, LDIterKey(iter), iter)) {
+            return LDBooleanFalse;
+        }
+    }
 
-            LDi_mutex_unlock(&context->lock);
+    return LDi_writerAppend(writer, "}", 1);
+}
 
-            LDJSONFree(nextEvents);
-            LDJSONFree(nextSummaryCounters);
+/* Writes an event, referring to its inlined user by key once the user is
+ * in indexed, and otherwise writing an index event for it first. Sets added
+ * to the key when the user is newly indexed. Identify events carry the
+ * user themselves and are written unchanged. */
+static LDBoolean
+LDi_writeEventIndexingUser(
+    struct LDJSONWriter *const writer,
+    struct LDJSON *const       indexed,
+    const struct LDJSON *const event,
+    const char **const         added)
+{
+    const char *   userKey;
+    struct LDJSON *tmp;
+
+    *added = NULL;
+
+    if (!(userKey = LDi_inlinedUserKey(event))) {
+        return LDi_writerWriteValue(writer, event);
+    }
 
+    if (!LDObjectLookup(indexed, userKey)) {
+        if (!(tmp = LDNewBool(LDBooleanTrue))) {
             return LDBooleanFalse;
         }
 
-        LDArrayPush(context->events, summaryEvent);
+        if (!LDObjectSetKey(indexed, userKey, tmp)) {
+            LDJSONFree(tmp);
 
-        LDJSONFree(context->summaryCounters);
+            return LDBooleanFalse;
+        }
 
-        context->summaryStart    = 0;
-        context->summaryCounters = nextSummaryCounters;
+        *added = userKey;
+
+        if (LDi_isIdentifyEvent(event)) {
+            return LDi_writerWriteValue(writer, event);
+        }
+
+        if (!LDi_writeIndexEvent(writer, event) ||
+            !LDi_writerAppend(writer, ",", 1))
+        {
+            return LDBooleanFalse;
+        }
+    } else if (LDi_isIdentifyEvent(event)) {
+        return LDi_writerWriteValue(writer, event);
     }
 
-    *result = context->events;
+    return LDi_writeEventWithUserKey(writer, event, userKey);
+}
 
-    context->events = nextEvents;
+char *
+LDi_serializeEventBatch(
+    struct LDJSON **const iter,
+    const size_t          maxBytes,
+    const LDBoolean       deduplicateUsers)
+{
+    struct LDJSONWriter writer;
+    struct LDJSON *     indexed;
+    const char *        added;
+    size_t              mark;
+    unsigned int        count;
 
-    LDi_mutex_unlock(&context->lock);
+    LD_ASSERT(iter);
+    LD_ASSERT(*iter);
 
-    return LDBooleanTrue;
+    count   = 0;
+    indexed = NULL;
+    added   = NULL;
+
+    LDi_writerInitialize(&writer);
+
+    /* users are indexed per batch, so that each request stands alone */
+    if (deduplicateUsers && !(indexed = LDNewObject())) {
+        goto error;
+    }
+
+    if (!LDi_writerAppend(&writer, "[", 1)) {
+        goto error;
+    }
+
+    for (; *iter; *iter = LDIterNext(*iter)) {
+        mark = writer.length;
+
+        if (count && !LDi_writerAppend(&writer, ",", 1)) {
+            goto error;
+        }
+
+        if (indexed) {
+            if (!LDi_writeEventIndexingUser(&writer, indexed, *iter, &added)) {
+                goto error;
+            }
+        } else if (!LDi_writerWriteValue(&writer, *iter)) {
+            goto error;
+        }
+
+        /* the event that overflows is written again as the start of the
+         * next batch, leaving room for the closing bracket */
+        if (maxBytes && count && writer.length + 1 > maxBytes) {
+            writer.length = mark;
+
+            if (added) {
+                LDObjectDeleteKey(indexed, added);
+            }
+
+            break;
+        }
+
+        count++;
+    }
+
+    if (!LDi_writerAppend(&writer, "]", 1)) {
+        goto error;
+    }
+
+    LDJSONFree(indexed);
+
+    return LDi_writerTake(&writer);
+
+error:
+    LD_LOG(LD_LOG_ERROR, "failed to serialize event batch");
+
+    LDJSONFree(indexed);
+    LDi_writerDestroy(&writer);
+
+    return NULL;
 }
 
 struct LDJSON *
@@ -875,6 +1426,20 @@ LDi_summarizeEvent(
     const LDJSONType                variationType,
     const void *const               fallbackValue,
     const void *const               actualValue)
+{
+    return LDi_summarizeEvents(
+        context, flagKey, node, variationType, fallbackValue, actualValue, 1);
+}
+
+LDBoolean
+LDi_summarizeEvents(
+    struct EventProcessor *const    context,
+    const char *const               flagKey,
+    const struct LDStoreNode *const node,
+    const LDJSONType                variationType,
+    const void *const               fallbackValue,
+    const void *const               actualValue,
+    const unsigned long             count)
 {
     int            status;
     char           keyText[128];
@@ -979,7 +1544,7 @@ LDi_summarizeEvent(
             goto cleanup;
         }
 
-        if (!(tmp = LDNewNumber(1))) {
+        if (!(tmp = LDNewNumber(count))) {
             LD_LOG(LD_LOG_ERROR, "alloc error");
 
             LDJSONFree(entry);
@@ -1072,7 +1637,7 @@ LDi_summarizeEvent(
         LDBoolean status;
         tmp = LDObjectLookup(entry, "count");
         LD_ASSERT(tmp);
-        status = LDSetNumber(tmp, LDGetNumber(tmp) + 1);
+        status = LDSetNumber(tmp, LDGetNumber(tmp) + count);
         LD_ASSERT(status);
     }
 
@@ -1138,20 +1703,18 @@ LDi_processEvalEvent(
     if (!LDi_summarizeEvent(
             context, flagKey, node, valueType, fallback, actualValue))
     {
-        LDi_addEvent(context, featureEvent);
+        LDi_mutex_unlock(&context->lock);
 
         LDJSONFree(featureEvent);
 
-        LDi_mutex_unlock(&context->lock);
-
         return LDBooleanFalse;
     }
 
+    LDi_mutex_unlock(&context->lock);
+
     if (featureEvent) {
         LDi_addEvent(context, featureEvent);
     }
 
-    LDi_mutex_unlock(&context->lock);
-
     return LDBooleanTrue;
 }
@@ -3,6 +3,7 @@
 #include <launchdarkly/api.h>
 #include <launchdarkly/json.h>
 
+#include "concurrency.h"
 #include "store.h"
 
 struct EventProcessor;
@@ -13,6 +14,23 @@ LDi_newEventProcessor(const struct LDConfig *const config);
 void
 LDi_freeEventProcessor(struct EventProcessor *const context);
 
+/* The condition signaled when the buffer reaches the high watermark. It is
+ * signaled without a lock, so that producers never wait, and a flusher must
+ * wait with a timeout in case the signal arrives just before it waits. */
+void
+LDi_eventProcessorSetFlushSignal(
+    struct EventProcessor *const context, ld_cond_t *const signal);
+
+/* Whether the high watermark was reached since the last bundle started. A
+ * flusher checks this before waiting, so that a signal sent while it was
+ * busy is not lost. */
+LDBoolean
+LDi_eventProcessorFlushRequested(struct EventProcessor *const context);
+
+/* Total number of events dropped by the overflow policy. */
+unsigned long
+LDi_droppedEventCount(struct EventProcessor *const context);
+
 LDBoolean
 LDi_identify(
     struct EventProcessor *const context, const struct LDUser *const user);
@@ -36,6 +54,18 @@ LDBoolean
 LDi_bundleEventPayload(
     struct EventProcessor *const context, struct LDJSON **const result);
 
+/* Serializes events from iter onward as a JSON array of at most maxBytes,
+ * or unbounded when maxBytes is zero, and advances iter past them. An event
+ * larger than maxBytes by itself is serialized alone. When deduplicateUsers
+ * is true, inlined users are written once per batch in an index event, and
+ * referred to by key elsewhere in the batch. The result must be released
+ * with LDFree. */
+char *
+LDi_serializeEventBatch(
+    struct LDJSON **const iter,
+    const size_t          maxBytes,
+    const LDBoolean       deduplicateUsers);
+
 LDBoolean
 LDi_processEvalEvent(
     struct EventProcessor *const    context,
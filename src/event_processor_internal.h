@@ -6,18 +6,47 @@
 
 #include "concurrency.h"
 #include "event_processor.h"
+#include "event_queue.h"
+#include "metric_aggregate.h"
 
 struct EventProcessor
 {
-    ld_mutex_t             lock;
+    /* Events are built without a lock and pushed to the queue. */
+    struct LDEventQueue    queue;
+    /* Depth of the queue that requests an early flush, a value above the
+     * capacity never does. */
+    unsigned long          highWatermark;
+    /* Set once per flush when the watermark is crossed, so the sender is
+     * signaled only once. Not owned, may be NULL. */
+    unsigned long          flushRequested;
+    ld_cond_t *            flushSignal;
+    /* Atomic token held by the single consumer of the queue, a bundle or a
+     * producer evicting the oldest event. Producers never wait for it. */
+    unsigned long          popping;
+    /* Atomic counters. Events offered and dropped since the last bundle,
+     * and dropped over the life of the processor. */
+    unsigned long          offered;
+    unsigned long          dropped;
+    unsigned long          droppedTotal;
+    /* Serializes bundling. Guards events. Ordered before lock. */
+    ld_mutex_t             flushLock;
     struct LDJSON *        events;          /* Array of Objects */
+    /* Guards the summary, which bundling swaps for an empty one so that
+     * evaluations never wait while a payload is prepared. */
+    ld_mutex_t             lock;
     struct LDJSON *        summaryCounters; /* Object */
     double                 summaryStart;
+    /* One per key in LDConfigAddAggregatedMetric, fixed after creation. */
+    struct LDMetricAggregate *metrics;
+    unsigned int           metricCount;
     double                 lastUserKeyFlush;
     double                 lastServerTime;
     const struct LDConfig *config;
 };
 
+/* Queues an event, taking ownership of it. Does not need the lock. When the
+ * queue is full the configured overflow policy decides which event is
+ * dropped. */
 void
 LDi_addEvent(struct EventProcessor *const context, struct LDJSON *const event);
 
@@ -52,11 +81,15 @@ LDi_newAliasEvent(
     const struct LDUser *const previousUser,
     const double               now);
 
+/* Moves the values of an object into a new array, consuming the object. */
 struct LDJSON *
-LDi_objectToArray(const struct LDJSON *const object);
+LDi_objectToArray(struct LDJSON *const object);
 
+/* Builds a summary event from counters detached from the processor, taking
+ * ownership of them. */
 struct LDJSON *
-LDi_prepareSummaryEvent(struct EventProcessor *const context, const double now);
+LDi_prepareSummaryEvent(
+    struct LDJSON *const counters, const double start, const double now);
 
 struct LDJSON *
 LDi_valueToJSON(const void *const value, const LDJSONType valueType);
@@ -81,3 +114,15 @@ LDi_summarizeEvent(
     const LDJSONType                variationType,
     const void *const               fallbackValue,
     const void *const               actualValue);
+
+/* Counts several identical evaluations at once. Called with the context
+ * lock held. */
+LDBoolean
+LDi_summarizeEvents(
+    struct EventProcessor *const    context,
+    const char *const               flagKey,
+    const struct LDStoreNode *const node,
+    const LDJSONType                variationType,
+    const void *const               fallbackValue,
+    const void *const               actualValue,
+    const unsigned long             count);
@@ -0,0 +1,130 @@
+#include <launchdarkly/memory.h>
+
+#include "assertion.h"
+#include "concurrency.h"
+#include "event_queue.h"
+
+LDBoolean
+LDi_eventQueueInitialize(
+    struct LDEventQueue *const queue, const unsigned int capacity)
+{
+    unsigned long i, cellCount;
+
+    LD_ASSERT(queue);
+
+    /* a queue without capacity still has one cell so that every position
+     * maps to memory, it is never claimed */
+    for (cellCount = 1; cellCount < capacity; cellCount <<= 1) {
+        if (cellCount > (unsigned long)-1 / 2) {
+            return LDBooleanFalse;
+        }
+    }
+
+    queue->capacity = capacity;
+    queue->mask     = cellCount - 1;
+    queue->tail     = 0;
+    queue->head     = 0;
+
+    if (!(queue->cells = LDAlloc(sizeof(struct LDEventQueueCell) * cellCount)))
+    {
+        return LDBooleanFalse;
+    }
+
+    for (i = 0; i < cellCount; i++) {
+        queue->cells[i].sequence = capacity ? i : 1;
+        queue->cells[i].event    = NULL;
+    }
+
+    return LDBooleanTrue;
+}
+
+void
+LDi_eventQueueDestroy(struct LDEventQueue *const queue)
+{
+    struct LDJSON *event;
+
+    if (queue && queue->cells) {
+        while ((event = LDi_eventQueuePop(queue))) {
+            LDJSONFree(event);
+        }
+
+        LDFree(queue->cells);
+
+        queue->cells = NULL;
+    }
+}
+
+LDBoolean
+LDi_eventQueuePush(
+    struct LDEventQueue *const queue, struct LDJSON *const event)
+{
+    struct LDEventQueueCell *cell;
+    unsigned long            position;
+    long                     distance;
+
+    LD_ASSERT(queue);
+    LD_ASSERT(event);
+
+    if (queue->capacity == 0) {
+        return LDBooleanFalse;
+    }
+
+    position = LD_ATOMIC_LOAD_ULONG(&queue->tail);
+
+    for (;;) {
+        /* differences of positions are exact across wrap around */
+        if (position - LD_ATOMIC_LOAD_ULONG(&queue->head) >= queue->capacity) {
+            return LDBooleanFalse;
+        }
+
+        cell     = &queue->cells[position & queue->mask];
+        distance = (long)(LD_ATOMIC_LOAD_ULONG(&cell->sequence) - position);
+
+        if (distance == 0) {
+            if (LD_ATOMIC_CAS_ULONG(&queue->tail, position, position + 1)) {
+                break;
+            }
+        } else if (distance < 0) {
+            /* the consumer has not yet freed this cell from the last lap */
+            return LDBooleanFalse;
+        }
+
+        position = LD_ATOMIC_LOAD_ULONG(&queue->tail);
+    }
+
+    cell->event = event;
+
+    LD_ATOMIC_STORE_ULONG(&cell->sequence, position + 1);
+
+    return LDBooleanTrue;
+}
+
+struct LDJSON *
+LDi_eventQueuePop(struct LDEventQueue *const queue)
+{
+    struct LDEventQueueCell *cell;
+    struct LDJSON *          event;
+    unsigned long            position;
+
+    LD_ASSERT(queue);
+
+    if (queue->capacity == 0) {
+        return NULL;
+    }
+
+    position = queue->head;
+    cell     = &queue->cells[position & queue->mask];
+
+    /* claimed but not yet published cells end the queue */
+    if ((long)(LD_ATOMIC_LOAD_ULONG(&cell->sequence) - (position + 1)) < 0) {
+        return NULL;
+    }
+
+    event       = cell->event;
+    cell->event = NULL;
+
+    LD_ATOMIC_STORE_ULONG(&cell->sequence, position + queue->mask + 1);
+    LD_ATOMIC_STORE_ULONG(&queue->head, position + 1);
+
+    return event;
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <launchdarkly/boolean.h>
+#include <launchdarkly/json.h>
+
+/* Bounded multi-producer single-consumer queue of events.
+ *
+ * Producers claim a cell with a compare and swap on the tail, then publish
+ * the event by advancing the sequence number of the cell, so pushing never
+ * blocks and never takes a lock. Each cell is reused once the consumer has
+ * advanced its sequence by a full lap. Pops must be serialized by the
+ * caller.
+ *
+ * Positions wrap around, on platforms where unsigned long is 32 bits after
+ * 2^32 events, so the number of cells is a power of two and a position is
+ * mapped to its cell with a mask. The capacity is enforced separately
+ * against the head, so that it is exact. */
+
+struct LDEventQueueCell
+{
+    unsigned long  sequence;
+    struct LDJSON *event;
+};
+
+struct LDEventQueue
+{
+    struct LDEventQueueCell *cells;
+    unsigned long            capacity;
+    /* the number of cells less one */
+    unsigned long            mask;
+    /* next position to claim, written by producers */
+    unsigned long            tail;
+    /* next position to pop, written only by the consumer */
+    unsigned long            head;
+};
+
+LDBoolean
+LDi_eventQueueInitialize(
+    struct LDEventQueue *const queue, const unsigned int capacity);
+
+/* Frees any events still queued. */
+void
+LDi_eventQueueDestroy(struct LDEventQueue *const queue);
+
+/* Takes ownership of event, unless the queue is full in which case false is
+ * returned and the caller keeps ownership. */
+LDBoolean
+LDi_eventQueuePush(
+    struct LDEventQueue *const queue, struct LDJSON *const event);
+
+/* Returns the oldest published event, or NULL if there is none. */
+struct LDJSON *
+LDi_eventQueuePop(struct LDEventQueue *const queue);
@@ -0,0 +1,654 @@
+#include <stdio.h>
+#include <string.h>
+
+#include <launchdarkly/memory.h>
+
+#include "assertion.h"
+#include "concurrency.h"
+#include "event_spool.h"
+#include "logging.h"
+
+#define LD_SPOOL_MAGIC "LDSPOOL1"
+
+/* the magic followed by two 20 digit offsets, each preceded by a space, and
+ * a newline */
+#define LD_SPOOL_HEADER_SIZE (sizeof(LD_SPOOL_MAGIC) - 1 + 21 + 21 + 1)
+
+/* large enough for a payload id, a length, and separators */
+#define LD_SPOOL_RECORD_HEADER_SIZE (LD_UUID_SIZE + 32)
+
+/* the separator after the payload id records whether it was delivered */
+#define LD_SPOOL_PENDING ' '
+#define LD_SPOOL_DELIVERED '!'
+
+struct LDSpoolInFlight
+{
+    char                    payloadId[LD_UUID_SIZE + 1];
+    struct LDSpoolInFlight *next;
+};
+
+struct LDEventSpool
+{
+    ld_mutex_t    lock;
+    FILE *        file;
+    size_t        maxBytes;
+    /* offset of the oldest record */
+    unsigned long head;
+    /* offset one past the newest record */
+    unsigned long end;
+    /* records before this offset are delivered or in flight, not persisted
+     * so that a restart replays everything not yet delivered */
+    unsigned long cursor;
+    /* payload ids handed out and not yet delivered or retried */
+    struct LDSpoolInFlight *inFlight;
+};
+
+static LDBoolean
+LDi_spoolWriteHeader(struct LDEventSpool *const spool)
+{
+    if (fseek(spool->file, 0, SEEK_SET) != 0) {
+        return LDBooleanFalse;
+    }
+
+    if (fprintf(
+            spool->file,
+            "%s %020lu %020lu\n",
+            LD_SPOOL_MAGIC,
+            spool->head,
+            spool->end) != (int)LD_SPOOL_HEADER_SIZE)
+    {
+        return LDBooleanFalse;
+    }
+
+    return fflush(spool->file) == 0;
+}
+
+static LDBoolean
+LDi_spoolReadHeader(struct LDEventSpool *const spool)
+{
+    char          header[LD_SPOOL_HEADER_SIZE + 1];
+    long          size;
+    unsigned long head, end;
+
+    if (fseek(spool->file, 0, SEEK_END) != 0) {
+        return LDBooleanFalse;
+    }
+
+    if ((size = ftell(spool->file)) < (long)LD_SPOOL_HEADER_SIZE) {
+        return LDBooleanFalse;
+    }
+
+    if (fseek(spool->file, 0, SEEK_SET) != 0) {
+        return LDBooleanFalse;
+    }
+
+    if (fread(header, 1, LD_SPOOL_HEADER_SIZE, spool->file) !=
+        LD_SPOOL_HEADER_SIZE)
+    {
+        return LDBooleanFalse;
+    }
+
+    header[LD_SPOOL_HEADER_SIZE] = 0;
+
+    if (memcmp(header, LD_SPOOL_MAGIC, sizeof(LD_SPOOL_MAGIC) - 1) != 0) {
+        return LDBooleanFalse;
+    }
+
+    if (sscanf(header + sizeof(LD_SPOOL_MAGIC) - 1, "%lu %lu", &head, &end) !=
+        2)
+    {
+        return LDBooleanFalse;
+    }
+
+    if (head < LD_SPOOL_HEADER_SIZE || head > end ||
+        end > (unsigned long)size)
+    {
+        return LDBooleanFalse;
+    }
+
+    spool->head   = head;
+    spool->end    = end;
+    spool->cursor = head;
+
+    return LDBooleanTrue;
+}
+
+/* Discards every record. */
+static LDBoolean
+LDi_spoolReset(struct LDEventSpool *const spool)
+{
+    spool->head   = LD_SPOOL_HEADER_SIZE;
+    spool->end    = LD_SPOOL_HEADER_SIZE;
+    spool->cursor = LD_SPOOL_HEADER_SIZE;
+
+    return LDi_spoolWriteHeader(spool);
+}
+
+/* Reads the header of the record at offset, leaving the file positioned at
+ * the payload. */
+static LDBoolean
+LDi_spoolReadRecordHeader(
+    struct LDEventSpool *const spool,
+    const unsigned long        offset,
+    char *const                payloadId,
+    unsigned long *const       length,
+    unsigned long *const       next,
+    LDBoolean *const           delivered)
+{
+    char   line[LD_SPOOL_RECORD_HEADER_SIZE];
+    size_t lineLength;
+
+    if (fseek(spool->file, (long)offset, SEEK_SET) != 0) {
+        return LDBooleanFalse;
+    }
+
+    if (!fgets(line, sizeof(line), spool->file)) {
+        return LDBooleanFalse;
+    }
+
+    lineLength = strlen(line);
+
+    if (lineLength <= LD_UUID_SIZE + 1 || line[lineLength - 1] != '\n' ||
+        (line[LD_UUID_SIZE] != LD_SPOOL_PENDING &&
+         line[LD_UUID_SIZE] != LD_SPOOL_DELIVERED))
+    {
+        return LDBooleanFalse;
+    }
+
+    *delivered = line[LD_UUID_SIZE] == LD_SPOOL_DELIVERED;
+
+    if (sscanf(line + LD_UUID_SIZE + 1, "%lu", length) != 1) {
+        return LDBooleanFalse;
+    }
+
+    memcpy(payloadId, line, LD_UUID_SIZE);
+    payloadId[LD_UUID_SIZE] = 0;
+
+    *next = offset + lineLength + *length + 1;
+
+    /* also rejects lengths that overflow */
+    return *next <= spool->end && *next > offset + lineLength;
+}
+
+/* Moves the records to the start of the file. */
+static LDBoolean
+LDi_spoolCompact(struct LDEventSpool *const spool)
+{
+    char          buffer[4096];
+    unsigned long moved, live;
+    size_t        chunk;
+
+    live = spool->end - spool->head;
+
+    for (moved = 0; moved < live; moved += chunk) {
+        chunk = live - moved < sizeof(buffer) ? live - moved : sizeof(buffer);
+
+        if (fseek(spool->file, (long)(spool->head + moved), SEEK_SET) != 0 ||
+            fread(buffer, 1, chunk, spool->file) != chunk)
+        {
+            return LDBooleanFalse;
+        }
+
+        if (fseek(spool->file, (long)(LD_SPOOL_HEADER_SIZE + moved), SEEK_SET) !=
+                0 ||
+            fwrite(buffer, 1, chunk, spool->file) != chunk)
+        {
+            return LDBooleanFalse;
+        }
+    }
+
+    spool->cursor -= spool->head - LD_SPOOL_HEADER_SIZE;
+    spool->head = LD_SPOOL_HEADER_SIZE;
+    spool->end  = LD_SPOOL_HEADER_SIZE + live;
+
+    return fflush(spool->file) == 0 && LDi_spoolWriteHeader(spool);
+}
+
+struct LDEventSpool *
+LDi_eventSpoolOpen(const char *const path, const size_t maxBytes)
+{
+    struct LDEventSpool *spool;
+
+    LD_ASSERT(path);
+
+    if (!(spool = LDAlloc(sizeof(struct LDEventSpool)))) {
+        return NULL;
+    }
+
+    spool->maxBytes = maxBytes;
+    spool->head     = LD_SPOOL_HEADER_SIZE;
+    spool->end      = LD_SPOOL_HEADER_SIZE;
+    spool->cursor   = LD_SPOOL_HEADER_SIZE;
+    spool->inFlight = NULL;
+
+    LDi_mutex_init(&spool->lock);
+
+    if ((spool->file = fopen(path, "r+b"))) {
+        if (LDi_spoolReadHeader(spool)) {
+            return spool;
+        }
+
+        LD_LOG(LD_LOG_WARNING, "event spool unreadable, discarding it");
+
+        fclose(spool->file);
+    }
+
+    if (!(spool->file = fopen(path, "w+b"))) {
+        LD_LOG_1(LD_LOG_ERROR, "failed to open event spool %s", path);
+
+        LDi_mutex_destroy(&spool->lock);
+        LDFree(spool);
+
+        return NULL;
+    }
+
+    if (!LDi_spoolReset(spool)) {
+        LD_LOG(LD_LOG_ERROR, "failed to initialize event spool");
+
+        LDi_eventSpoolClose(spool);
+
+        return NULL;
+    }
+
+    return spool;
+}
+
+void
+LDi_eventSpoolClose(struct LDEventSpool *const spool)
+{
+    struct LDSpoolInFlight *inFlight, *next;
+
+    if (spool) {
+        for (inFlight = spool->inFlight; inFlight; inFlight = next) {
+            next = inFlight->next;
+
+            LDFree(inFlight);
+        }
+
+        fclose(spool->file);
+        LDi_mutex_destroy(&spool->lock);
+        LDFree(spool);
+    }
+}
+
+LDBoolean
+LDi_eventSpoolIsEmpty(struct LDEventSpool *const spool)
+{
+    LDBoolean empty;
+
+    LD_ASSERT(spool);
+
+    LDi_mutex_lock(&spool->lock);
+    empty = spool->head == spool->end;
+    LDi_mutex_unlock(&spool->lock);
+
+    return empty;
+}
+
+static LDBoolean
+LDi_spoolRemoveOldest(struct LDEventSpool *const spool);
+
+static LDBoolean
+LDi_spoolAppend(
+    struct LDEventSpool *const spool,
+    const char *const          payloadId,
+    const char *const          payload)
+{
+    char          header[LD_SPOOL_RECORD_HEADER_SIZE];
+    unsigned long length, recordSize;
+    int           headerLength;
+
+    length = strlen(payload);
+
+    headerLength =
+        snprintf(header, sizeof(header), "%s %lu\n", payloadId, length);
+
+    if (headerLength < 0 || (size_t)headerLength >= sizeof(header)) {
+        return LDBooleanFalse;
+    }
+
+    recordSize = headerLength + length + 1;
+
+    if (LD_SPOOL_HEADER_SIZE + recordSize > spool->maxBytes) {
+        LD_LOG(LD_LOG_WARNING, "event payload exceeds spool size, dropping it");
+
+        return LDBooleanFalse;
+    }
+
+    while (LD_SPOOL_HEADER_SIZE + spool->end - spool->head + recordSize >
+           spool->maxBytes)
+    {
+        LD_LOG(LD_LOG_WARNING, "event spool full, dropping oldest payload");
+
+        if (!LDi_spoolRemoveOldest(spool)) {
+            return LDBooleanFalse;
+        }
+    }
+
+    if (spool->end + recordSize > spool->maxBytes) {
+        if (!LDi_spoolCompact(spool)) {
+            LD_LOG(LD_LOG_ERROR, "failed to compact event spool");
+
+            LDi_spoolReset(spool);
+
+            return LDBooleanFalse;
+        }
+    }
+
+    if (fseek(spool->file, (long)spool->end, SEEK_SET) != 0 ||
+        fwrite(header, 1, headerLength, spool->file) != (size_t)headerLength ||
+        fwrite(payload, 1, length, spool->file) != length ||
+        fputc('\n', spool->file) == EOF || fflush(spool->file) != 0)
+    {
+        LD_LOG(LD_LOG_ERROR, "failed to write event spool");
+
+        return LDBooleanFalse;
+    }
+
+    /* the record is only published once it is completely written */
+    spool->end += recordSize;
+
+    return LDi_spoolWriteHeader(spool);
+}
+
+/* Drops the oldest record, delivered or not, to make room. */
+static LDBoolean
+LDi_spoolRemoveOldest(struct LDEventSpool *const spool)
+{
+    char          payloadId[LD_UUID_SIZE + 1];
+    unsigned long length, next;
+    LDBoolean     delivered;
+
+    if (spool->head == spool->end) {
+        return LDBooleanFalse;
+    }
+
+    if (!LDi_spoolReadRecordHeader(
+            spool, spool->head, payloadId, &length, &next, &delivered))
+    {
+        LD_LOG(LD_LOG_WARNING, "event spool corrupt, discarding it");
+
+        LDi_spoolReset(spool);
+
+        return LDBooleanTrue;
+    }
+
+    if (next == spool->end) {
+        return LDi_spoolReset(spool);
+    }
+
+    spool->head = next;
+
+    if (spool->cursor < spool->head) {
+        spool->cursor = spool->head;
+    }
+
+    return LDi_spoolWriteHeader(spool);
+}
+
+/* Releases the delivered records at the head of the spool. */
+static LDBoolean
+LDi_spoolReleaseDelivered(struct LDEventSpool *const spool)
+{
+    char          payloadId[LD_UUID_SIZE + 1];
+    unsigned long length, next, head;
+    LDBoolean     delivered;
+
+    head = spool->head;
+
+    while (head != spool->end) {
+        if (!LDi_spoolReadRecordHeader(
+                spool, head, payloadId, &length, &next, &delivered))
+        {
+            return LDBooleanFalse;
+        }
+
+        if (!delivered) {
+            break;
+        }
+
+        head = next;
+    }
+
+    if (head == spool->head) {
+        return LDBooleanTrue;
+    }
+
+    if (head == spool->end) {
+        return LDi_spoolReset(spool);
+    }
+
+    spool->head = head;
+
+    if (spool->cursor < spool->head) {
+        spool->cursor = spool->head;
+    }
+
+    return LDi_spoolWriteHeader(spool);
+}
+
+/* Finds the offset of the record with payloadId. */
+static LDBoolean
+LDi_spoolFind(
+    struct LDEventSpool *const spool,
+    const char *const          payloadId,
+    unsigned long *const       offset)
+{
+    char          recordId[LD_UUID_SIZE + 1];
+    unsigned long length, next, current;
+    LDBoolean     delivered;
+
+    for (current = spool->head; current != spool->end; current = next) {
+        if (!LDi_spoolReadRecordHeader(
+                spool, current, recordId, &length, &next, &delivered))
+        {
+            return LDBooleanFalse;
+        }
+
+        if (strcmp(recordId, payloadId) == 0) {
+            *offset = current;
+
+            return LDBooleanTrue;
+        }
+    }
+
+    return LDBooleanFalse;
+}
+
+static LDBoolean
+LDi_spoolIsInFlight(
+    const struct LDEventSpool *const spool, const char *const payloadId)
+{
+    const struct LDSpoolInFlight *inFlight;
+
+    for (inFlight = spool->inFlight; inFlight; inFlight = inFlight->next) {
+        if (strcmp(inFlight->payloadId, payloadId) == 0) {
+            return LDBooleanTrue;
+        }
+    }
+
+    return LDBooleanFalse;
+}
+
+static void
+LDi_spoolForgetInFlight(
+    struct LDEventSpool *const spool, const char *const payloadId)
+{
+    struct LDSpoolInFlight **link, *inFlight;
+
+    for (link = &spool->inFlight; (inFlight = *link); link = &inFlight->next) {
+        if (strcmp(inFlight->payloadId, payloadId) == 0) {
+            *link = inFlight->next;
+
+            LDFree(inFlight);
+
+            return;
+        }
+    }
+}
+
+static LDBoolean
+LDi_spoolNext(
+    struct LDEventSpool *const spool,
+    char *const                payloadId,
+    char **const               payload)
+{
+    struct LDSpoolInFlight *inFlight;
+    unsigned long           length, next;
+    LDBoolean               delivered;
+
+    *payload = NULL;
+
+    if (spool->cursor < spool->head) {
+        spool->cursor = spool->head;
+    }
+
+    for (; spool->cursor != spool->end; spool->cursor = next) {
+        if (!LDi_spoolReadRecordHeader(
+                spool, spool->cursor, payloadId, &length, &next, &delivered))
+        {
+            LD_LOG(LD_LOG_WARNING, "event spool corrupt, discarding it");
+
+            LDi_spoolReset(spool);
+
+            return LDBooleanFalse;
+        }
+
+        if (!delivered && !LDi_spoolIsInFlight(spool, payloadId)) {
+            break;
+        }
+    }
+
+    if (spool->cursor == spool->end) {
+        return LDBooleanFalse;
+    }
+
+    if (!(inFlight = LDAlloc(sizeof(struct LDSpoolInFlight)))) {
+        return LDBooleanFalse;
+    }
+
+    if (!(*payload = LDAlloc(length + 1))) {
+        LDFree(inFlight);
+
+        return LDBooleanFalse;
+    }
+
+    if (fread(*payload, 1, length, spool->file) != length) {
+        LD_LOG(LD_LOG_ERROR, "failed to read event spool");
+
+        LDFree(inFlight);
+        LDFree(*payload);
+        *payload = NULL;
+
+        return LDBooleanFalse;
+    }
+
+    (*payload)[length] = 0;
+
+    memcpy(inFlight->payloadId, payloadId, LD_UUID_SIZE + 1);
+    inFlight->next  = spool->inFlight;
+    spool->inFlight = inFlight;
+    spool->cursor   = next;
+
+    return LDBooleanTrue;
+}
+
+static LDBoolean
+LDi_spoolMarkDelivered(
+    struct LDEventSpool *const spool, const char *const payloadId)
+{
+    unsigned long offset;
+
+    /* the record may have been dropped to make room */
+    if (!LDi_spoolFind(spool, payloadId, &offset)) {
+        return LDBooleanTrue;
+    }
+
+    if (fseek(spool->file, (long)(offset + LD_UUID_SIZE), SEEK_SET) != 0 ||
+        fputc(LD_SPOOL_DELIVERED, spool->file) == EOF ||
+        fflush(spool->file) != 0)
+    {
+        LD_LOG(LD_LOG_ERROR, "failed to write event spool");
+
+        return LDBooleanFalse;
+    }
+
+    return LDi_spoolReleaseDelivered(spool);
+}
+
+LDBoolean
+LDi_eventSpoolAppend(
+    struct LDEventSpool *const spool,
+    const char *const          payloadId,
+    const char *const          payload)
+{
+    LDBoolean appended;
+
+    LD_ASSERT(spool);
+    LD_ASSERT(payloadId);
+    LD_ASSERT(strlen(payloadId) == LD_UUID_SIZE);
+    LD_ASSERT(payload);
+
+    LDi_mutex_lock(&spool->lock);
+    appended = LDi_spoolAppend(spool, payloadId, payload);
+    LDi_mutex_unlock(&spool->lock);
+
+    return appended;
+}
+
+LDBoolean
+LDi_eventSpoolNext(
+    struct LDEventSpool *const spool,
+    char *const                payloadId,
+    char **const               payload)
+{
+    LDBoolean found;
+
+    LD_ASSERT(spool);
+    LD_ASSERT(payloadId);
+    LD_ASSERT(payload);
+
+    LDi_mutex_lock(&spool->lock);
+    found = LDi_spoolNext(spool, payloadId, payload);
+    LDi_mutex_unlock(&spool->lock);
+
+    return found;
+}
+
+LDBoolean
+LDi_eventSpoolDelivered(
+    struct LDEventSpool *const spool, const char *const payloadId)
+{
+    LDBoolean marked;
+
+    LD_ASSERT(spool);
+    LD_ASSERT(payloadId);
+
+    LDi_mutex_lock(&spool->lock);
+    LDi_spoolForgetInFlight(spool, payloadId);
+    marked = LDi_spoolMarkDelivered(spool, payloadId);
+    LDi_mutex_unlock(&spool->lock);
+
+    return marked;
+}
+
+void
+LDi_eventSpoolRetry(
+    struct LDEventSpool *const spool, const char *const payloadId)
+{
+    unsigned long offset;
+
+    LD_ASSERT(spool);
+    LD_ASSERT(payloadId);
+
+    LDi_mutex_lock(&spool->lock);
+
+    LDi_spoolForgetInFlight(spool, payloadId);
+
+    /* the record is read again from where it was, ahead of newer records */
+    if (LDi_spoolFind(spool, payloadId, &offset) && offset < spool->cursor) {
+        spool->cursor = offset;
+    }
+
+    LDi_mutex_unlock(&spool->lock);
+}
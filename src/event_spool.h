@@ -0,0 +1,66 @@
+#pragma once
+
+#include <stddef.h>
+
+#include <launchdarkly/boolean.h>
+
+#include "utility.h"
+
+/* Append-only file of serialized event payloads awaiting delivery.
+ *
+ * The file starts with a fixed width header holding the offsets of the
+ * oldest record and of the end of the records, followed by records of the
+ * form "<payload id> <length>\n<payload>\n". Records are appended, the
+ * header is rewritten to publish them, and a record stays on disk until it
+ * is delivered, so a crash while it is in flight replays it. A delivered
+ * record is marked by rewriting the separator after its payload id to '!',
+ * and delivered records at the head are released by advancing the head.
+ * When a payload would not fit within the size bound the oldest records are
+ * dropped, and the remaining records are moved to the start of the file, so
+ * the file never grows beyond the bound. A record that cannot be parsed,
+ * for instance after a crash while moving records, discards the spool.
+ *
+ * Payloads keep the identifier they were first sent with, so the events
+ * service can deduplicate a batch that is replayed after a delivery it did
+ * receive. Operations on a spool are serialized by its own lock. */
+
+struct LDEventSpool;
+
+/* Opens or creates the spool at path. A spool that cannot be read is
+ * started afresh. Returns NULL on failure. */
+struct LDEventSpool *
+LDi_eventSpoolOpen(const char *const path, const size_t maxBytes);
+
+void
+LDi_eventSpoolClose(struct LDEventSpool *const spool);
+
+LDBoolean
+LDi_eventSpoolIsEmpty(struct LDEventSpool *const spool);
+
+/* Returns false if the payload was not spooled, either because of an I/O
+ * error or because it is larger than the bound by itself. */
+LDBoolean
+LDi_eventSpoolAppend(
+    struct LDEventSpool *const spool,
+    const char *const          payloadId,
+    const char *const          payload);
+
+/* Reads the oldest record that is neither delivered nor in flight, and
+ * marks it in flight. The payload is allocated and must be freed by the
+ * caller. Returns false when there is no such record. */
+LDBoolean
+LDi_eventSpoolNext(
+    struct LDEventSpool *const spool,
+    char *const                payloadId,
+    char **const               payload);
+
+/* Marks an in flight record delivered, releasing it from the file. */
+LDBoolean
+LDi_eventSpoolDelivered(
+    struct LDEventSpool *const spool, const char *const payloadId);
+
+/* Returns an in flight record that was not delivered. It is read again by
+ * LDi_eventSpoolNext before any newer record. */
+void
+LDi_eventSpoolRetry(
+    struct LDEventSpool *const spool, const char *const payloadId);
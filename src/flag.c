@@ -1,3 +1,5 @@
+#include <string.h>
+
 #include <launchdarkly/memory.h>
 
 #include "assertion.h"
@@ -291,3 +293,180 @@ LDi_flag_destroy(struct LDFlag *const flag)
         LDJSONFree(flag->reason);
     }
 }
+
+/* Indexed by LDReasonKind, up to LDReasonKindUnknown */
+static const char *const LDi_reasonKindNames[] = {
+    NULL,
+    "OFF",
+    "FALLTHROUGH",
+    "TARGET_MATCH",
+    "RULE_MATCH",
+    "PREREQUISITE_FAILED",
+    "ERROR"
+};
+
+/* Indexed by LDReasonErrorKind, up to LDReasonErrorUnknown */
+static const char *const LDi_reasonErrorNames[] = {
+    NULL,
+    "CLIENT_NOT_READY",
+    "CLIENT_NOT_SPECIFIED",
+    "FLAG_NOT_SPECIFIED",
+    "FLAG_NOT_FOUND",
+    "WRONG_TYPE",
+    "MALFORMED_FLAG",
+    "EXCEPTION"
+};
+
+#define LD_ARRAY_LENGTH(array) (sizeof(array) / sizeof((array)[0]))
+
+static unsigned int
+LDi_reasonLookupName(
+    const char *const *const names, const unsigned int count,
+    const struct LDJSON *const name, const unsigned int unknown)
+{
+    unsigned int i;
+
+    if (!name || LDJSONGetType(name) != LDText) {
+        return unknown;
+    }
+
+    for (i = 1; i < count; i++) {
+        if (strcmp(names[i], LDGetText(name)) == 0) {
+            return i;
+        }
+    }
+
+    return unknown;
+}
+
+void
+LDi_reasonDecode(
+    const struct LDJSON *const reason, LDEvaluationReason *const result)
+{
+    const struct LDJSON *tmp;
+
+    LD_ASSERT(result);
+
+    result->kind            = LDReasonKindNone;
+    result->errorKind       = LDReasonErrorNone;
+    result->ruleIndex       = -1;
+    result->ruleId          = NULL;
+    result->prerequisiteKey = NULL;
+    result->inExperiment    = LDBooleanFalse;
+
+    if (!reason || LDJSONGetType(reason) != LDObject) {
+        return;
+    }
+
+    result->kind = (LDReasonKind)LDi_reasonLookupName(
+        LDi_reasonKindNames,
+        LD_ARRAY_LENGTH(LDi_reasonKindNames),
+        LDObjectLookup(reason, "kind"),
+        LDReasonKindUnknown);
+
+    if (result->kind == LDReasonKindError) {
+        result->errorKind = (LDReasonErrorKind)LDi_reasonLookupName(
+            LDi_reasonErrorNames,
+            LD_ARRAY_LENGTH(LDi_reasonErrorNames),
+            LDObjectLookup(reason, "errorKind"),
+            LDReasonErrorUnknown);
+    }
+
+    if ((tmp = LDObjectLookup(reason, "ruleIndex")) &&
+        LDJSONGetType(tmp) == LDNumber)
+    {
+        result->ruleIndex = (int)LDGetNumber(tmp);
+    }
+
+    if ((tmp = LDObjectLookup(reason, "ruleId")) &&
+        LDJSONGetType(tmp) == LDText)
+    {
+        result->ruleId = LDGetText(tmp);
+    }
+
+    if ((tmp = LDObjectLookup(reason, "prerequisiteKey")) &&
+        LDJSONGetType(tmp) == LDText)
+    {
+        result->prerequisiteKey = LDGetText(tmp);
+    }
+
+    if ((tmp = LDObjectLookup(reason, "inExperiment")) &&
+        LDJSONGetType(tmp) == LDBool)
+    {
+        result->inExperiment = LDGetBool(tmp);
+    }
+}
+
+void
+LDi_reasonError(
+    LDEvaluationReason *const result, const LDReasonErrorKind errorKind)
+{
+    LDi_reasonDecode(NULL, result);
+
+    result->kind      = LDReasonKindError;
+    result->errorKind = errorKind;
+}
+
+struct LDJSON *
+LDi_reasonToJSON(const LDEvaluationReason *const reason)
+{
+    struct LDJSON *result;
+
+    LD_ASSERT(reason);
+
+    if (reason->kind == LDReasonKindNone || reason->kind == LDReasonKindUnknown)
+    {
+        return NULL;
+    }
+
+    if (!(result = LDNewObject())) {
+        return NULL;
+    }
+
+    if (!LDObjectSetKey(
+            result, "kind", LDNewText(LDi_reasonKindNames[reason->kind])))
+    {
+        goto error;
+    }
+
+    if (reason->kind == LDReasonKindError &&
+        reason->errorKind != LDReasonErrorNone &&
+        reason->errorKind != LDReasonErrorUnknown &&
+        !LDObjectSetKey(result, "errorKind",
+            LDNewText(LDi_reasonErrorNames[reason->errorKind])))
+    {
+        goto error;
+    }
+
+    if (reason->ruleIndex >= 0 &&
+        !LDObjectSetKey(result, "ruleIndex", LDNewNumber(reason->ruleIndex)))
+    {
+        goto error;
+    }
+
+    if (reason->ruleId &&
+        !LDObjectSetKey(result, "ruleId", LDNewText(reason->ruleId)))
+    {
+        goto error;
+    }
+
+    if (reason->prerequisiteKey &&
+        !LDObjectSetKey(
+            result, "prerequisiteKey", LDNewText(reason->prerequisiteKey)))
+    {
+        goto error;
+    }
+
+    if (reason->inExperiment &&
+        !LDObjectSetKey(result, "inExperiment", LDNewBool(LDBooleanTrue)))
+    {
+        goto error;
+    }
+
+    return result;
+
+error:
+    LDJSONFree(result);
+
+    return NULL;
+}
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <launchdarkly/boolean.h>
+#include <launchdarkly/client.h>
 #include <launchdarkly/json.h>
 
 struct LDFlag
@@ -28,3 +29,17 @@ LDi_flag_to_json(struct LDFlag *const flag);
 
 void
 LDi_flag_destroy(struct LDFlag *const flag);
+
+/* Decodes a reason object. Strings in the result point into reason, which
+ * may be NULL. */
+void
+LDi_reasonDecode(
+    const struct LDJSON *const reason, LDEvaluationReason *const result);
+
+/* Sets a reason of kind ERROR. */
+void
+LDi_reasonError(
+    LDEvaluationReason *const result, const LDReasonErrorKind errorKind);
+
+struct LDJSON *
+LDi_reasonToJSON(const LDEvaluationReason *const reason);
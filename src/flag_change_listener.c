@@ -1,29 +1,40 @@
 #include "flag_change_listener.h"
-#include "utlist.h"
+#include "uthash.h"
+#include <launchdarkly/logging.h>
 #include <launchdarkly/memory.h>
 
 #include <string.h>
 
+/* A single registration. Exactly one of the callbacks is set. */
+struct ListenerCallback {
+    LDlistenerfn callback;
+    LDFlagChangeListener changeCallback;
+    /* Passed to changeCallback. */
+    void *context;
+};
+
 struct ChangeListener {
     /* Owned flag key; must be freed. */
     char *flag;
-    /* User-provided callback. */
-    LDlistenerfn callback;
-    /* Used by utlist.h macros. */
-    struct ChangeListener *next;
+    /* Callbacks for the flag in registration order. */
+    struct ListenerCallback *callbacks;
+    unsigned int count;
+    unsigned int capacity;
+    /* Used by uthash.h macros, keyed by flag. */
+    UT_hash_handle hh;
 };
 
 static struct ChangeListener *
-newListener(const char* flag, LDlistenerfn callback) {
+newListener(const char* flag) {
     struct ChangeListener *listener = NULL;
 
     if (!(listener = LDAlloc(sizeof(struct ChangeListener)))) {
-        return LDBooleanFalse;
+        return NULL;
     }
 
-    listener->callback = callback;
-    listener->flag = NULL;
-    listener->next = NULL;
+    listener->callbacks = NULL;
+    listener->count = 0;
+    listener->capacity = 0;
 
     if (!(listener->flag = LDStrDup(flag))) {
         LDFree(listener);
@@ -35,35 +46,20 @@ newListener(const char* flag, LDlistenerfn callback) {
 
 static void
 freeListener(struct ChangeListener *listener) {
+    LDFree(listener->callbacks);
     LDFree(listener->flag);
     LDFree(listener);
 }
 
-/* Used by the utlist's LL_SEARCH macro to locate a ChangeListener. */
-static int
-flagcmp(struct ChangeListener *a, struct ChangeListener *b) {
-
-    /* If the listeners have different flags, return that. */
-    int cmp = strcmp(a->flag, b->flag);
-    if (cmp != 0) {
-        return cmp;
-    }
-
-    /* If the listeners have the same flag & callback, they are equal. */
-    if (a->callback == b->callback) {
-        return 0;
-    }
-
-    /* Otherwise, sort by the callback address to provide something stable.*/
-    if ((unsigned long) a->callback > (unsigned long) b->callback) {
-        return 1;
-    }
-    return -1;
+static LDBoolean
+callbackMatches(const struct ListenerCallback *const a, const struct ListenerCallback *const b) {
+    return a->callback == b->callback && a->changeCallback == b->changeCallback &&
+        a->context == b->context;
 }
 
 void
 LDi_initListeners(struct ChangeListener** listeners) {
-    /* Setting the list head to NULL is utlist's only requirement for operation. */
+    /* Setting the hash head to NULL is uthash's only requirement for operation. */
     *listeners = NULL;
 }
 
@@ -74,66 +70,214 @@ LDi_freeListeners(struct ChangeListener** listeners) {
     tmp = NULL;
     listener = NULL;
 
-    if (*listeners) {
-        LL_FOREACH_SAFE(*listeners, listener, tmp) {
-            LL_DELETE(*listeners, listener);
-            freeListener(listener);
+    HASH_ITER(hh, *listeners, listener, tmp) {
+        HASH_DEL(*listeners, listener);
+        freeListener(listener);
+    }
+
+    *listeners = NULL;
+}
+
+static LDBoolean
+addListener(struct ChangeListener** listeners, const char* flag, const struct ListenerCallback *const added) {
+    struct ChangeListener *listener;
+    unsigned int i;
+
+    listener = NULL;
+
+    HASH_FIND_STR(*listeners, flag, listener);
+
+    if (listener) {
+        /* Ensure uniqueness of (flag, function pointer, context) combo. */
+        for (i = 0; i < listener->count; i++) {
+            if (callbackMatches(&listener->callbacks[i], added)) {
+                return LDBooleanTrue;
+            }
+        }
+    } else {
+        if (!(listener = newListener(flag))) {
+            return LDBooleanFalse;
         }
-        *listeners = NULL;
+
+        HASH_ADD_KEYPTR(hh, *listeners, listener->flag, strlen(listener->flag), listener);
     }
+
+    if (listener->count == listener->capacity) {
+        struct ListenerCallback *callbacks;
+        const unsigned int capacity = listener->capacity ? listener->capacity * 2 : 2;
+
+        if (!(callbacks = LDRealloc(listener->callbacks, sizeof(struct ListenerCallback) * capacity))) {
+            if (listener->count == 0) {
+                HASH_DEL(*listeners, listener);
+                freeListener(listener);
+            }
+
+            return LDBooleanFalse;
+        }
+
+        listener->callbacks = callbacks;
+        listener->capacity = capacity;
+    }
+
+    listener->callbacks[listener->count++] = *added;
+
+    return LDBooleanTrue;
 }
 
 LDBoolean
 LDi_listenerAdd(struct ChangeListener** listeners, const char* flag, LDlistenerfn callback) {
-    struct ChangeListener *new, *existing;
+    struct ListenerCallback added;
+
+    added.callback = callback;
+    added.changeCallback = NULL;
+    added.context = NULL;
+
+    return addListener(listeners, flag, &added);
+}
 
-    new = NULL;
-    existing = NULL;
+LDBoolean
+LDi_listenerAddChange(struct ChangeListener** listeners, const char* flag, LDFlagChangeListener callback,
+    void *context) {
+    struct ListenerCallback added;
+
+    added.callback = NULL;
+    added.changeCallback = callback;
+    added.context = context;
+
+    return addListener(listeners, flag, &added);
+}
+
+static void
+removeListener(struct ChangeListener** listeners, const char* flag, const struct ListenerCallback *const removed) {
+    struct ChangeListener *listener;
+    unsigned int i;
 
-    if (!(new = newListener(flag, callback))) {
-        return LDBooleanFalse;
+    listener = NULL;
+
+    HASH_FIND_STR(*listeners, flag, listener);
+
+    if (!listener) {
+        return;
     }
 
-    LL_SEARCH(*listeners, existing, new, flagcmp);
+    for (i = 0; i < listener->count; i++) {
+        if (callbackMatches(&listener->callbacks[i], removed)) {
+            memmove(&listener->callbacks[i], &listener->callbacks[i + 1],
+                sizeof(struct ListenerCallback) * (listener->count - i - 1));
 
-    /* Ensure uniqueness of (flag, function pointer) combo. */
-    if (existing) {
-        freeListener(new);
-        return LDBooleanTrue;
+            listener->count--;
+
+            break; /* early out, since addListener disallows duplicates */
+        }
     }
 
-    LL_PREPEND(*listeners, new);
-    return LDBooleanTrue;
+    if (listener->count == 0) {
+        HASH_DEL(*listeners, listener);
+        freeListener(listener);
+    }
 }
 
 void
 LDi_listenerRemove(struct ChangeListener** listeners, const char* flag, LDlistenerfn callback) {
-    struct ChangeListener *tmp, *listener;
+    struct ListenerCallback removed;
+
+    removed.callback = callback;
+    removed.changeCallback = NULL;
+    removed.context = NULL;
+
+    removeListener(listeners, flag, &removed);
+}
+
+void
+LDi_listenerRemoveChange(struct ChangeListener** listeners, const char* flag, LDFlagChangeListener callback,
+    void *context) {
+    struct ListenerCallback removed;
+
+    removed.callback = NULL;
+    removed.changeCallback = callback;
+    removed.context = context;
+
+    removeListener(listeners, flag, &removed);
+}
+
+LDBoolean
+LDi_listenersContain(struct ChangeListener* listeners, const char *flag) {
+    struct ChangeListener *listener;
 
-    tmp = NULL;
     listener = NULL;
 
-    LL_FOREACH_SAFE(*listeners, listener, tmp) {
-        if (strcmp(listener->flag, flag) == 0 && listener->callback == callback) {
-            LL_DELETE(*listeners, listener);
-            freeListener(listener);
+    HASH_FIND_STR(listeners, flag, listener);
 
-            break; /* early out, since listenerInsert disallows duplicates */
-        }
-    }
+    return listener != NULL;
 }
 
+struct ListenerCallbacks {
+    struct ListenerCallback *callbacks;
+    unsigned int count;
+};
 
-void
-LDi_listenersDispatch(struct ChangeListener* listeners, const char *flag, LDBoolean status) {
-    struct ChangeListener *tmp, *listener;
+struct ListenerCallbacks *
+LDi_listenersCopy(struct ChangeListener* listeners, const char *flag) {
+    struct ChangeListener *listener;
+    struct ListenerCallbacks *copy;
 
-    tmp = NULL;
     listener = NULL;
 
-    LL_FOREACH_SAFE(listeners, listener, tmp) {
-        if (strcmp(listener->flag, flag) == 0) {
-            listener->callback(flag, status);
+    HASH_FIND_STR(listeners, flag, listener);
+
+    if (!listener) {
+        return NULL;
+    }
+
+    if (!(copy = LDAlloc(sizeof(struct ListenerCallbacks)))) {
+        goto error;
+    }
+
+    if (!(copy->callbacks = LDAlloc(sizeof(struct ListenerCallback) * listener->count))) {
+        LDFree(copy);
+        goto error;
+    }
+
+    memcpy(copy->callbacks, listener->callbacks, sizeof(struct ListenerCallback) * listener->count);
+    copy->count = listener->count;
+
+    return copy;
+
+error:
+    LD_LOG(LD_LOG_ERROR, "failed to copy flag listeners");
+
+    return NULL;
+}
+
+void
+LDi_listenerCallbacksInvoke(const struct ListenerCallbacks *callbacks, const LDFlagChange *change) {
+    unsigned int i;
+
+    for (i = 0; i < callbacks->count; i++) {
+        const struct ListenerCallback *const registered = &callbacks->callbacks[i];
+
+        if (registered->changeCallback) {
+            registered->changeCallback(change, registered->context);
+        } else {
+            registered->callback(change->key, change->deleted);
         }
     }
 }
+
+void
+LDi_listenerCallbacksFree(struct ListenerCallbacks *callbacks) {
+    if (callbacks) {
+        LDFree(callbacks->callbacks);
+        LDFree(callbacks);
+    }
+}
+
+void
+LDi_listenersDispatch(struct ChangeListener* listeners, const LDFlagChange *change) {
+    struct ListenerCallbacks *callbacks;
+
+    if ((callbacks = LDi_listenersCopy(listeners, change->key))) {
+        LDi_listenerCallbacksInvoke(callbacks, change);
+        LDi_listenerCallbacksFree(callbacks);
+    }
+}
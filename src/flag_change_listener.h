@@ -4,7 +4,7 @@
 
 
 /* ChangeListener represents user-provided callbacks that will be invoked when flag add/upsert operations
- * take place.
+ * take place. Callbacks are kept in a hash keyed by flag, so looking up a flag without listeners is one probe.
  *
  * The ChangeListener struct should be stored as a pointer, and initialized with LDi_initListeners.
  *
@@ -17,7 +17,7 @@ struct ChangeListener;
 void
 LDi_initListeners(struct ChangeListener** listeners);
 
-/* Free a list of ChangeListeners. */
+/* Free all ChangeListeners. */
 void
 LDi_freeListeners(struct ChangeListener** listeners);
 
@@ -27,10 +27,40 @@ LDi_freeListeners(struct ChangeListener** listeners);
 LDBoolean
 LDi_listenerAdd(struct ChangeListener** listeners, const char* flag, LDlistenerfn callback);
 
+/* Insert a listener that receives the full change. Unique by (flag, function pointer, context). */
+LDBoolean
+LDi_listenerAddChange(struct ChangeListener** listeners, const char* flag, LDFlagChangeListener callback,
+    void *context);
+
 /* Deletes a listener from the list. */
 void
 LDi_listenerRemove(struct ChangeListener** listeners, const char* flag, LDlistenerfn callback);
 
-/* Dispatches an event for a given flag to all registered listeners. */
 void
-LDi_listenersDispatch(struct ChangeListener* listeners, const char *flag, LDBoolean status);
+LDi_listenerRemoveChange(struct ChangeListener** listeners, const char* flag, LDFlagChangeListener callback,
+    void *context);
+
+/* Returns true if any listener is registered for flag. */
+LDBoolean
+LDi_listenersContain(struct ChangeListener* listeners, const char *flag);
+
+/* A copy of the callbacks registered for a flag. Invoking a copy rather than the
+ * registrations lets callbacks register and unregister listeners, and lets the caller
+ * release the lock guarding the registrations first. */
+struct ListenerCallbacks;
+
+/* Copies the callbacks registered for flag. Returns NULL if there are none, or if
+ * allocation fails, which is logged. */
+struct ListenerCallbacks *
+LDi_listenersCopy(struct ChangeListener* listeners, const char *flag);
+
+void
+LDi_listenerCallbacksInvoke(const struct ListenerCallbacks *callbacks, const LDFlagChange *change);
+
+/* Accepts NULL. */
+void
+LDi_listenerCallbacksFree(struct ListenerCallbacks *callbacks);
+
+/* Dispatches a change to a copy of the listeners registered for change->key. */
+void
+LDi_listenersDispatch(struct ChangeListener* listeners, const LDFlagChange *change);
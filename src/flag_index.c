@@ -0,0 +1,318 @@
+#include <limits.h>
+#include <string.h>
+
+#include <launchdarkly/memory.h>
+
+#include "assertion.h"
+#include "flag_index.h"
+#include "store.h"
+#include "utility.h"
+
+#define LD_FLAG_INDEX_MINIMUM_CAPACITY 16
+#define LD_FLAG_INDEX_CACHE_LINE 64
+
+void
+LDi_flagIndexInitialize(struct LDFlagIndex *const index)
+{
+    LD_ASSERT(index);
+
+    index->allocation = NULL;
+    index->slots      = NULL;
+    index->capacity   = 0;
+    index->count      = 0;
+}
+
+void
+LDi_flagIndexClear(struct LDFlagIndex *const index)
+{
+    LD_ASSERT(index);
+
+    LDFree(index->allocation);
+
+    LDi_flagIndexInitialize(index);
+}
+
+unsigned int
+LDi_flagIndexHash(const char *const key, const size_t keyLength)
+{
+    LD_ASSERT(key);
+
+    return LDi_hash32(key, keyLength);
+}
+
+static unsigned short
+LDi_saturateKeyLength(const size_t keyLength)
+{
+    return keyLength > USHRT_MAX ? USHRT_MAX : (unsigned short)keyLength;
+}
+
+static LDBoolean
+LDi_slotMatches(
+    const struct LDFlagIndexSlot *const slot,
+    const char *const                   key,
+    const size_t                        keyLength,
+    const unsigned int                  hash)
+{
+    if (slot->hash != hash || slot->keyLength != LDi_saturateKeyLength(keyLength)) {
+        return LDBooleanFalse;
+    }
+
+    if (keyLength <= LD_FLAG_INDEX_INLINE_KEY) {
+        return memcmp(slot->inlineKey, key, keyLength) == 0;
+    }
+
+    return strcmp(slot->node->flag.key, key) == 0;
+}
+
+/* Places an entry that is known to not be present, displacing entries that
+ * are closer to their home slot than the entry being placed. */
+static void
+LDi_placeSlot(
+    struct LDFlagIndexSlot *const slots,
+    const unsigned int            capacity,
+    struct LDFlagIndexSlot        entry)
+{
+    unsigned int position;
+
+    position       = entry.hash & (capacity - 1);
+    entry.distance = 1;
+
+    for (;;) {
+        struct LDFlagIndexSlot *const slot = &slots[position];
+
+        if (slot->distance == 0) {
+            *slot = entry;
+
+            return;
+        }
+
+        if (slot->distance < entry.distance) {
+            struct LDFlagIndexSlot displaced;
+
+            displaced = *slot;
+            *slot     = entry;
+            entry     = displaced;
+        }
+
+        position = (position + 1) & (capacity - 1);
+        entry.distance++;
+    }
+}
+
+/* Returns an uninitialized slot array aligned so each slot occupies a
+ * single cache line. The allocation to free is written to allocation. */
+static struct LDFlagIndexSlot *
+LDi_flagIndexAllocateSlots(const unsigned int capacity, void **const allocation)
+{
+    size_t misalignment;
+
+    if (!(*allocation = LDAlloc(
+              sizeof(struct LDFlagIndexSlot) * capacity +
+              LD_FLAG_INDEX_CACHE_LINE)))
+    {
+        return NULL;
+    }
+
+    misalignment = (size_t)*allocation % LD_FLAG_INDEX_CACHE_LINE;
+
+    return (struct LDFlagIndexSlot *)((char *)*allocation +
+        (misalignment ? LD_FLAG_INDEX_CACHE_LINE - misalignment : 0));
+}
+
+static LDBoolean
+LDi_flagIndexResize(struct LDFlagIndex *const index, const unsigned int capacity)
+{
+    void *                  allocation;
+    struct LDFlagIndexSlot *slots;
+    unsigned int            i;
+
+    LD_ASSERT(index);
+
+    if (!(slots = LDi_flagIndexAllocateSlots(capacity, &allocation))) {
+        return LDBooleanFalse;
+    }
+
+    memset(slots, 0, sizeof(struct LDFlagIndexSlot) * capacity);
+
+    for (i = 0; i < index->capacity; i++) {
+        if (index->slots[i].distance) {
+            LDi_placeSlot(slots, capacity, index->slots[i]);
+        }
+    }
+
+    LDFree(index->allocation);
+
+    index->allocation = allocation;
+    index->slots      = slots;
+    index->capacity   = capacity;
+
+    return LDBooleanTrue;
+}
+
+LDBoolean
+LDi_flagIndexCopy(
+    struct LDFlagIndex *const destination, const struct LDFlagIndex *const source)
+{
+    LD_ASSERT(destination);
+    LD_ASSERT(source);
+
+    LDi_flagIndexInitialize(destination);
+
+    if (source->capacity == 0) {
+        return LDBooleanTrue;
+    }
+
+    if (!(destination->slots = LDi_flagIndexAllocateSlots(
+              source->capacity, &destination->allocation)))
+    {
+        return LDBooleanFalse;
+    }
+
+    memcpy(destination->slots, source->slots,
+        sizeof(struct LDFlagIndexSlot) * source->capacity);
+
+    destination->capacity = source->capacity;
+    destination->count    = source->count;
+
+    return LDBooleanTrue;
+}
+
+struct LDStoreNode *
+LDi_flagIndexFindHashed(
+    const struct LDFlagIndex *const index,
+    const char *const               key,
+    const size_t                    keyLength,
+    const unsigned int              hash)
+{
+    unsigned int   position;
+    unsigned short distance;
+
+    LD_ASSERT(index);
+    LD_ASSERT(key);
+
+    if (index->count == 0) {
+        return NULL;
+    }
+
+    position = hash & (index->capacity - 1);
+
+    for (distance = 1;; distance++) {
+        const struct LDFlagIndexSlot *const slot = &index->slots[position];
+
+        /* An entry this far from home would have displaced the slot's
+         * occupant, so the key cannot be present further along. */
+        if (slot->distance < distance) {
+            return NULL;
+        }
+
+        if (LDi_slotMatches(slot, key, keyLength, hash)) {
+            return slot->node;
+        }
+
+        position = (position + 1) & (index->capacity - 1);
+    }
+}
+
+struct LDStoreNode *
+LDi_flagIndexFind(const struct LDFlagIndex *const index, const char *const key)
+{
+    size_t keyLength;
+
+    LD_ASSERT(index);
+    LD_ASSERT(key);
+
+    keyLength = strlen(key);
+
+    return LDi_flagIndexFindHashed(
+        index, key, keyLength, LDi_flagIndexHash(key, keyLength));
+}
+
+LDBoolean
+LDi_flagIndexInsert(
+    struct LDFlagIndex *const  index,
+    struct LDStoreNode *const  node,
+    struct LDStoreNode **const previous)
+{
+    struct LDFlagIndexSlot entry;
+    size_t                 keyLength;
+
+    LD_ASSERT(index);
+    LD_ASSERT(node);
+    LD_ASSERT(node->flag.key);
+    LD_ASSERT(previous);
+
+    *previous = NULL;
+    keyLength = strlen(node->flag.key);
+    entry.hash = LDi_flagIndexHash(node->flag.key, keyLength);
+
+    if (index->count) {
+        unsigned int   position;
+        unsigned short distance;
+
+        position = entry.hash & (index->capacity - 1);
+
+        for (distance = 1;; distance++) {
+            struct LDFlagIndexSlot *const slot = &index->slots[position];
+
+            if (slot->distance < distance) {
+                break;
+            }
+
+            if (LDi_slotMatches(slot, node->flag.key, keyLength, entry.hash)) {
+                *previous  = slot->node;
+                slot->node = node;
+
+                return LDBooleanTrue;
+            }
+
+            position = (position + 1) & (index->capacity - 1);
+        }
+    }
+
+    /* keep the load factor at or below 7/8 */
+    if ((index->count + 1) * 8 > index->capacity * 7) {
+        if (!LDi_flagIndexResize(
+                index,
+                index->capacity ? index->capacity * 2
+                                : LD_FLAG_INDEX_MINIMUM_CAPACITY))
+        {
+            return LDBooleanFalse;
+        }
+    }
+
+    entry.node      = node;
+    entry.keyLength = LDi_saturateKeyLength(keyLength);
+    entry.distance  = 0;
+
+    memset(entry.inlineKey, 0, sizeof(entry.inlineKey));
+
+    if (keyLength <= LD_FLAG_INDEX_INLINE_KEY) {
+        memcpy(entry.inlineKey, node->flag.key, keyLength);
+    }
+
+    LDi_placeSlot(index->slots, index->capacity, entry);
+
+    index->count++;
+
+    return LDBooleanTrue;
+}
+
+struct LDStoreNode *
+LDi_flagIndexNext(
+    const struct LDFlagIndex *const index, unsigned int *const position)
+{
+    LD_ASSERT(index);
+    LD_ASSERT(position);
+
+    while (*position < index->capacity) {
+        const struct LDFlagIndexSlot *const slot = &index->slots[*position];
+
+        (*position)++;
+
+        if (slot->distance) {
+            return slot->node;
+        }
+    }
+
+    return NULL;
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <stddef.h>
+
+#include <launchdarkly/boolean.h>
+
+struct LDStoreNode;
+
+/* Number of key bytes copied into each slot. Keys that fit are compared
+ * without dereferencing the store node, so a probe touches only the slot. */
+#define LD_FLAG_INDEX_INLINE_KEY 48
+
+/* Slot layout is sized to 64 bytes on LP64 platforms, one cache line. */
+struct LDFlagIndexSlot
+{
+    struct LDStoreNode *node;
+    unsigned int        hash;
+    /* Key length, saturated at USHRT_MAX for very long keys. */
+    unsigned short      keyLength;
+    /* Zero for an empty slot, otherwise distance from the home slot plus one. */
+    unsigned short      distance;
+    char                inlineKey[LD_FLAG_INDEX_INLINE_KEY];
+};
+
+/* Open addressing hash index from flag key to store node using Robin Hood
+ * linear probing. The index does not own the nodes it references. */
+struct LDFlagIndex
+{
+    void *                  allocation;
+    struct LDFlagIndexSlot *slots;
+    /* Always zero or a power of two. */
+    unsigned int            capacity;
+    unsigned int            count;
+};
+
+void
+LDi_flagIndexInitialize(struct LDFlagIndex *const index);
+
+/* Releases the slot array. Nodes referenced by the index are not touched. */
+void
+LDi_flagIndexClear(struct LDFlagIndex *const index);
+
+/* Initializes destination with the same slots as source. Nodes are shared
+ * between the two, and not touched. */
+LDBoolean
+LDi_flagIndexCopy(
+    struct LDFlagIndex *const destination, const struct LDFlagIndex *const source);
+
+unsigned int
+LDi_flagIndexHash(const char *const key, const size_t keyLength);
+
+struct LDStoreNode *
+LDi_flagIndexFind(const struct LDFlagIndex *const index, const char *const key);
+
+struct LDStoreNode *
+LDi_flagIndexFindHashed(
+    const struct LDFlagIndex *const index,
+    const char *const               key,
+    const size_t                    keyLength,
+    const unsigned int              hash);
+
+/* Inserts a node keyed by node->flag.key. If a node with the same key is
+ * already present it is replaced, and returned via previous. */
+LDBoolean
+LDi_flagIndexInsert(
+    struct LDFlagIndex *const  index,
+    struct LDStoreNode *const  node,
+    struct LDStoreNode **const previous);
+
+/* Iterates nodes in slot order. Start with position set to zero, returns NULL
+ * once every node has been visited. */
+struct LDStoreNode *
+LDi_flagIndexNext(
+    const struct LDFlagIndex *const index, unsigned int *const position);
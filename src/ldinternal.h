@@ -97,6 +97,8 @@ LDi_updatestatus(struct LDClient *const client, const LDStatus status);
 THREAD_RETURN
 LDi_bgeventsender(void *const v);
 THREAD_RETURN
+LDi_bgeventdelivery(void *const v);
+THREAD_RETURN
 LDi_bgfeaturepoller(void *const v);
 THREAD_RETURN
 LDi_bgfeaturestreamer(void *const v);
@@ -11,6 +11,7 @@
 
 #include <curl/curl.h>
 
+#include "event_spool.h"
 #include "flag.h"
 #include "ldinternal.h"
 
@@ -19,19 +20,266 @@
  * plus the server event parser and streaming update handler.
  */
 
+/* Each payload is attempted this many times before it is left in the spool
+ * or discarded, backing off between attempts. */
+#define LD_EVENT_DELIVERY_ATTEMPTS 3
+#define LD_EVENT_DELIVERY_MAX_BACKOFF_MILLIS (30 * 1000)
+/* Replay of the spool is probed with one payload at a time while delivery
+ * is failing, backing off up to this delay. */
+#define LD_EVENT_SPOOL_MAX_BACKOFF_MILLIS (5 * 60 * 1000)
+
+/* Sends a payload with jittered exponential backoff between attempts.
+ * Returns true when it was accepted. */
+static LDBoolean
+LDi_deliverEvents(
+    struct LDClient *const           client,
+    const struct LDEventBatch *const batch)
+{
+    unsigned int attempt;
+
+    for (attempt = 0; attempt < LD_EVENT_DELIVERY_ATTEMPTS; attempt++) {
+        long response = 0;
+
+        /* payloads are not retried once delivery is closing */
+        if (attempt > 0 &&
+            !LDi_deliverySleep(
+                &client->delivery,
+                LDi_deliveryBackoff(
+                    attempt, LD_EVENT_DELIVERY_MAX_BACKOFF_MILLIS)))
+        {
+            return LDBooleanFalse;
+        }
+
+        LDi_sendevents(client, batch->payload, batch->payloadId, &response);
+
+        if (response == 200 || response == 202) {
+            LD_LOG(LD_LOG_TRACE, "successfuly sent event batch");
+
+            return LDBooleanTrue;
+        }
+
+        if (response == 401 || response == 403) {
+            LDi_rwlock_wrlock(&client->clientLock);
+            LDi_updatestatus(client, LDStatusFailed);
+            LDi_rwlock_wrunlock(&client->clientLock);
+
+            LD_LOG(
+                LD_LOG_ERROR, "mobile key not authorized, event sending failed");
+
+            return LDBooleanFalse;
+        }
+    }
+
+    return LDBooleanFalse;
+}
+
+/* Keeps a payload that could not be sent for replay, if there is a spool. */
+static void
+LDi_spoolOrDiscardEvents(
+    struct LDClient *const client,
+    const char *const      payloadId,
+    const char *const      payload)
+{
+    if (client->eventSpool &&
+        LDi_eventSpoolAppend(client->eventSpool, payloadId, payload))
+    {
+        LD_LOG(LD_LOG_TRACE, "spooled event batch");
+    } else {
+        LD_LOG(LD_LOG_WARNING, "sending events failed deleting event batch");
+    }
+}
+
+THREAD_RETURN
+LDi_bgeventdelivery(void *const v)
+{
+    struct LDClient *const client = v;
+    struct LDEventBatch *  batch;
+    LDBoolean              delivered;
+
+    while ((batch = LDi_deliveryPop(&client->delivery))) {
+        delivered = LDi_deliverEvents(client, batch);
+
+        /* spooled payloads stay on disk until delivered, a failed payload
+         * is replayed ahead of newer ones */
+        if (batch->spooled) {
+            if (delivered) {
+                LDi_eventSpoolDelivered(client->eventSpool, batch->payloadId);
+            } else {
+                LDi_eventSpoolRetry(client->eventSpool, batch->payloadId);
+            }
+        } else if (!delivered) {
+            LDi_spoolOrDiscardEvents(client, batch->payloadId, batch->payload);
+        }
+
+        LDi_deliveryDone(&client->delivery, batch, delivered);
+        LDi_freeEventBatch(batch);
+    }
+
+    LD_LOG(LD_LOG_TRACE, "killing thread LDi_bgeventdelivery");
+
+    return THREAD_RETURN_DEFAULT;
+}
+
+struct LDSpoolBackoff
+{
+    double       retryAt;
+    unsigned int attempt;
+};
+
+/* Hands spooled payloads to delivery while there is room. While delivery
+ * is failing only one payload is sent, as a probe, per backoff period. */
+static void
+LDi_replaySpool(
+    struct LDClient *const       client,
+    struct LDSpoolBackoff *const backoff,
+    const LDBoolean              wait)
+{
+    char                 payloadId[LD_UUID_SIZE + 1];
+    char *               payload;
+    struct LDEventBatch *batch;
+    LDBoolean            probe;
+    double               now;
+
+    if (LDi_eventSpoolIsEmpty(client->eventSpool)) {
+        return;
+    }
+
+    LDi_getMonotonicMilliseconds(&now);
+
+    if ((probe = !LDi_deliveryHealthy(&client->delivery))) {
+        if (now < backoff->retryAt) {
+            return;
+        }
+
+        backoff->attempt++;
+        backoff->retryAt = now + LDi_deliveryBackoff(
+                                     backoff->attempt,
+                                     LD_EVENT_SPOOL_MAX_BACKOFF_MILLIS);
+    } else {
+        backoff->attempt = 0;
+    }
+
+    while (LDi_eventSpoolNext(client->eventSpool, payloadId, &payload)) {
+        if (!(batch = LDi_newEventBatch(payload, payloadId))) {
+            LD_LOG(LD_LOG_ERROR, "alloc error");
+
+            LDi_eventSpoolRetry(client->eventSpool, payloadId);
+
+            return;
+        }
+
+        batch->spooled = LDBooleanTrue;
+
+        /* waits for room like a direct dispatch, except for a probe */
+        if (!LDi_deliveryPush(&client->delivery, batch, wait && !probe)) {
+            LDi_eventSpoolRetry(client->eventSpool, batch->payloadId);
+
+            LDi_freeEventBatch(batch);
+
+            return;
+        }
+
+        if (probe) {
+            return;
+        }
+    }
+}
+
+/* Takes ownership of a serialized payload, and hands it to delivery. The
+ * payload is only written to the spool if it cannot be sent: while offline,
+ * if delivery has no room for it, or if sending it fails. While earlier
+ * payloads wait in the spool it is appended behind them, so that replay
+ * stays oldest first. */
+static void
+LDi_dispatchEvents(
+    struct LDClient *const client,
+    char *const            payload,
+    const LDBoolean        offline,
+    const LDBoolean        wait)
+{
+    struct LDEventBatch *batch;
+    char                 payloadId[LD_UUID_SIZE + 1];
+
+    payloadId[LD_UUID_SIZE] = 0;
+
+    if (!LDi_UUIDv4(payloadId)) {
+        LD_LOG(LD_LOG_ERROR, "failed to generate payload identifier");
+
+        LDFree(payload);
+
+        return;
+    }
+
+    if (offline ||
+        (client->eventSpool && !LDi_eventSpoolIsEmpty(client->eventSpool)))
+    {
+        LDi_spoolOrDiscardEvents(client, payloadId, payload);
+
+        LDFree(payload);
+
+        return;
+    }
+
+    if (!(batch = LDi_newEventBatch(payload, payloadId))) {
+        LD_LOG(LD_LOG_ERROR, "alloc error");
+
+        return;
+    }
+
+    /* waits while the in flight limits are reached, events keep
+     * accumulating in the meantime */
+    if (!LDi_deliveryPush(&client->delivery, batch, wait)) {
+        LDi_spoolOrDiscardEvents(client, batch->payloadId, batch->payload);
+
+        LDi_freeEventBatch(batch);
+    }
+}
+
+/* Splits a bundled payload into size bounded requests, each with its own
+ * identifier, and dispatches them. */
+static void
+LDi_dispatchPayload(
+    struct LDClient *const client,
+    struct LDJSON *const   payloadJSON,
+    const LDBoolean        offline,
+    const LDBoolean        wait)
+{
+    struct LDJSON *iter;
+    char *         payloadSerialized;
+
+    for (iter = LDGetIter(payloadJSON); iter;) {
+        if (!(payloadSerialized = LDi_serializeEventBatch(
+                  &iter,
+                  client->shared->sharedConfig->eventsMaxPayloadBytes,
+                  client->shared->sharedConfig->inlineUsersInEvents &&
+                      client->shared->sharedConfig->deduplicateInlineUsers)))
+        {
+            LD_LOG(
+                LD_LOG_ERROR,
+                "LDi_bgeventsender failed to serialize event payload");
+
+            break;
+        }
+
+        LDi_dispatchEvents(client, payloadSerialized, offline, wait);
+    }
+}
+
 THREAD_RETURN
 LDi_bgeventsender(void *const v)
 {
     struct LDClient *const client     = v;
     LDBoolean              finalflush = LDBooleanFalse;
+    struct LDSpoolBackoff  backoff;
+
+    backoff.retryAt = 0;
+    backoff.attempt = 0;
 
     while (LDBooleanTrue) {
         struct LDJSON *payloadJSON;
-        char *         payloadSerialized;
         LDStatus       status;
         int            ms;
-        char           payloadId[LD_UUID_SIZE + 1];
-        LDBoolean      sendFailed;
+        LDBoolean      offline;
 
         LDi_rwlock_wrlock(&client->clientLock);
 
@@ -48,7 +296,12 @@ LDi_bgeventsender(void *const v)
         if (status != LDStatusShuttingdown) {
             LDi_mutex_lock(&client->condMtx);
             LDi_rwlock_wrunlock(&client->clientLock);
-            LDi_cond_wait(&client->eventCond, &client->condMtx, ms);
+            /* the watermark may have been reached while bundling, and its
+             * signal is sent without condMtx, so one sent just before this
+             * wait is caught by the flush interval instead */
+            if (!LDi_eventProcessorFlushRequested(client->eventProcessor)) {
+                LDi_cond_wait(&client->eventCond, &client->condMtx, ms);
+            }
             LDi_mutex_unlock(&client->condMtx);
         } else {
             LDi_rwlock_wrunlock(&client->clientLock);
@@ -61,87 +314,31 @@ LDi_bgeventsender(void *const v)
             finalflush = LDBooleanTrue;
         }
 
-        if (client->offline) {
-            LDi_rwlock_rdunlock(&client->clientLock);
-            continue;
-        }
+        offline = client->offline;
         LDi_rwlock_rdunlock(&client->clientLock);
 
-        payloadId[LD_UUID_SIZE] = 0;
-
-        if (!LDi_UUIDv4(payloadId)) {
-            LD_LOG(LD_LOG_ERROR, "failed to generate payload identifier");
-
+        /* without a spool events wait in memory until back online */
+        if (offline && !client->eventSpool) {
             continue;
         }
 
+        /* the final flush does not wait for room, close joins this thread
+         * before closing delivery, and delivery may be backing off */
         if (!LDi_bundleEventPayload(client->eventProcessor, &payloadJSON)) {
             LD_LOG(
                 LD_LOG_ERROR,
                 "LDi_bgeventsender failed to bundle event payload");
-
-            continue;
-        }
-
-        if (payloadJSON == NULL) {
-            continue;
-        }
-
-        if (!(payloadSerialized = LDJSONSerialize(payloadJSON))) {
-            LD_LOG(
-                LD_LOG_ERROR,
-                "LDi_bgeventsender failed to serialize event payload");
+        } else if (payloadJSON) {
+            LDi_dispatchPayload(client, payloadJSON, offline, !finalflush);
 
             LDJSONFree(payloadJSON);
-
-            continue;
         }
 
-        LDJSONFree(payloadJSON);
-
-        sendFailed = LDBooleanFalse;
-        while (LDBooleanTrue) {
-            long response = 0;
-
-            LDi_sendevents(client, payloadSerialized, payloadId, &response);
-
-            if (response == 200 || response == 202) {
-                LD_LOG(LD_LOG_TRACE, "successfuly sent event batch");
-
-                sendFailed = LDBooleanFalse;
-
-                break;
-            } else {
-                if (sendFailed == LDBooleanTrue) {
-                    break;
-                }
-
-                sendFailed = LDBooleanTrue;
-
-                if (response == 401 || response == 403) {
-                    LDi_rwlock_wrlock(&client->clientLock);
-                    LDi_updatestatus(client, LDStatusFailed);
-                    LDi_rwlock_wrunlock(&client->clientLock);
-
-                    LD_LOG(
-                        LD_LOG_ERROR,
-                        "mobile key not authorized, event sending failed");
-
-                    break;
-                }
-
-                LDi_mutex_lock(&client->condMtx);
-                LDi_cond_wait(&client->eventCond, &client->condMtx, 1000);
-                LDi_mutex_unlock(&client->condMtx);
-            }
+        /* replayed after dispatching, so that the payloads of this flush,
+         * appended behind a backlog, are sent in the same pass */
+        if (!offline && client->eventSpool) {
+            LDi_replaySpool(client, &backoff, !finalflush);
         }
-
-        if (sendFailed) {
-            LD_LOG(
-                LD_LOG_WARNING, "sending events failed deleting event batch");
-        }
-
-        LDFree(payloadSerialized);
     }
 }
 
@@ -0,0 +1,205 @@
+#include <stddef.h>
+
+#include <launchdarkly/memory.h>
+
+#include "assertion.h"
+#include "metric_aggregate.h"
+
+/* The stripe of each thread, plus one so that unassigned reads as NULL.
+ * Stripes are handed out in turn from LDi_metricNextStripe. */
+static LDBoolean     LDi_metricStripesReady = LDBooleanFalse;
+static unsigned long LDi_metricNextStripe   = 0;
+
+#ifdef _WIN32
+static DWORD LDi_metricStripeKey = FLS_OUT_OF_INDEXES;
+
+#define LD_METRIC_STRIPE_GET() ((size_t)FlsGetValue(LDi_metricStripeKey))
+#define LD_METRIC_STRIPE_SET(stripe)                                           \
+    FlsSetValue(LDi_metricStripeKey, (void *)(stripe))
+#else
+static pthread_key_t LDi_metricStripeKey;
+
+#define LD_METRIC_STRIPE_GET() ((size_t)pthread_getspecific(LDi_metricStripeKey))
+#define LD_METRIC_STRIPE_SET(stripe)                                           \
+    pthread_setspecific(LDi_metricStripeKey, (void *)(stripe))
+#endif
+
+void
+LDi_metricStripesInitialize(void)
+{
+#ifdef _WIN32
+    if ((LDi_metricStripeKey = FlsAlloc(NULL)) == FLS_OUT_OF_INDEXES) {
+        return;
+    }
+#else
+    if (pthread_key_create(&LDi_metricStripeKey, NULL)) {
+        return;
+    }
+#endif
+
+    LDi_metricStripesReady = LDBooleanTrue;
+}
+
+static void
+LDi_metricResetStripe(struct LDMetricStripe *const stripe)
+{
+    stripe->count = 0;
+    stripe->sum   = 0;
+    stripe->min   = 0;
+    stripe->max   = 0;
+}
+
+LDBoolean
+LDi_metricInitialize(
+    struct LDMetricAggregate *const aggregate, const char *const key)
+{
+    unsigned int i;
+
+    LD_ASSERT(aggregate);
+    LD_ASSERT(key);
+
+    aggregate->event = NULL;
+
+    if (!(aggregate->key = LDStrDup(key))) {
+        return LDBooleanFalse;
+    }
+
+    for (i = 0; i < LD_METRIC_STRIPES; i++) {
+        LDi_mutex_init(&aggregate->stripes[i].lock);
+        LDi_metricResetStripe(&aggregate->stripes[i]);
+    }
+
+    return LDBooleanTrue;
+}
+
+void
+LDi_metricDestroy(struct LDMetricAggregate *const aggregate)
+{
+    unsigned int i;
+
+    if (aggregate) {
+        for (i = 0; i < LD_METRIC_STRIPES; i++) {
+            LDi_mutex_destroy(&aggregate->stripes[i].lock);
+        }
+
+        LDJSONFree(aggregate->event);
+        LDFree(aggregate->key);
+    }
+}
+
+LDBoolean
+LDi_metricNeedsEvent(struct LDMetricAggregate *const aggregate)
+{
+    LD_ASSERT(aggregate);
+
+    return LD_ATOMIC_LOAD_POINTER(&aggregate->event) == NULL;
+}
+
+void
+LDi_metricSetEvent(
+    struct LDMetricAggregate *const aggregate, struct LDJSON *const event)
+{
+    LD_ASSERT(aggregate);
+    LD_ASSERT(event);
+
+    if (!LD_ATOMIC_CAS_POINTER(&aggregate->event, NULL, event)) {
+        LDJSONFree(event);
+    }
+}
+
+/* Returns the stripe of the calling thread, assigning one on first use. */
+static struct LDMetricStripe *
+LDi_metricStripe(struct LDMetricAggregate *const aggregate)
+{
+    size_t stripe;
+
+    if (!LDi_metricStripesReady) {
+        return &aggregate->stripes[0];
+    }
+
+    if ((stripe = LD_METRIC_STRIPE_GET()) == 0) {
+        stripe = LD_ATOMIC_INCREMENT_ULONG(&LDi_metricNextStripe) %
+                LD_METRIC_STRIPES + 1;
+
+        /* without storage the stripe is assigned again next time */
+        LD_METRIC_STRIPE_SET(stripe);
+    }
+
+    return &aggregate->stripes[stripe - 1];
+}
+
+void
+LDi_metricAdd(struct LDMetricAggregate *const aggregate, const double value)
+{
+    struct LDMetricStripe *stripe;
+
+    LD_ASSERT(aggregate);
+
+    stripe = LDi_metricStripe(aggregate);
+
+    LDi_mutex_lock(&stripe->lock);
+
+    if (stripe->count == 0 || value < stripe->min) {
+        stripe->min = value;
+    }
+
+    if (stripe->count == 0 || value > stripe->max) {
+        stripe->max = value;
+    }
+
+    stripe->count++;
+    stripe->sum += value;
+
+    LDi_mutex_unlock(&stripe->lock);
+}
+
+void
+LDi_metricTake(
+    struct LDMetricAggregate *const aggregate,
+    struct LDMetricTotals *const    totals,
+    struct LDJSON **const           event)
+{
+    struct LDMetricStripe *stripe;
+    unsigned int           i;
+
+    LD_ASSERT(aggregate);
+    LD_ASSERT(totals);
+    LD_ASSERT(event);
+
+    totals->count = 0;
+    totals->sum   = 0;
+    totals->min   = 0;
+    totals->max   = 0;
+
+    do {
+        *event = LD_ATOMIC_LOAD_POINTER(&aggregate->event);
+    } while (!LD_ATOMIC_CAS_POINTER(&aggregate->event, *event, NULL));
+
+    /* samples that raced with the previous take wait for an event */
+    if (*event == NULL) {
+        return;
+    }
+
+    for (i = 0; i < LD_METRIC_STRIPES; i++) {
+        stripe = &aggregate->stripes[i];
+
+        LDi_mutex_lock(&stripe->lock);
+
+        if (stripe->count) {
+            if (totals->count == 0 || stripe->min < totals->min) {
+                totals->min = stripe->min;
+            }
+
+            if (totals->count == 0 || stripe->max > totals->max) {
+                totals->max = stripe->max;
+            }
+
+            totals->count += stripe->count;
+            totals->sum += stripe->sum;
+        }
+
+        LDi_metricResetStripe(stripe);
+
+        LDi_mutex_unlock(&stripe->lock);
+    }
+}
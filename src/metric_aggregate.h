@@ -0,0 +1,78 @@
+#pragma once
+
+#include <launchdarkly/boolean.h>
+#include <launchdarkly/json.h>
+
+#include "concurrency.h"
+
+/* Count, sum, minimum and maximum of the values tracked for one custom
+ * event key, see LDConfigAddAggregatedMetric.
+ *
+ * Samples are accumulated in stripes, each with its own lock. Each thread
+ * is given a stripe in turn on its first sample, and keeps it in thread
+ * specific storage, so up to LD_METRIC_STRIPES threads tracking the same
+ * key never contend, and more threads share stripes evenly. The event the
+ * summary is emitted as is built from the first sample of each interval
+ * and installed with a compare and swap, so only that sample builds an
+ * event. */
+
+#define LD_METRIC_STRIPE_BITS 3
+#define LD_METRIC_STRIPES (1 << LD_METRIC_STRIPE_BITS)
+
+struct LDMetricStripe
+{
+    ld_mutex_t lock;
+    double     count;
+    double     sum;
+    double     min;
+    double     max;
+};
+
+struct LDMetricAggregate
+{
+    char *                key;
+    /* custom event carrying the user, NULL until the first sample */
+    struct LDJSON *       event;
+    struct LDMetricStripe stripes[LD_METRIC_STRIPES];
+};
+
+struct LDMetricTotals
+{
+    double count;
+    double sum;
+    double min;
+    double max;
+};
+
+/* Called once from LDi_earlyinit. Until then every thread uses the first
+ * stripe. */
+void
+LDi_metricStripesInitialize(void);
+
+LDBoolean
+LDi_metricInitialize(
+    struct LDMetricAggregate *const aggregate, const char *const key);
+
+void
+LDi_metricDestroy(struct LDMetricAggregate *const aggregate);
+
+/* Returns true if the aggregate still needs an event for this interval. */
+LDBoolean
+LDi_metricNeedsEvent(struct LDMetricAggregate *const aggregate);
+
+/* Installs the event for this interval, taking ownership of it. Frees it
+ * if another thread installed one first. */
+void
+LDi_metricSetEvent(
+    struct LDMetricAggregate *const aggregate, struct LDJSON *const event);
+
+void
+LDi_metricAdd(struct LDMetricAggregate *const aggregate, const double value);
+
+/* Resets the aggregate, returning its totals and event. The event is NULL,
+ * and the samples are kept, when no event has been installed. */
+void
+LDi_metricTake(
+    struct LDMetricAggregate *const aggregate,
+    struct LDMetricTotals *const    totals,
+    struct LDJSON **const           event);
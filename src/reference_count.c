@@ -49,6 +49,20 @@ LDi_rc_decrement(struct ld_rc_t *const rc)
     }
 }
 
+LDBoolean
+LDi_rc_unique(struct ld_rc_t *const rc)
+{
+    LDBoolean unique;
+
+    LD_ASSERT(rc);
+
+    LDi_mutex_lock(&rc->lock);
+    unique = rc->count == 1;
+    LDi_mutex_unlock(&rc->lock);
+
+    return unique;
+}
+
 void
 LDi_rc_destroy(struct ld_rc_t *const rc)
 {
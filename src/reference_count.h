@@ -24,5 +24,9 @@ LDi_rc_increment(struct ld_rc_t *const rc);
 void
 LDi_rc_decrement(struct ld_rc_t *const rc);
 
+/* Whether the caller holds the only reference. */
+LDBoolean
+LDi_rc_unique(struct ld_rc_t *const rc);
+
 void
 LDi_rc_destroy(struct ld_rc_t *const rc);
@@ -1,9 +1,46 @@
+#include <string.h>
+
 #include <launchdarkly/memory.h>
 
 #include "assertion.h"
 #include "store.h"
+#include "utility.h"
 #include "uthash.h"
 
+struct LDFlagNotification
+{
+    /* owned copy, the nodes may change while the notification is pending */
+    char *              key;
+    /* State before the first pending change, may be NULL. */
+    struct LDStoreNode *previous;
+    /* State after the latest pending change. */
+    struct LDStoreNode *current;
+    /* Monotonic milliseconds when the first pending change was made. */
+    double             queued;
+    UT_hash_handle     hh;
+};
+
+/* Source of store generations, shared so that a new store never repeats
+ * a generation that was observed for a previous store at the same
+ * address. */
+static unsigned long LDi_storeGenerations = 0;
+
+/* Called with the store write lock held. */
+static void
+LDi_storeAdvanceGeneration(struct LDStore *const store)
+{
+    LD_ATOMIC_STORE_ULONG(
+        &store->generation, LD_ATOMIC_INCREMENT_ULONG(&LDi_storeGenerations));
+}
+
+unsigned long
+LDi_storeGeneration(struct LDStore *const store)
+{
+    LD_ASSERT(store);
+
+    return LD_ATOMIC_LOAD_ULONG(&store->generation);
+}
+
 static void
 LDi_destroyStoreNode(void *const nodeRaw)
 {
@@ -19,26 +56,233 @@ LDi_destroyStoreNode(void *const nodeRaw)
 }
 
 static void
-LDi_storeFreeHash(struct LDStoreNode *flags)
+LDi_destroyStoreTable(void *const tableRaw)
+{
+    struct LDStoreTable *table;
+    struct LDStoreNode * node;
+    unsigned int         position;
+
+    table = (struct LDStoreTable *)tableRaw;
+
+    if (table) {
+        position = 0;
+
+        /* nodes may outlive the table when borrowed by an evaluation */
+        while ((node = LDi_flagIndexNext(&table->flags, &position))) {
+            LDi_rc_decrement(&node->rc);
+        }
+
+        LDi_flagIndexClear(&table->flags);
+        LDFree(table->slots);
+        LDi_rc_destroy(&table->rc);
+        LDFree(tableRaw);
+    }
+}
+
+static struct LDStoreTable *
+LDi_allocateStoreTable(void)
+{
+    struct LDStoreTable *table;
+
+    if (!(table = LDAlloc(sizeof(struct LDStoreTable)))) {
+        return NULL;
+    }
+
+    if (!LDi_rc_initialize(&table->rc, (void *)table, LDi_destroyStoreTable)) {
+        LDFree(table);
+
+        return NULL;
+    }
+
+    LDi_flagIndexInitialize(&table->flags);
+
+    table->slots = NULL;
+
+    return table;
+}
+
+/* Resolves every manifest key against a table that is not yet published.
+ * On allocation failure the table is left without slots, and lookups fall
+ * back to the index. */
+static void
+LDi_assignStoreSlots(
+    const struct LDStore *const store, struct LDStoreTable *const table)
 {
-    struct LDStoreNode *node, *tmp;
+    const LDFlagKey *key;
+    unsigned int     i;
 
-    HASH_ITER(hh, flags, node, tmp)
+    if (store->manifestCount == 0) {
+        return;
+    }
+
+    if (!(table->slots = LDAlloc(
+              sizeof(struct LDStoreNode *) * store->manifestCount)))
     {
-        HASH_DEL(flags, node);
+        LD_LOG(LD_LOG_WARNING, "failed to allocate flag manifest slots");
+
+        return;
+    }
+
+    for (i = 0; i < store->manifestCount; i++) {
+        key = &store->manifest[i];
 
-        LDi_destroyStoreNode(node);
+        table->slots[i] = LDi_flagIndexFindHashed(
+            &table->flags, key->key, key->length, key->hash);
     }
 }
 
+/* Points the manifest slot for the key of node, if any, at node. */
+static void
+LDi_updateStoreSlot(
+    const struct LDStore *const  store,
+    struct LDStoreTable *const   table,
+    struct LDStoreNode *const    node)
+{
+    const LDFlagKey *key;
+    size_t           length;
+    unsigned int     hash, i;
+
+    if (!table->slots) {
+        return;
+    }
+
+    length = strlen(node->flag.key);
+    hash   = LDi_flagIndexHash(node->flag.key, length);
+
+    for (i = 0; i < store->manifestCount; i++) {
+        key = &store->manifest[i];
+
+        if (key->hash == hash && key->length == length &&
+            memcmp(key->key, node->flag.key, length) == 0)
+        {
+            table->slots[i] = node;
+
+            return;
+        }
+    }
+}
+
+/* Returns a new table referencing the same nodes as source, which may be
+ * NULL for an empty store, and with the same slots. Called with at least
+ * the read lock held. */
+static struct LDStoreTable *
+LDi_copyStoreTable(
+    const struct LDStore *const store, const struct LDStoreTable *const source)
+{
+    struct LDStoreTable *table;
+    struct LDStoreNode * node;
+    unsigned int         position;
+
+    if (!(table = LDi_allocateStoreTable())) {
+        return NULL;
+    }
+
+    if (source) {
+        if (!LDi_flagIndexCopy(&table->flags, &source->flags)) {
+            LDi_rc_destroy(&table->rc);
+            LDFree(table);
+
+            return NULL;
+        }
+
+        position = 0;
+
+        while ((node = LDi_flagIndexNext(&table->flags, &position))) {
+            LDi_rc_increment(&node->rc);
+        }
+
+        if (source->slots && (table->slots = LDAlloc(
+                                  sizeof(struct LDStoreNode *) *
+                                  store->manifestCount)))
+        {
+            memcpy(
+                table->slots,
+                source->slots,
+                sizeof(struct LDStoreNode *) * store->manifestCount);
+        }
+    }
+
+    return table;
+}
+
+void
+LDi_storeReleaseTable(struct LDStoreTable *const table)
+{
+    if (table) {
+        LDi_rc_decrement(&table->rc);
+    }
+}
+
+struct LDStoreTable *
+LDi_storeAcquireTable(struct LDStore *const store)
+{
+    struct LDStoreTable *table;
+
+    LD_ASSERT(store);
+
+    LDi_rwlock_rdlock(&store->lock);
+
+    if ((table = store->table)) {
+        LDi_rc_increment(&table->rc);
+    }
+
+    LDi_rwlock_rdunlock(&store->lock);
+
+    return table;
+}
+
+struct LDStoreNode *
+LDi_storeTableGet(
+    const struct LDStoreTable *const table, const char *const key)
+{
+    struct LDStoreNode *lookup;
+
+    LD_ASSERT(key);
+
+    if (table == NULL) {
+        return NULL;
+    }
+
+    lookup = LDi_flagIndexFind(&table->flags, key);
+
+    if (lookup && lookup->flag.deleted) {
+        return NULL;
+    }
+
+    return lookup;
+}
+
 void
 LDi_storeFreeFlags(struct LDStore *const store)
 {
+    struct LDStoreTable *previous;
+
     LD_ASSERT(store);
 
-    LDi_storeFreeHash(store->flags);
+    LDi_rwlock_wrlock(&store->lock);
+
+    previous     = store->table;
+    store->table = NULL;
+
+    LDi_storeAdvanceGeneration(store);
+
+    LDi_rwlock_wrunlock(&store->lock);
+
+    LDi_storeReleaseTable(previous);
+}
+
+void
+LDi_storeSetManifest(
+    struct LDStore *const  store,
+    const LDFlagKey *const keys,
+    const unsigned int     keyCount)
+{
+    LD_ASSERT(store);
+    LD_ASSERT(keys || keyCount == 0);
+    LD_ASSERT(store->table == NULL);
 
-    store->flags = NULL;
+    store->manifest      = keys;
+    store->manifestCount = keyCount;
 }
 
 LDBoolean
@@ -50,20 +294,56 @@ LDi_storeInitialize(struct LDStore *const store)
         return LDBooleanFalse;
     }
 
-    store->flags       = NULL;
-    store->initialized = LDBooleanFalse;
+    if (!LDi_mutex_init(&store->notificationLock)) {
+        LDi_rwlock_destroy(&store->lock);
+
+        return LDBooleanFalse;
+    }
+
+    store->table             = NULL;
+    store->initialized       = LDBooleanFalse;
+    store->suppressUnchanged = LDBooleanFalse;
+    store->manifest          = NULL;
+    store->manifestCount     = 0;
+    store->notifications     = NULL;
+    store->dispatching       = LDBooleanFalse;
+
+    memset(&store->listenerStatistics, 0, sizeof(LDListenerStatistics));
+
+    LDi_storeAdvanceGeneration(store);
 
     LDi_initListeners(&store->listeners);
 
     return LDBooleanTrue;
 }
 
+static void
+LDi_freeNotification(struct LDFlagNotification *const notification)
+{
+    if (notification->previous) {
+        LDi_rc_decrement(&notification->previous->rc);
+    }
+
+    LDi_rc_decrement(&notification->current->rc);
+    LDFree(notification->key);
+    LDFree(notification);
+}
+
 void
 LDi_storeDestroy(struct LDStore *const store)
 {
+    struct LDFlagNotification *notification, *tmp;
+
     if (store) {
-        LDi_storeFreeHash(store->flags);
+        HASH_ITER(hh, store->notifications, notification, tmp)
+        {
+            HASH_DEL(store->notifications, notification);
+            LDi_freeNotification(notification);
+        }
+
+        LDi_storeReleaseTable(store->table);
         LDi_rwlock_destroy(&store->lock);
+        LDi_mutex_destroy(&store->notificationLock);
         LDi_freeListeners(&store->listeners);
     }
 }
@@ -83,19 +363,212 @@ LDi_allocateStoreNode(struct LDFlag flag)
         return NULL;
     }
 
-    node->flag = flag;
+    node->flag        = flag;
+    node->valueLength = 0;
+
+    if (flag.value && LDJSONGetType(flag.value) == LDText) {
+        node->valueLength = strlen(LDGetText(flag.value));
+    }
+
+    LDi_reasonDecode(flag.reason, &node->reason);
 
     return node;
 }
 
+/* Describes one side of a change. Node may be NULL. */
 static void
-LDi_fireListenersFor(
-    struct LDStore *const store, const char *const key, const LDBoolean deleted)
+LDi_describeNode(
+    const struct LDStoreNode *const node,
+    const struct LDJSON **const     value,
+    int *const                      version,
+    int *const                      variation)
 {
+    *value     = NULL;
+    *version   = -1;
+    *variation = -1;
+
+    if (node) {
+        *version = node->flag.version;
+
+        if (!node->flag.deleted) {
+            *value     = node->flag.value;
+            *variation = node->flag.variation;
+        }
+    }
+}
+
+/* Records a change for delivery once the write lock is released, which
+ * must be held. A change to a flag that is still pending replaces the
+ * pending new state, keeping the original old state. */
+static void
+LDi_queueNotification(
+    struct LDStore *const     store,
+    struct LDStoreNode *const previous,
+    struct LDStoreNode *const current,
+    const double              now)
+{
+    struct LDFlagNotification *notification;
+
     LD_ASSERT(store);
-    LD_ASSERT(key);
+    LD_ASSERT(current);
+
+    if (!LDi_listenersContain(store->listeners, current->flag.key)) {
+        return;
+    }
+
+    LDi_mutex_lock(&store->notificationLock);
+
+    HASH_FIND_STR(store->notifications, current->flag.key, notification);
+
+    if (notification) {
+        LDi_rc_increment(&current->rc);
+        LDi_rc_decrement(&notification->current->rc);
+
+        notification->current = current;
+
+        store->listenerStatistics.coalesced++;
+    } else {
+        if (!(notification = LDAlloc(sizeof(struct LDFlagNotification)))) {
+            goto error;
+        }
+
+        if (!(notification->key = LDStrDup(current->flag.key))) {
+            LDFree(notification);
+
+            goto error;
+        }
+
+        if (previous) {
+            LDi_rc_increment(&previous->rc);
+        }
+
+        LDi_rc_increment(&current->rc);
+
+        notification->previous = previous;
+        notification->current  = current;
+        notification->queued   = now;
+
+        HASH_ADD_KEYPTR(hh, store->notifications, notification->key,
+            strlen(notification->key), notification);
+    }
 
-    LDi_listenersDispatch(store->listeners, key, deleted);
+    LDi_mutex_unlock(&store->notificationLock);
+
+    return;
+
+error:
+    LDi_mutex_unlock(&store->notificationLock);
+
+    LD_LOG(LD_LOG_ERROR, "failed to allocate flag notification");
+}
+
+/* Called without any lock held, so that listeners may use the client. */
+static void
+LDi_deliverNotification(
+    struct LDStore *const                  store,
+    const struct LDFlagNotification *const notification)
+{
+    LDFlagChange              change;
+    double                    now, latency;
+    LDBoolean                 suppressed;
+    struct ListenerCallbacks *callbacks;
+
+    change.key     = notification->key;
+    change.deleted = notification->current->flag.deleted;
+
+    LDi_describeNode(notification->previous, &change.oldValue,
+        &change.oldVersion, &change.oldVariation);
+    LDi_describeNode(notification->current, &change.newValue,
+        &change.newVersion, &change.newVariation);
+
+    suppressed = store->suppressUnchanged &&
+        (change.oldValue == NULL || change.newValue == NULL
+             ? change.oldValue == change.newValue
+             : LDJSONCompare(change.oldValue, change.newValue));
+
+    latency = 0;
+
+    if (LDi_getMonotonicMilliseconds(&now) && now > notification->queued) {
+        latency = now - notification->queued;
+    }
+
+    LDi_mutex_lock(&store->notificationLock);
+
+    if (suppressed) {
+        store->listenerStatistics.suppressed++;
+    } else {
+        store->listenerStatistics.delivered++;
+        store->listenerStatistics.lastLatencyMilliseconds = latency;
+
+        if (latency > store->listenerStatistics.maxLatencyMilliseconds) {
+            store->listenerStatistics.maxLatencyMilliseconds = latency;
+        }
+    }
+
+    LDi_mutex_unlock(&store->notificationLock);
+
+    if (suppressed) {
+        return;
+    }
+
+    LDi_rwlock_rdlock(&store->lock);
+    callbacks = LDi_listenersCopy(store->listeners, change.key);
+    LDi_rwlock_rdunlock(&store->lock);
+
+    if (callbacks) {
+        LDi_listenerCallbacksInvoke(callbacks, &change);
+        LDi_listenerCallbacksFree(callbacks);
+    }
+}
+
+void
+LDi_storeDispatch(struct LDStore *const store)
+{
+    struct LDFlagNotification *batch, *notification, *tmp;
+
+    LD_ASSERT(store);
+
+    LDi_mutex_lock(&store->notificationLock);
+
+    /* changes made during delivery, by other threads or by listeners, are
+     * left for the delivery in progress to pick up, keeping them in order */
+    if (store->dispatching) {
+        LDi_mutex_unlock(&store->notificationLock);
+
+        return;
+    }
+
+    store->dispatching = LDBooleanTrue;
+
+    while ((batch = store->notifications)) {
+        store->notifications = NULL;
+        LDi_mutex_unlock(&store->notificationLock);
+
+        HASH_ITER(hh, batch, notification, tmp)
+        {
+            HASH_DEL(batch, notification);
+            LDi_deliverNotification(store, notification);
+            LDi_freeNotification(notification);
+        }
+
+        LDi_mutex_lock(&store->notificationLock);
+    }
+
+    store->dispatching = LDBooleanFalse;
+
+    LDi_mutex_unlock(&store->notificationLock);
+}
+
+void
+LDi_storeListenerStatistics(
+    struct LDStore *const store, LDListenerStatistics *const statistics)
+{
+    LD_ASSERT(store);
+    LD_ASSERT(statistics);
+
+    LDi_mutex_lock(&store->notificationLock);
+    *statistics = store->listenerStatistics;
+    LDi_mutex_unlock(&store->notificationLock);
 }
 
 enum versionStatus {
@@ -125,8 +598,10 @@ versionStatus(struct LDStoreNode *existingFlag, int incomingVersion)
 LDBoolean
 LDi_storeUpsert(struct LDStore *const store, struct LDFlag flag)
 {
-    struct LDStoreNode *existing, *replacement;
-    enum versionStatus status;
+    struct LDStoreNode * existing, *replacement;
+    struct LDStoreTable *table, *previous;
+    enum versionStatus   status;
+    double               now;
 
     LD_ASSERT(store);
     LD_ASSERT(flag.key);
@@ -139,49 +614,113 @@ LDi_storeUpsert(struct LDStore *const store, struct LDFlag flag)
         return LDBooleanFalse;
     }
 
+    previous = NULL;
+    now      = 0;
+
+    LDi_getMonotonicMilliseconds(&now);
+
     LDi_rwlock_wrlock(&store->lock);
 
-    HASH_FIND_STR(store->flags, flag.key, existing);
+    existing = store->table
+        ? LDi_flagIndexFind(&store->table->flags, flag.key)
+        : NULL;
 
     status = versionStatus(existing, flag.version);
 
-    switch (status) {
-        case VERSION_NEW: {
-            HASH_ADD_KEYPTR(hh, store->flags, flag.key, strlen(flag.key), replacement);
-            break;
+    if (status == VERSION_STALE) {
+        LDi_destroyStoreNode(replacement);
+    } else if (store->table && LDi_rc_unique(&store->table->rc)) {
+        /* Without snapshots only the store references the table, and other
+         * readers hold the lock, so the table is patched in place rather
+         * than copying the references to every node. */
+        if (!LDi_flagIndexInsert(
+                &store->table->flags, replacement, &existing))
+        {
+            LDi_rwlock_wrunlock(&store->lock);
+
+            LD_LOG(LD_LOG_ERROR, "failed to grow flag index");
+
+            LDi_destroyStoreNode(replacement);
+
+            return LDBooleanFalse;
         }
-        case VERSION_INCREASED: {
-            HASH_DEL(store->flags, existing);
+
+        LDi_updateStoreSlot(store, store->table, replacement);
+
+        LDi_storeAdvanceGeneration(store);
+
+        LDi_queueNotification(store, existing, replacement, now);
+
+        if (existing) {
             LDi_rc_decrement(&existing->rc);
-            HASH_ADD_KEYPTR(hh, store->flags, flag.key, strlen(flag.key), replacement);
-            break;
         }
-        case VERSION_STALE: {
+    } else {
+        /* tables are never modified once shared, so that snapshots may
+         * read them without the lock */
+        if (!(table = LDi_copyStoreTable(store, store->table)) ||
+            !LDi_flagIndexInsert(&table->flags, replacement, &existing))
+        {
+            LDi_rwlock_wrunlock(&store->lock);
+
+            LD_LOG(LD_LOG_ERROR, "failed to grow flag index");
+
+            LDi_storeReleaseTable(table);
             LDi_destroyStoreNode(replacement);
-            break;
+
+            return LDBooleanFalse;
         }
-    }
 
-    if (status != VERSION_STALE) {
-        LDi_fireListenersFor(store, flag.key, flag.deleted);
+        if (table->slots) {
+            LDi_updateStoreSlot(store, table, replacement);
+        } else {
+            LDi_assignStoreSlots(store, table);
+        }
+
+        previous     = store->table;
+        store->table = table;
+
+        LDi_storeAdvanceGeneration(store);
+
+        LDi_queueNotification(store, existing, replacement, now);
+
+        if (existing) {
+            LDi_rc_decrement(&existing->rc);
+        }
     }
 
     LDi_rwlock_wrunlock(&store->lock);
 
+    LDi_storeReleaseTable(previous);
+
+    LDi_storeDispatch(store);
+
     return LDBooleanTrue;
 }
 
 struct LDStoreNode *
-LDi_storeGet(struct LDStore *const store, const char *const key)
+LDi_storeGetKey(struct LDStore *const store, const LDFlagKey *const key)
 {
     struct LDStoreNode *lookup;
 
     LD_ASSERT(store);
     LD_ASSERT(key);
 
+    lookup = NULL;
+
     LDi_rwlock_rdlock(&store->lock);
 
-    HASH_FIND_STR(store->flags, key, lookup);
+    if (store->table) {
+        /* only an element of the manifest may use its slot, a copy or a
+         * forged key may carry a stale slot for a different flag */
+        if (key->slot && key->slot <= store->manifestCount &&
+            store->table->slots && key == &store->manifest[key->slot - 1])
+        {
+            lookup = store->table->slots[key->slot - 1];
+        } else {
+            lookup = LDi_flagIndexFindHashed(
+                &store->table->flags, key->key, key->length, key->hash);
+        }
+    }
 
     if (lookup && !lookup->flag.deleted) {
         LDi_rc_increment(&lookup->rc);
@@ -196,6 +735,22 @@ LDi_storeGet(struct LDStore *const store, const char *const key)
     }
 }
 
+struct LDStoreNode *
+LDi_storeGet(struct LDStore *const store, const char *const key)
+{
+    LDFlagKey prepared;
+
+    LD_ASSERT(store);
+    LD_ASSERT(key);
+
+    prepared.key    = key;
+    prepared.length = strlen(key);
+    prepared.hash   = LDi_flagIndexHash(key, prepared.length);
+    prepared.slot   = 0;
+
+    return LDi_storeGetKey(store, &prepared);
+}
+
 LDBoolean
 LDi_storeDelete(
     struct LDStore *const store,
@@ -229,20 +784,25 @@ LDi_storePut(
     struct LDFlag *       flags,
     const unsigned int    flagCount)
 {
-    size_t              i;
-    LDBoolean           failed;
-    struct LDStoreNode *flagsHash, *oldHash;
+    size_t               i;
+    LDBoolean            failed;
+    struct LDStoreTable *table, *previous;
 
     LD_ASSERT(store);
 
-    failed    = LDBooleanFalse;
-    flagsHash = NULL;
+    failed = LDBooleanFalse;
+
+    if (!(table = LDi_allocateStoreTable())) {
+        LD_LOG(LD_LOG_ERROR, "failed to allocate flag table");
+
+        failed = LDBooleanTrue;
+    }
 
     for (i = 0; i < flagCount; i++) {
         if (failed) {
             LDi_flag_destroy(&flags[i]);
         } else {
-            struct LDStoreNode *node;
+            struct LDStoreNode *node, *duplicate;
 
             if (!(node = LDi_allocateStoreNode(flags[i]))) {
                 LD_LOG(LD_LOG_ERROR, "failed to allocate storage node for flag");
@@ -252,32 +812,60 @@ LDi_storePut(
                 continue;
             }
 
-            HASH_ADD_KEYPTR(
-                hh, flagsHash, node->flag.key, strlen(node->flag.key), node);
+            if (!LDi_flagIndexInsert(&table->flags, node, &duplicate)) {
+                LD_LOG(LD_LOG_ERROR, "failed to grow flag index");
+
+                LDi_destroyStoreNode(node);
+
+                failed = LDBooleanTrue;
+
+                continue;
+            }
+
+            /* the last occurrence of a key wins */
+            if (duplicate) {
+                LDi_destroyStoreNode(duplicate);
+            }
         }
     }
 
     LDFree(flags);
 
     if (failed) {
-        LDi_storeFreeHash(flagsHash);
+        LDi_storeReleaseTable(table);
     } else {
-        struct LDStoreNode *node, *tmp;
+        struct LDStoreNode *node;
+        unsigned int        position;
+        double              now;
+
+        LDi_assignStoreSlots(store, table);
+
+        now = 0;
+
+        LDi_getMonotonicMilliseconds(&now);
 
         LDi_rwlock_wrlock(&store->lock);
 
-        oldHash            = store->flags;
-        store->flags       = flagsHash;
+        previous           = store->table;
+        store->table       = table;
         store->initialized = LDBooleanTrue;
 
-        HASH_ITER(hh, store->flags, node, tmp)
-        {
-            LDi_fireListenersFor(store, node->flag.key, LDBooleanFalse);
+        LDi_storeAdvanceGeneration(store);
+
+        position = 0;
+
+        while ((node = LDi_flagIndexNext(&table->flags, &position))) {
+            LDi_queueNotification(store,
+                previous ? LDi_flagIndexFind(&previous->flags, node->flag.key)
+                         : NULL,
+                node, now);
         }
 
         LDi_rwlock_wrunlock(&store->lock);
 
-        LDi_storeFreeHash(oldHash);
+        LDi_storeReleaseTable(previous);
+
+        LDi_storeDispatch(store);
     }
 
     return !failed;
@@ -289,8 +877,8 @@ LDi_storeGetAll(
     struct LDStoreNode ***const flags,
     unsigned int *const         flagCount)
 {
-    unsigned int        count;
-    struct LDStoreNode *node, *tmp, **dupe, **iter;
+    unsigned int        count, position;
+    struct LDStoreNode *node, **dupe, **iter;
 
     LD_ASSERT(store);
     LD_ASSERT(flags);
@@ -298,7 +886,7 @@ LDi_storeGetAll(
 
     LDi_rwlock_rdlock(&store->lock);
 
-    count = HASH_COUNT(store->flags);
+    count = store->table ? store->table->flags.count : 0;
 
     if (count == 0) {
         LDi_rwlock_rdunlock(&store->lock);
@@ -313,10 +901,10 @@ LDi_storeGetAll(
         return LDBooleanFalse;
     }
 
-    iter = dupe;
+    iter     = dupe;
+    position = 0;
 
-    HASH_ITER(hh, store->flags, node, tmp)
-    {
+    while ((node = LDi_flagIndexNext(&store->table->flags, &position))) {
         *iter = node;
         LDi_rc_increment(&node->rc);
         iter++;
@@ -330,16 +918,50 @@ LDi_storeGetAll(
     return LDBooleanTrue;
 }
 
+void
+LDi_storeForEach(
+    struct LDStore *const store,
+    LDFlagVisitor         visitor,
+    void *const           context)
+{
+    struct LDStoreTable *table;
+    struct LDStoreNode * node;
+    unsigned int         position;
+
+    LD_ASSERT(store);
+    LD_ASSERT(visitor);
+
+    position = 0;
+
+    /* visitors run without the lock, and may change the store */
+    if (!(table = LDi_storeAcquireTable(store))) {
+        return;
+    }
+
+    while ((node = LDi_flagIndexNext(&table->flags, &position))) {
+        if (node->flag.deleted) {
+            continue;
+        }
+
+        if (!visitor(node->flag.key, node->flag.value, context)) {
+            break;
+        }
+    }
+
+    LDi_storeReleaseTable(table);
+}
+
 struct LDJSON *
 LDi_storeGetJSON(struct LDStore *const store)
 {
     struct LDJSON *     result, *flag;
-    struct LDStoreNode *node, *tmp;
+    struct LDStoreNode *node;
+    unsigned int        position;
 
-    result = NULL;
-    flag   = NULL;
-    node   = NULL;
-    tmp    = NULL;
+    result   = NULL;
+    flag     = NULL;
+    node     = NULL;
+    position = 0;
 
     LD_ASSERT(store);
 
@@ -349,9 +971,9 @@ LDi_storeGetJSON(struct LDStore *const store)
 
     LDi_rwlock_rdlock(&store->lock);
 
-    HASH_ITER(hh, store->flags, node, tmp)
+    while (store->table &&
+        (node = LDi_flagIndexNext(&store->table->flags, &position)))
     {
-
         if (node->flag.deleted) {
             continue;
         }
@@ -409,3 +1031,40 @@ LDi_storeUnregisterListener(struct LDStore *const store, const char *const flagK
     LDi_listenerRemove(&store->listeners, flagKey, op);
     LDi_rwlock_wrunlock(&store->lock);
 }
+
+
+LDBoolean
+LDi_storeRegisterChangeListener(
+    struct LDStore *const store,
+    const char *const     flagKey,
+    LDFlagChangeListener  op,
+    void *const           context)
+{
+    LDBoolean status;
+
+    LD_ASSERT(store);
+    LD_ASSERT(flagKey);
+    LD_ASSERT(op);
+
+    LDi_rwlock_wrlock(&store->lock);
+    status = LDi_listenerAddChange(&store->listeners, flagKey, op, context);
+    LDi_rwlock_wrunlock(&store->lock);
+
+    return status;
+}
+
+void
+LDi_storeUnregisterChangeListener(
+    struct LDStore *const store,
+    const char *const     flagKey,
+    LDFlagChangeListener  op,
+    void *const           context)
+{
+    LD_ASSERT(store);
+    LD_ASSERT(flagKey);
+    LD_ASSERT(op);
+
+    LDi_rwlock_wrlock(&store->lock);
+    LDi_listenerRemoveChange(&store->listeners, flagKey, op, context);
+    LDi_rwlock_wrunlock(&store->lock);
+}
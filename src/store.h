@@ -4,23 +4,61 @@
 
 #include "concurrency.h"
 #include "flag.h"
+#include "flag_index.h"
 #include "reference_count.h"
-#include "uthash.h"
 #include "flag_change_listener.h"
 
 struct LDStoreNode
 {
     struct LDFlag  flag;
     struct ld_rc_t rc;
-    UT_hash_handle hh;
+    /* length of the value when it is text, otherwise zero */
+    size_t         valueLength;
+    /* decoded from flag.reason, which owns its strings */
+    LDEvaluationReason reason;
 };
 
+/* One version of the store contents. A table is only modified, under the
+ * write lock, while the store holds the only reference, otherwise a change
+ * publishes a copy. So holders of a reference may read it without the
+ * store lock. Each table owns a reference to every node it indexes. */
+struct LDStoreTable
+{
+    struct LDFlagIndex flags;
+    /* node for each manifest key, by slot, or NULL without a manifest */
+    struct LDStoreNode **slots;
+    struct ld_rc_t     rc;
+};
+
+/* A change waiting to be delivered to listeners. */
+struct LDFlagNotification;
+
 struct LDStore
 {
-    struct LDStoreNode     *flags;
+    /* replaced on every change, NULL while the store is empty */
+    struct LDStoreTable    *table;
+    /* guarded by the store lock, and copied before callbacks are invoked */
     struct ChangeListener  *listeners;
     LDBoolean               initialized;
+    /* skip listeners when the value of a flag is unchanged */
+    LDBoolean               suppressUnchanged;
+    /* keys resolved into the slots of every table, not owned */
+    const LDFlagKey        *manifest;
+    unsigned int            manifestCount;
     ld_rwlock_t             lock;
+    /* Changes whenever the contents change. Values are unique across all
+     * stores in the process, so may be used to validate cached results. */
+    unsigned long           generation;
+    /* Pending changes in arrival order, indexed by key so that repeated
+     * changes to a flag coalesce. Guarded by notificationLock, as are
+     * the statistics. */
+    struct LDFlagNotification *notifications;
+    LDListenerStatistics       listenerStatistics;
+    ld_mutex_t                 notificationLock;
+    /* Set while a thread delivers notifications, so that delivery is
+     * serialized without holding a lock while listeners run. Guarded by
+     * notificationLock, which is ordered after the store lock. */
+    LDBoolean                  dispatching;
 };
 
 LDBoolean
@@ -29,6 +67,13 @@ LDi_storeInitialize(struct LDStore *const store);
 void
 LDi_storeDestroy(struct LDStore *const store);
 
+/* Must be called before any flags are stored. */
+void
+LDi_storeSetManifest(
+    struct LDStore *const  store,
+    const LDFlagKey *const keys,
+    const unsigned int     keyCount);
+
 LDBoolean
 LDi_storeUpsert(struct LDStore *const store, struct LDFlag flag);
 
@@ -47,6 +92,29 @@ LDi_storeDelete(
 struct LDStoreNode *
 LDi_storeGet(struct LDStore *const store, const char *const key);
 
+/* As LDi_storeGet, with the length and hash already computed. Keys with a
+ * manifest slot are read from the slots of the table without hashing. */
+struct LDStoreNode *
+LDi_storeGetKey(struct LDStore *const store, const LDFlagKey *const key);
+
+/* Returns a reference to the current table, or NULL if the store is empty.
+ * Release it with LDi_storeReleaseTable. */
+struct LDStoreTable *
+LDi_storeAcquireTable(struct LDStore *const store);
+
+void
+LDi_storeReleaseTable(struct LDStoreTable *const table);
+
+/* Looks up a flag that is not deleted without taking a node reference. The
+ * node is valid while the table is. Table may be NULL. */
+struct LDStoreNode *
+LDi_storeTableGet(
+    const struct LDStoreTable *const table, const char *const key);
+
+/* May be read without holding the store lock. */
+unsigned long
+LDi_storeGeneration(struct LDStore *const store);
+
 LDBoolean
 LDi_storeGetAll(
     struct LDStore *const       store,
@@ -56,6 +124,26 @@ LDi_storeGetAll(
 struct LDJSON *
 LDi_storeGetJSON(struct LDStore *const store);
 
+/* Calls visitor for every flag that is not deleted, until it returns
+ * false. Flags are visited as of the call, without holding the store lock,
+ * so a visitor may change the store. */
+void
+LDi_storeForEach(
+    struct LDStore *const store,
+    LDFlagVisitor         visitor,
+    void *const           context);
+
+/* Delivers pending changes to listeners. Called after every change, once
+ * the store lock is released, so listeners may evaluate flags and register
+ * or unregister listeners. If a delivery is already in progress, on any
+ * thread, the changes are left for it and this returns immediately. */
+void
+LDi_storeDispatch(struct LDStore *const store);
+
+void
+LDi_storeListenerStatistics(
+    struct LDStore *const store, LDListenerStatistics *const statistics);
+
 LDBoolean
 LDi_storeRegisterListener(
     struct LDStore *const store, const char *const flagKey, LDlistenerfn op);
@@ -64,5 +152,19 @@ void
 LDi_storeUnregisterListener(
     struct LDStore *const store, const char *const flagKey, LDlistenerfn op);
 
+LDBoolean
+LDi_storeRegisterChangeListener(
+    struct LDStore *const store,
+    const char *const     flagKey,
+    LDFlagChangeListener  op,
+    void *const           context);
+
+void
+LDi_storeUnregisterChangeListener(
+    struct LDStore *const store,
+    const char *const     flagKey,
+    LDFlagChangeListener  op,
+    void *const           context);
+
 void
 LDi_storeFreeFlags(struct LDStore *const store);
@@ -109,3 +109,89 @@ TEST_F(AllFlagsWithClientFixture, AllFlagsDeletedFlag) {
     LDJSONFree(expected);
     LDJSONFree(actual);
 }
+
+static LDBoolean
+collectFlag(const char *const key, const struct LDJSON *const value, void *const context) {
+    return LDObjectSetKey((struct LDJSON *) context, key, LDJSONDuplicate(value));
+}
+
+static LDBoolean
+countFlag(const char *const key, const struct LDJSON *const value, void *const context) {
+    (*(int *) context)++;
+    return LDBooleanFalse;
+}
+
+TEST_F(AllFlagsWithClientFixture, ForEachFlagMatchesAllFlags) {
+    struct LDFlag flag;
+    struct LDJSON *visited, *actual;
+    int visits;
+
+    flag.key = LDStrDup("test");
+    flag.value = LDNewText("alice");
+    flag.version = 2;
+    flag.variation = 3;
+    flag.trackEvents = LDBooleanFalse;
+    flag.trackReason = LDBooleanFalse;
+    flag.reason = NULL;
+    flag.debugEventsUntilDate = 0;
+    flag.deleted = LDBooleanFalse;
+    ASSERT_TRUE(LDi_storeUpsert(&client->store, flag));
+
+    flag.key = LDStrDup("test2");
+    flag.value = LDNewNumber(5);
+    ASSERT_TRUE(LDi_storeUpsert(&client->store, flag));
+
+    ASSERT_TRUE(LDi_storeDelete(&client->store, "test2", 3));
+
+    flag.key = LDStrDup("test3");
+    flag.value = LDNewBool(LDBooleanTrue);
+    ASSERT_TRUE(LDi_storeUpsert(&client->store, flag));
+
+    ASSERT_TRUE(visited = LDNewObject());
+    ASSERT_TRUE(LDClientForEachFlag(client, collectFlag, visited));
+
+    ASSERT_TRUE(actual = LDAllFlags(client));
+    ASSERT_TRUE(LDJSONCompare(visited, actual));
+    ASSERT_EQ(LDCollectionGetSize(visited), 2);
+
+    /* the visitor stops the walk by returning false */
+    visits = 0;
+    ASSERT_TRUE(LDClientForEachFlag(client, countFlag, &visits));
+    ASSERT_EQ(visits, 1);
+
+    LDJSONFree(visited);
+    LDJSONFree(actual);
+}
+
+static LDBoolean
+deleteFlag(const char *const key, const struct LDJSON *const value, void *const context) {
+    return LDi_storeDelete(&((struct LDClient *) context)->store, key, 10);
+}
+
+TEST_F(AllFlagsWithClientFixture, ForEachFlagVisitorMayChangeFlags) {
+    struct LDFlag flag;
+    struct LDJSON *actual;
+
+    flag.key = LDStrDup("test");
+    flag.value = LDNewText("alice");
+    flag.version = 2;
+    flag.variation = 3;
+    flag.trackEvents = LDBooleanFalse;
+    flag.trackReason = LDBooleanFalse;
+    flag.reason = NULL;
+    flag.debugEventsUntilDate = 0;
+    flag.deleted = LDBooleanFalse;
+    ASSERT_TRUE(LDi_storeUpsert(&client->store, flag));
+
+    flag.key = LDStrDup("test2");
+    flag.value = LDNewNumber(5);
+    ASSERT_TRUE(LDi_storeUpsert(&client->store, flag));
+
+    /* takes the store write lock from inside the walk */
+    ASSERT_TRUE(LDClientForEachFlag(client, deleteFlag, client));
+
+    ASSERT_TRUE(actual = LDAllFlags(client));
+    ASSERT_EQ(LDCollectionGetSize(actual), 0);
+
+    LDJSONFree(actual);
+}
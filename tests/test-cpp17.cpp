@@ -0,0 +1,136 @@
+#include "gtest/gtest.h"
+#include "commonfixture.h"
+
+#if __cplusplus >= 201703L
+
+#include <string>
+
+#include <launchdarkly/sdk.hpp>
+
+extern "C" {
+#include "ldinternal.h"
+#include "utility.h"
+}
+
+using namespace launchdarkly;
+
+class CPP17Fixture : public CommonFixture {
+protected:
+    Client client{nullptr};
+
+    void SetUp() override {
+        CommonFixture::SetUp();
+
+        struct LDConfig *config;
+
+        LD_ASSERT(config = LDConfigNew("abc"));
+        LDConfigSetOffline(config, LDBooleanTrue);
+
+        client = Client(config, User("test-user"), 0);
+
+        LD_ASSERT(client);
+        LD_ASSERT(LDClientRestoreFlags(client.get(),
+            "{\"bool\":{\"value\":true,\"version\":1},"
+            "\"number\":{\"value\":7,\"version\":1},"
+            "\"text\":{\"value\":\"stored\",\"version\":1},"
+            "\"object\":{\"value\":{\"a\":1},\"version\":1}}"));
+    }
+
+    void TearDown() override {
+        client = Client(nullptr);
+        CommonFixture::TearDown();
+    }
+};
+
+TEST_F(CPP17Fixture, CompileTimeHashMatchesStore) {
+    constexpr FlagKey key("checkout-flow");
+
+    static_assert(key.name().size() == 13, "length is computed at compile time");
+
+    ASSERT_EQ(key.hash(), LDi_hash32("checkout-flow", 13));
+
+    const std::string lengths("abcdefgh");
+
+    for (std::size_t i = 0; i <= lengths.size(); i++) {
+        ASSERT_EQ(detail::murmur3(std::string_view(lengths.data(), i)),
+            LDi_hash32(lengths.data(), i));
+    }
+}
+
+TEST_F(CPP17Fixture, PrimitiveVariations) {
+    constexpr FlagKey boolKey("bool");
+
+    ASSERT_TRUE(client.variation(boolKey, false));
+    ASSERT_EQ(client.variation("number", 0), 7);
+    ASSERT_EQ(client.variation("number", 0.5), 7.0);
+    ASSERT_EQ(client.variation("missing", 3), 3);
+
+    const std::string name("number");
+
+    ASSERT_EQ(client.variation(std::string_view(name), 0), 7);
+
+    char buffer[64] = "number";
+
+    ASSERT_EQ(client.variation(buffer, 0), 7);
+}
+
+TEST_F(CPP17Fixture, BorrowedVariations) {
+    std::string_view fallback("fallback");
+    auto text = client.variation<std::string_view>("text", fallback);
+    auto missing = client.variation<std::string_view>("missing", fallback);
+    auto mismatched = client.variation<std::string_view>("number", fallback);
+
+    ASSERT_TRUE(text.fromStore());
+    ASSERT_EQ(text.view(), "stored");
+    ASSERT_FALSE(missing.fromStore());
+    ASSERT_EQ(missing.view(), "fallback");
+    ASSERT_EQ(mismatched.view(), "fallback");
+
+    /* the borrowed value survives an update */
+    auto moved = std::move(text);
+    LD_ASSERT(LDClientRestoreFlags(client.get(), "{}"));
+    ASSERT_EQ(moved.view(), "stored");
+
+    struct LDJSON *json;
+    ASSERT_TRUE(json = LDNewNull());
+
+    ASSERT_TRUE(LDClientRestoreFlags(client.get(),
+        "{\"object\":{\"value\":{\"a\":1},\"version\":2}}"));
+
+    {
+        auto object = client.variation<const struct LDJSON *>("object", json);
+
+        ASSERT_TRUE(object.fromStore());
+        ASSERT_EQ(LDGetNumber(LDObjectLookup(object.get(), "a")), 1);
+    }
+
+    ASSERT_EQ(client.variation<const struct LDJSON *>("missing", json).get(), json);
+
+    LDJSONFree(json);
+}
+
+TEST_F(CPP17Fixture, StringFallbackIsReportedInEvents) {
+    struct LDJSON *payload;
+    char *serialized;
+    const std::string fallback("fallback-and-more");
+
+    /* a view that is not NULL terminated */
+    ASSERT_EQ(client.variation<std::string_view>("missing",
+        std::string_view(fallback.data(), 8)).view(), "fallback");
+
+    /* as well as one too long to copy on the stack */
+    const std::string longFallback(200, 'x');
+    ASSERT_EQ(client.variation<std::string_view>("missing2",
+        std::string_view(longFallback)).view(), longFallback);
+
+    ASSERT_TRUE(LDi_bundleEventPayload(client.get()->eventProcessor, &payload));
+    ASSERT_TRUE(payload);
+    ASSERT_TRUE(serialized = LDJSONSerialize(payload));
+    ASSERT_TRUE(strstr(serialized, "\"default\":\"fallback\""));
+    ASSERT_TRUE(strstr(serialized, ("\"default\":\"" + longFallback + "\"").c_str()));
+
+    LDFree(serialized);
+    LDJSONFree(payload);
+}
+
+#endif
@@ -0,0 +1,96 @@
+#include "gtest/gtest.h"
+#include "commonfixture.h"
+
+extern "C" {
+#include <launchdarkly/api.h>
+
+#include "event_delivery.h"
+}
+
+static const char *const payloadId = "00000000-0000-4000-8000-000000000001";
+
+// Inherit from the CommonFixture to give a reasonable name for the test output.
+class EventDeliveryFixture : public CommonFixture {
+};
+
+static struct LDEventBatch *
+newBatch(const char *const payload) {
+    return LDi_newEventBatch(LDStrDup(payload), payloadId);
+}
+
+TEST_F(EventDeliveryFixture, BoundsBatchesInFlight) {
+    struct LDEventDelivery delivery;
+    struct LDEventBatch *first, *second, *third;
+
+    ASSERT_TRUE(LDi_deliveryInitialize(&delivery, 2, 1024));
+
+    ASSERT_TRUE(first = newBatch("[1]"));
+    ASSERT_TRUE(second = newBatch("[2]"));
+    ASSERT_TRUE(third = newBatch("[3]"));
+
+    ASSERT_TRUE(LDi_deliveryPush(&delivery, first, LDBooleanFalse));
+    ASSERT_TRUE(LDi_deliveryPush(&delivery, second, LDBooleanFalse));
+    ASSERT_FALSE(LDi_deliveryPush(&delivery, third, LDBooleanFalse));
+
+    /* popped batches are still in flight until done */
+    ASSERT_EQ(LDi_deliveryPop(&delivery), first);
+    ASSERT_FALSE(LDi_deliveryPush(&delivery, third, LDBooleanFalse));
+
+    LDi_deliveryDone(&delivery, first, LDBooleanFalse);
+    LDi_freeEventBatch(first);
+    ASSERT_FALSE(LDi_deliveryHealthy(&delivery));
+
+    ASSERT_TRUE(LDi_deliveryPush(&delivery, third, LDBooleanFalse));
+
+    /* remaining batches are popped after closing */
+    LDi_deliveryClose(&delivery);
+    ASSERT_EQ(LDi_deliveryPop(&delivery), second);
+    LDi_deliveryDone(&delivery, second, LDBooleanTrue);
+    LDi_freeEventBatch(second);
+    ASSERT_TRUE(LDi_deliveryHealthy(&delivery));
+
+    /* destroying frees batches that were never popped */
+    LDi_deliveryDestroy(&delivery);
+}
+
+TEST_F(EventDeliveryFixture, BoundsBytesInFlight) {
+    struct LDEventDelivery delivery;
+    struct LDEventBatch *first, *second;
+
+    ASSERT_TRUE(LDi_deliveryInitialize(&delivery, 4, 8));
+
+    /* a single batch larger than the bound is accepted on its own */
+    ASSERT_TRUE(first = newBatch("[1,2,3,4,5]"));
+    ASSERT_TRUE(second = newBatch("[1]"));
+
+    ASSERT_TRUE(LDi_deliveryPush(&delivery, first, LDBooleanFalse));
+    ASSERT_FALSE(LDi_deliveryPush(&delivery, second, LDBooleanFalse));
+
+    ASSERT_EQ(LDi_deliveryPop(&delivery), first);
+    LDi_deliveryDone(&delivery, first, LDBooleanTrue);
+    LDi_freeEventBatch(first);
+
+    ASSERT_TRUE(LDi_deliveryPush(&delivery, second, LDBooleanFalse));
+
+    LDi_deliveryClose(&delivery);
+    ASSERT_FALSE(LDi_deliverySleep(&delivery, 1000));
+    LDi_deliveryDestroy(&delivery);
+}
+
+TEST_F(EventDeliveryFixture, BackoffIsJitteredAndBounded) {
+    for (int i = 0; i < 100; i++) {
+        unsigned int delay;
+
+        delay = LDi_deliveryBackoff(1, 30000);
+        ASSERT_GE(delay, 500);
+        ASSERT_LE(delay, 1000);
+
+        delay = LDi_deliveryBackoff(3, 30000);
+        ASSERT_GE(delay, 2000);
+        ASSERT_LE(delay, 4000);
+
+        delay = LDi_deliveryBackoff(40, 30000);
+        ASSERT_GE(delay, 15000);
+        ASSERT_LE(delay, 30000);
+    }
+}
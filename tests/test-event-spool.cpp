@@ -0,0 +1,223 @@
+#include "gtest/gtest.h"
+#include "commonfixture.h"
+
+#include <cstdio>
+#include <cstring>
+
+extern "C" {
+#include <launchdarkly/api.h>
+
+#include "event_spool.h"
+#include "utility.h"
+}
+
+#define SPOOL_PATH "test-event-spool.tmp"
+
+static const char *const firstId = "00000000-0000-4000-8000-000000000001";
+static const char *const secondId = "00000000-0000-4000-8000-000000000002";
+static const char *const thirdId = "00000000-0000-4000-8000-000000000003";
+
+// Inherit from the CommonFixture to give a reasonable name for the test output.
+class EventSpoolFixture : public CommonFixture {
+protected:
+    void SetUp() override {
+        CommonFixture::SetUp();
+        remove(SPOOL_PATH);
+    }
+
+    void TearDown() override {
+        remove(SPOOL_PATH);
+        CommonFixture::TearDown();
+    }
+};
+
+static void
+expectNext(struct LDEventSpool *const spool, const char *const id, const char *const expected) {
+    char payloadId[LD_UUID_SIZE + 1];
+    char *payload;
+
+    ASSERT_TRUE(LDi_eventSpoolNext(spool, payloadId, &payload));
+    ASSERT_STREQ(payloadId, id);
+    ASSERT_STREQ(payload, expected);
+    LDFree(payload);
+}
+
+/* reads the oldest pending record and returns it to the spool */
+static void
+expectOldest(struct LDEventSpool *const spool, const char *const id, const char *const expected) {
+    expectNext(spool, id, expected);
+    LDi_eventSpoolRetry(spool, id);
+}
+
+static void
+expectNonePending(struct LDEventSpool *const spool) {
+    char payloadId[LD_UUID_SIZE + 1];
+    char *payload;
+
+    ASSERT_FALSE(LDi_eventSpoolNext(spool, payloadId, &payload));
+}
+
+TEST_F(EventSpoolFixture, ReplaysInOrderAcrossReopen) {
+    struct LDEventSpool *spool;
+
+    ASSERT_TRUE(spool = LDi_eventSpoolOpen(SPOOL_PATH, 4096));
+    ASSERT_TRUE(LDi_eventSpoolIsEmpty(spool));
+    ASSERT_TRUE(LDi_eventSpoolAppend(spool, firstId, "[1]"));
+    ASSERT_TRUE(LDi_eventSpoolAppend(spool, secondId, "[2]"));
+    LDi_eventSpoolClose(spool);
+
+    ASSERT_TRUE(spool = LDi_eventSpoolOpen(SPOOL_PATH, 4096));
+    expectNext(spool, firstId, "[1]");
+    ASSERT_TRUE(LDi_eventSpoolDelivered(spool, firstId));
+    LDi_eventSpoolClose(spool);
+
+    /* delivered records are not replayed */
+    ASSERT_TRUE(spool = LDi_eventSpoolOpen(SPOOL_PATH, 4096));
+    expectNext(spool, secondId, "[2]");
+    ASSERT_TRUE(LDi_eventSpoolDelivered(spool, secondId));
+    ASSERT_TRUE(LDi_eventSpoolIsEmpty(spool));
+    LDi_eventSpoolClose(spool);
+}
+
+TEST_F(EventSpoolFixture, InFlightRecordsSurviveReopen) {
+    struct LDEventSpool *spool;
+
+    ASSERT_TRUE(spool = LDi_eventSpoolOpen(SPOOL_PATH, 4096));
+    ASSERT_TRUE(LDi_eventSpoolAppend(spool, firstId, "[1]"));
+    ASSERT_TRUE(LDi_eventSpoolAppend(spool, secondId, "[2]"));
+    ASSERT_TRUE(LDi_eventSpoolAppend(spool, thirdId, "[3]"));
+    expectNext(spool, firstId, "[1]");
+    expectNext(spool, secondId, "[2]");
+    /* delivered out of order, the head waits for the oldest */
+    ASSERT_TRUE(LDi_eventSpoolDelivered(spool, secondId));
+    expectNext(spool, thirdId, "[3]");
+    expectNonePending(spool);
+    LDi_eventSpoolClose(spool);
+
+    /* as after a crash with both records still in flight */
+    ASSERT_TRUE(spool = LDi_eventSpoolOpen(SPOOL_PATH, 4096));
+    expectNext(spool, firstId, "[1]");
+    expectNext(spool, thirdId, "[3]");
+    expectNonePending(spool);
+    LDi_eventSpoolClose(spool);
+}
+
+TEST_F(EventSpoolFixture, RetriedRecordsKeepTheirPosition) {
+    struct LDEventSpool *spool;
+
+    ASSERT_TRUE(spool = LDi_eventSpoolOpen(SPOOL_PATH, 4096));
+    ASSERT_TRUE(LDi_eventSpoolAppend(spool, firstId, "[1]"));
+    ASSERT_TRUE(LDi_eventSpoolAppend(spool, secondId, "[2]"));
+    expectNext(spool, firstId, "[1]");
+    expectNext(spool, secondId, "[2]");
+    LDi_eventSpoolRetry(spool, firstId);
+    ASSERT_TRUE(LDi_eventSpoolAppend(spool, thirdId, "[3]"));
+
+    /* the failed record is sent again before newer records */
+    expectNext(spool, firstId, "[1]");
+    expectNext(spool, thirdId, "[3]");
+    expectNonePending(spool);
+
+    ASSERT_TRUE(LDi_eventSpoolDelivered(spool, firstId));
+    ASSERT_TRUE(LDi_eventSpoolDelivered(spool, secondId));
+    ASSERT_TRUE(LDi_eventSpoolDelivered(spool, thirdId));
+    ASSERT_TRUE(LDi_eventSpoolIsEmpty(spool));
+    LDi_eventSpoolClose(spool);
+}
+
+TEST_F(EventSpoolFixture, DropsOldestWhenFull) {
+    struct LDEventSpool *spool;
+    char payload[101];
+    FILE *file;
+
+    memset(payload, 'x', 100);
+    payload[100] = 0;
+
+    /* room for two records of this size */
+    ASSERT_TRUE(spool = LDi_eventSpoolOpen(SPOOL_PATH, 400));
+    ASSERT_TRUE(LDi_eventSpoolAppend(spool, firstId, payload));
+    ASSERT_TRUE(LDi_eventSpoolAppend(spool, secondId, payload));
+    ASSERT_TRUE(LDi_eventSpoolAppend(spool, thirdId, payload));
+    expectOldest(spool, secondId, payload);
+
+    /* a payload larger than the spool is refused */
+    ASSERT_FALSE(LDi_eventSpoolAppend(spool, firstId, std::string(400, 'y').c_str()));
+    expectOldest(spool, secondId, payload);
+    LDi_eventSpoolClose(spool);
+
+    ASSERT_TRUE(file = fopen(SPOOL_PATH, "rb"));
+    ASSERT_EQ(fseek(file, 0, SEEK_END), 0);
+    ASSERT_LE(ftell(file), 400);
+    fclose(file);
+}
+
+TEST_F(EventSpoolFixture, UnreadableSpoolIsDiscarded) {
+    struct LDEventSpool *spool;
+    FILE *file;
+
+    ASSERT_TRUE(file = fopen(SPOOL_PATH, "wb"));
+    fputs("not a spool", file);
+    fclose(file);
+
+    ASSERT_TRUE(spool = LDi_eventSpoolOpen(SPOOL_PATH, 4096));
+    ASSERT_TRUE(LDi_eventSpoolIsEmpty(spool));
+    ASSERT_TRUE(LDi_eventSpoolAppend(spool, firstId, "[1]"));
+    expectOldest(spool, firstId, "[1]");
+    LDi_eventSpoolClose(spool);
+}
+
+TEST_F(EventSpoolFixture, OfflineClientSpoolsEvents) {
+    struct LDConfig *config;
+    struct LDClient *client;
+    struct LDEventSpool *spool;
+    char path[64], payloadId[LD_UUID_SIZE + 1];
+    char *payload;
+
+    ASSERT_TRUE(config = LDConfigNew("abc"));
+    LDConfigSetOffline(config, LDBooleanTrue);
+    ASSERT_TRUE(LDConfigSetEventsSpoolPath(config, SPOOL_PATH));
+
+    /* the final flush on close spools the identify event */
+    ASSERT_TRUE(client = LDClientInit(config, LDUserNew("test-user"), 0));
+    LDClientClose(client);
+
+    snprintf(path, sizeof(path), "%s-%08x", SPOOL_PATH, LDi_hash32("abc", 3));
+
+    ASSERT_TRUE(spool = LDi_eventSpoolOpen(path, 4096));
+    ASSERT_TRUE(LDi_eventSpoolNext(spool, payloadId, &payload));
+    ASSERT_TRUE(strstr(payload, "\"identify\""));
+    LDFree(payload);
+    LDi_eventSpoolClose(spool);
+
+    remove(path);
+}
+
+TEST_F(EventSpoolFixture, FailedDeliverySpoolsEvents) {
+    struct LDConfig *config;
+    struct LDClient *client;
+    struct LDEventSpool *spool;
+    char path[64], payloadId[LD_UUID_SIZE + 1];
+    char *payload;
+
+    snprintf(path, sizeof(path), "%s-%08x", SPOOL_PATH, LDi_hash32("abc", 3));
+    remove(path);
+
+    /* nothing listens on the discard port, so sending is refused */
+    ASSERT_TRUE(config = LDConfigNew("abc"));
+    ASSERT_TRUE(LDConfigSetAppURI(config, "http://127.0.0.1:9"));
+    ASSERT_TRUE(LDConfigSetStreamURI(config, "http://127.0.0.1:9"));
+    ASSERT_TRUE(LDConfigSetEventsURI(config, "http://127.0.0.1:9"));
+    ASSERT_TRUE(LDConfigSetEventsSpoolPath(config, SPOOL_PATH));
+
+    /* the final flush on close fails, and is not retried while closing */
+    ASSERT_TRUE(client = LDClientInit(config, LDUserNew("test-user"), 0));
+    LDClientClose(client);
+
+    ASSERT_TRUE(spool = LDi_eventSpoolOpen(path, 4096));
+    ASSERT_TRUE(LDi_eventSpoolNext(spool, payloadId, &payload));
+    ASSERT_TRUE(strstr(payload, "\"identify\""));
+    LDFree(payload);
+    LDi_eventSpoolClose(spool);
+
+    remove(path);
+}
@@ -8,6 +8,8 @@ extern "C" {
 
 #include "event_processor.h"
 #include "event_processor_internal.h"
+#include "event_queue.h"
+#include "utility.h"
 }
 
 // Inherit from the CommonFixture to give a reasonable name for the test output.
@@ -39,6 +41,49 @@ protected:
     }
 };
 
+class EventsWithCacheFixture : public CommonFixture {
+protected:
+    struct LDClient *client;
+
+    void SetUp() override {
+        CommonFixture::SetUp();
+
+        struct LDConfig *config;
+        struct LDUser *user;
+
+        config = LDConfigNew("abc");
+        LDConfigSetOffline(config, LDBooleanTrue);
+        LDConfigSetEvaluationCache(config, LDBooleanTrue);
+
+        user = LDUserNew("test-user");
+
+        client = LDClientInit(config, user, 0);
+    }
+
+    void TearDown() override {
+        LDClientClose(client);
+        CommonFixture::TearDown();
+    }
+};
+
+static void
+upsertNumberFlag(struct LDClient *const client, const int version, const double value) {
+    struct LDFlag flag;
+
+    flag.key = LDStrDup("test");
+    flag.value = LDNewNumber(value);
+    flag.version = version;
+    flag.flagVersion = -1;
+    flag.variation = version;
+    flag.trackEvents = LDBooleanFalse;
+    flag.trackReason = LDBooleanFalse;
+    flag.reason = NULL;
+    flag.debugEventsUntilDate = 0;
+    flag.deleted = LDBooleanFalse;
+
+    ASSERT_TRUE(LDi_storeUpsert(&client->store, flag));
+}
+
 TEST_F(EventsFixture, NoPayloadIfNoEvents) {
     struct LDConfig *config;
     struct EventProcessor *processor;
@@ -335,3 +380,779 @@ TEST_F(EventsWithClientFixture, VariationSendsFeatureEventWithoutReasonIfTrackRe
     LDJSONFree(expected);
     LDJSONFree(payload);
 }
+
+TEST_F(EventsWithCacheFixture, CachedEvaluationsAreSummarized) {
+    struct LDJSON *payload, *event, *expected;
+    int i;
+
+    upsertNumberFlag(client, 2, 7);
+
+    for (i = 0; i < 5; i++) {
+        ASSERT_EQ(LDIntVariation(client, "test", 0), 7);
+    }
+
+    ASSERT_TRUE(LDi_bundleEventPayload(client->eventProcessor, &payload));
+    ASSERT_EQ(LDCollectionGetSize(payload), 2);
+    ASSERT_TRUE(event = LDArrayLookup(payload, 1));
+
+    LDObjectDeleteKey(event, "startDate");
+    LDObjectDeleteKey(event, "endDate");
+
+    ASSERT_TRUE(
+            expected = LDJSONDeserialize(
+                    "{\"kind\":\"summary\",\"features\":{\"test\":{\"default\":0,"
+                    "\"counters\":[{\"count\":5,\"value\":7,\"version\":2,"
+                    "\"variation\":2}]}}}"));
+
+    ASSERT_TRUE(LDJSONCompare(event, expected));
+
+    LDJSONFree(expected);
+    LDJSONFree(payload);
+}
+
+TEST_F(EventsWithCacheFixture, CachedEvaluationSeesUpdates) {
+    struct LDJSON *payload, *event, *counters;
+
+    upsertNumberFlag(client, 2, 7);
+
+    ASSERT_EQ(LDIntVariation(client, "test", 0), 7);
+    ASSERT_EQ(LDIntVariation(client, "test", 0), 7);
+
+    upsertNumberFlag(client, 3, 8);
+
+    ASSERT_EQ(LDIntVariation(client, "test", 0), 8);
+    ASSERT_EQ(LDIntVariation(client, "test", 0), 8);
+
+    ASSERT_TRUE(LDi_storeDelete(&client->store, "test", 4));
+
+    ASSERT_EQ(LDIntVariation(client, "test", 0), 0);
+
+    ASSERT_TRUE(LDi_bundleEventPayload(client->eventProcessor, &payload));
+    ASSERT_TRUE(event = LDArrayLookup(payload, 1));
+    ASSERT_TRUE(counters = LDObjectLookup(
+        LDObjectLookup(LDObjectLookup(event, "features"), "test"), "counters"));
+    ASSERT_EQ(LDCollectionGetSize(counters), 3);
+
+    LDJSONFree(payload);
+}
+
+TEST_F(EventsWithClientFixture, SnapshotIgnoresLaterUpdates) {
+    struct LDClientSnapshot *snapshot;
+
+    upsertNumberFlag(client, 2, 7);
+
+    ASSERT_TRUE(snapshot = LDClientSnapshotAcquire(client));
+
+    upsertNumberFlag(client, 3, 8);
+    ASSERT_TRUE(LDi_storeDelete(&client->store, "test", 4));
+
+    ASSERT_EQ(LDSnapshotIntVariation(snapshot, "test", 0), 7);
+    ASSERT_EQ(LDSnapshotDoubleVariation(snapshot, "test", 0), 7);
+    ASSERT_EQ(LDSnapshotBoolVariation(snapshot, "test", LDBooleanTrue),
+        LDBooleanTrue);
+    ASSERT_STREQ(LDSnapshotStringVariation(snapshot, "missing", "a"), "a");
+
+    LDClientSnapshotRelease(snapshot);
+
+    ASSERT_EQ(LDIntVariation(client, "test", 0), 0);
+}
+
+TEST_F(EventsWithClientFixture, SnapshotEvaluationsAreSummarized) {
+    struct LDClientSnapshot *snapshot;
+    struct LDJSON *payload, *event, *expected;
+    int i;
+
+    upsertNumberFlag(client, 2, 7);
+
+    ASSERT_TRUE(snapshot = LDClientSnapshotAcquire(client));
+
+    for (i = 0; i < 5; i++) {
+        ASSERT_EQ(LDSnapshotIntVariation(snapshot, "test", 0), 7);
+    }
+
+    LDClientSnapshotRelease(snapshot);
+
+    ASSERT_TRUE(LDi_bundleEventPayload(client->eventProcessor, &payload));
+    ASSERT_EQ(LDCollectionGetSize(payload), 2);
+    ASSERT_TRUE(event = LDArrayLookup(payload, 1));
+
+    LDObjectDeleteKey(event, "startDate");
+    LDObjectDeleteKey(event, "endDate");
+
+    ASSERT_TRUE(
+            expected = LDJSONDeserialize(
+                    "{\"kind\":\"summary\",\"features\":{\"test\":{\"default\":0,"
+                    "\"counters\":[{\"count\":5,\"value\":7,\"version\":2,"
+                    "\"variation\":2}]}}}"));
+
+    ASSERT_TRUE(LDJSONCompare(event, expected));
+
+    LDJSONFree(expected);
+    LDJSONFree(payload);
+}
+
+TEST_F(EventsFixture, EventQueueIsBoundedAndOrdered) {
+    struct LDEventQueue queue;
+    struct LDJSON *event;
+    unsigned int i, lap;
+
+    ASSERT_TRUE(LDi_eventQueueInitialize(&queue, 3));
+
+    for (lap = 0; lap < 3; lap++) {
+        for (i = 0; i < 3; i++) {
+            ASSERT_TRUE(LDi_eventQueuePush(&queue, LDNewNumber(i)));
+        }
+
+        ASSERT_TRUE(event = LDNewNumber(3));
+        ASSERT_FALSE(LDi_eventQueuePush(&queue, event));
+        LDJSONFree(event);
+
+        for (i = 0; i < 3; i++) {
+            ASSERT_TRUE(event = LDi_eventQueuePop(&queue));
+            ASSERT_EQ(LDGetNumber(event), i);
+            LDJSONFree(event);
+        }
+
+        ASSERT_EQ(LDi_eventQueuePop(&queue), nullptr);
+    }
+
+    /* remaining events are freed */
+    ASSERT_TRUE(LDi_eventQueuePush(&queue, LDNewNumber(0)));
+    LDi_eventQueueDestroy(&queue);
+}
+
+TEST_F(EventsFixture, EventQueueWrapsAroundPositions) {
+    struct LDEventQueue queue;
+    struct LDJSON *event;
+    unsigned long start, i;
+    unsigned int lap;
+
+    ASSERT_TRUE(LDi_eventQueueInitialize(&queue, 3));
+
+    /* an empty queue shortly before positions wrap around */
+    start = (unsigned long)-5;
+    queue.head = start;
+    queue.tail = start;
+
+    for (i = 0; i <= queue.mask; i++) {
+        queue.cells[i].sequence = start + ((i - start) & queue.mask);
+    }
+
+    for (lap = 0; lap < 4; lap++) {
+        for (i = 0; i < 3; i++) {
+            ASSERT_TRUE(LDi_eventQueuePush(&queue, LDNewNumber(i)));
+        }
+
+        ASSERT_TRUE(event = LDNewNumber(3));
+        ASSERT_FALSE(LDi_eventQueuePush(&queue, event));
+        LDJSONFree(event);
+
+        for (i = 0; i < 3; i++) {
+            ASSERT_TRUE(event = LDi_eventQueuePop(&queue));
+            ASSERT_EQ(LDGetNumber(event), i);
+            LDJSONFree(event);
+        }
+
+        ASSERT_EQ(LDi_eventQueuePop(&queue), nullptr);
+    }
+
+    LDi_eventQueueDestroy(&queue);
+}
+
+static struct LDClient *trackingClient;
+
+static THREAD_RETURN
+trackEvents(void *const unused) {
+    (void)unused;
+
+    for (int i = 0; i < 250; i++) {
+        LDClientTrack(trackingClient, "concurrent");
+    }
+
+    return THREAD_RETURN_DEFAULT;
+}
+
+TEST_F(EventsWithClientFixture, ConcurrentTrackIsBoundedByCapacity) {
+    struct LDJSON *payload;
+    ld_thread_t threads[4];
+
+    trackingClient = client;
+
+    for (int i = 0; i < 4; i++) {
+        ASSERT_TRUE(LDi_thread_create(&threads[i], trackEvents, NULL));
+    }
+
+    for (int i = 0; i < 4; i++) {
+        ASSERT_TRUE(LDi_thread_join(&threads[i]));
+    }
+
+    /* the default capacity is 100, and the identify event was queued first */
+    ASSERT_TRUE(LDi_bundleEventPayload(client->eventProcessor, &payload));
+    ASSERT_EQ(LDCollectionGetSize(payload), 100);
+    ASSERT_EQ(LDClientGetDroppedEventCount(client), 901);
+    LDJSONFree(payload);
+
+    LDClientTrack(client, "after");
+
+    ASSERT_TRUE(LDi_bundleEventPayload(client->eventProcessor, &payload));
+    ASSERT_EQ(LDCollectionGetSize(payload), 1);
+    LDJSONFree(payload);
+}
+
+static THREAD_RETURN
+evaluateFlag(void *const unused) {
+    (void)unused;
+
+    for (int i = 0; i < 250; i++) {
+        LDDoubleVariation(trackingClient, "test", 0);
+    }
+
+    return THREAD_RETURN_DEFAULT;
+}
+
+static double
+summaryCount(struct LDJSON *const payload) {
+    struct LDJSON *event, *counter;
+    double count = 0;
+
+    for (event = LDGetIter(payload); event; event = LDIterNext(event)) {
+        if (strcmp(LDGetText(LDObjectLookup(event, "kind")), "summary") != 0) {
+            continue;
+        }
+
+        counter = LDGetIter(LDObjectLookup(
+            LDObjectLookup(LDObjectLookup(event, "features"), "test"),
+            "counters"));
+
+        for (; counter; counter = LDIterNext(counter)) {
+            count += LDGetNumber(LDObjectLookup(counter, "count"));
+        }
+    }
+
+    return count;
+}
+
+TEST_F(EventsWithClientFixture, EvaluationsDuringFlushAreSummarizedOnce) {
+    struct LDJSON *payload;
+    ld_thread_t threads[4];
+    double count = 0;
+
+    upsertNumberFlag(client, 1, 5);
+
+    trackingClient = client;
+
+    for (int i = 0; i < 4; i++) {
+        ASSERT_TRUE(LDi_thread_create(&threads[i], evaluateFlag, NULL));
+    }
+
+    /* flush concurrently with the evaluations */
+    for (int i = 0; i < 50; i++) {
+        ASSERT_TRUE(LDi_bundleEventPayload(client->eventProcessor, &payload));
+
+        if (payload) {
+            count += summaryCount(payload);
+            LDJSONFree(payload);
+        }
+    }
+
+    for (int i = 0; i < 4; i++) {
+        ASSERT_TRUE(LDi_thread_join(&threads[i]));
+    }
+
+    ASSERT_TRUE(LDi_bundleEventPayload(client->eventProcessor, &payload));
+
+    if (payload) {
+        count += summaryCount(payload);
+        LDJSONFree(payload);
+    }
+
+    ASSERT_EQ(count, 1000);
+}
+
+static void
+fillEventProcessor(const LDEventsOverflowPolicy policy, struct LDJSON **const payload,
+    unsigned long *const dropped) {
+    struct LDConfig *config;
+    struct EventProcessor *processor;
+
+    ASSERT_TRUE(config = LDConfigNew("abc"));
+    LDConfigSetEventsCapacity(config, 3);
+    LDConfigSetEventsOverflowPolicy(config, policy);
+    ASSERT_TRUE(processor = LDi_newEventProcessor(config));
+
+    for (int i = 0; i < 5; i++) {
+        LDi_addEvent(processor, LDNewNumber(i));
+    }
+
+    ASSERT_TRUE(LDi_bundleEventPayload(processor, payload));
+    *dropped = LDi_droppedEventCount(processor);
+
+    LDi_freeEventProcessor(processor);
+    LDConfigFree(config);
+}
+
+TEST_F(EventsFixture, OverflowDropsNewestByDefault) {
+    struct LDJSON *payload;
+    unsigned long dropped;
+
+    fillEventProcessor(LDEventsOverflowDropNewest, &payload, &dropped);
+
+    ASSERT_EQ(dropped, 2);
+    /* drops do not add a summary without evaluations */
+    ASSERT_EQ(LDCollectionGetSize(payload), 3);
+    ASSERT_EQ(LDGetNumber(LDArrayLookup(payload, 0)), 0);
+    ASSERT_EQ(LDGetNumber(LDArrayLookup(payload, 2)), 2);
+
+    LDJSONFree(payload);
+}
+
+TEST_F(EventsFixture, OverflowDropsOldest) {
+    struct LDJSON *payload;
+    unsigned long dropped;
+
+    fillEventProcessor(LDEventsOverflowDropOldest, &payload, &dropped);
+
+    ASSERT_EQ(dropped, 2);
+    ASSERT_EQ(LDCollectionGetSize(payload), 3);
+    ASSERT_EQ(LDGetNumber(LDArrayLookup(payload, 0)), 2);
+    ASSERT_EQ(LDGetNumber(LDArrayLookup(payload, 2)), 4);
+
+    LDJSONFree(payload);
+}
+
+TEST_F(EventsFixture, OverflowDropsNewestWhileAnotherThreadPops) {
+    struct LDConfig *config;
+    struct EventProcessor *processor;
+    struct LDJSON *payload;
+
+    ASSERT_TRUE(config = LDConfigNew("abc"));
+    LDConfigSetEventsCapacity(config, 3);
+    LDConfigSetEventsOverflowPolicy(config, LDEventsOverflowDropOldest);
+    ASSERT_TRUE(processor = LDi_newEventProcessor(config));
+
+    /* as if a bundle were in progress, which producers must not wait for */
+    processor->popping = 1;
+
+    for (int i = 0; i < 4; i++) {
+        LDi_addEvent(processor, LDNewNumber(i));
+    }
+
+    ASSERT_EQ(LDi_droppedEventCount(processor), 1);
+
+    processor->popping = 0;
+
+    ASSERT_TRUE(LDi_bundleEventPayload(processor, &payload));
+    ASSERT_EQ(LDGetNumber(LDArrayLookup(payload, 0)), 0);
+    ASSERT_EQ(LDGetNumber(LDArrayLookup(payload, 2)), 2);
+
+    LDJSONFree(payload);
+    LDi_freeEventProcessor(processor);
+    LDConfigFree(config);
+}
+
+TEST_F(EventsFixture, OverflowProbabilisticDropOldestKeepsCapacity) {
+    struct LDJSON *payload;
+    unsigned long dropped;
+
+    fillEventProcessor(LDEventsOverflowProbabilisticDropOldest, &payload, &dropped);
+
+    ASSERT_EQ(dropped, 2);
+    ASSERT_EQ(LDCollectionGetSize(payload), 3);
+
+    LDJSONFree(payload);
+}
+
+TEST_F(EventsFixture, OverflowProbabilisticDropOldestAdmitsSomeNewEvents) {
+    struct LDConfig *config;
+    struct EventProcessor *processor;
+    struct LDJSON *payload;
+    double previous, kept;
+    unsigned int newest;
+
+    ASSERT_TRUE(config = LDConfigNew("abc"));
+    LDConfigSetEventsCapacity(config, 4);
+    LDConfigSetEventsOverflowPolicy(config, LDEventsOverflowProbabilisticDropOldest);
+    ASSERT_TRUE(processor = LDi_newEventProcessor(config));
+
+    for (int i = 0; i < 1000; i++) {
+        LDi_addEvent(processor, LDNewNumber(i));
+    }
+
+    ASSERT_TRUE(LDi_bundleEventPayload(processor, &payload));
+    ASSERT_EQ(LDi_droppedEventCount(processor), 996);
+    ASSERT_EQ(LDCollectionGetSize(payload), 4);
+
+    /* admitted events displace the oldest, so order is kept */
+    previous = -1;
+    newest   = 0;
+
+    for (int i = 0; i < 4; i++) {
+        kept = LDGetNumber(LDArrayLookup(payload, i));
+        ASSERT_GT(kept, previous);
+
+        if (kept >= 996) {
+            newest++;
+        }
+
+        previous = kept;
+    }
+
+    /* neither the first events nor only the last events, except with
+     * negligible probability */
+    ASSERT_GT(previous, 3);
+    ASSERT_LT(newest, 4);
+
+    LDJSONFree(payload);
+    LDi_freeEventProcessor(processor);
+    LDConfigFree(config);
+}
+
+TEST_F(EventsFixture, HighWatermarkRequestsOneFlush) {
+    struct LDConfig *config;
+    struct EventProcessor *processor;
+    struct LDJSON *payload;
+    ld_cond_t signal;
+
+    ASSERT_TRUE(config = LDConfigNew("abc"));
+    LDConfigSetEventsCapacity(config, 4);
+    ASSERT_TRUE(processor = LDi_newEventProcessor(config));
+    ASSERT_TRUE(LDi_cond_init(&signal));
+    LDi_eventProcessorSetFlushSignal(processor, &signal);
+
+    /* three quarters of the capacity */
+    LDi_addEvent(processor, LDNewNumber(0));
+    LDi_addEvent(processor, LDNewNumber(1));
+    ASSERT_EQ(processor->flushRequested, 0);
+    LDi_addEvent(processor, LDNewNumber(2));
+    ASSERT_EQ(processor->flushRequested, 1);
+    /* a flusher that was busy when signaled does not wait */
+    ASSERT_TRUE(LDi_eventProcessorFlushRequested(processor));
+
+    ASSERT_TRUE(LDi_bundleEventPayload(processor, &payload));
+    ASSERT_EQ(processor->flushRequested, 0);
+    ASSERT_FALSE(LDi_eventProcessorFlushRequested(processor));
+    LDJSONFree(payload);
+
+    LDi_freeEventProcessor(processor);
+    LDi_cond_destroy(&signal);
+    LDConfigFree(config);
+}
+
+TEST_F(EventsFixture, SerializeEventBatchSplitsBySize) {
+    struct LDJSON *payload, *iter, *batch, *event, *rejoined;
+    char *serialized, *expected;
+    unsigned int batches = 0;
+
+    ASSERT_TRUE(payload = LDNewArray());
+
+    for (int i = 0; i < 20; i++) {
+        ASSERT_TRUE(event = LDNewObject());
+        ASSERT_TRUE(LDObjectSetKey(event, "kind", LDNewText("custom")));
+        ASSERT_TRUE(LDObjectSetKey(event, "creationDate", LDNewNumber(i)));
+        ASSERT_TRUE(LDArrayPush(payload, event));
+    }
+
+    /* larger than the bound by itself */
+    ASSERT_TRUE(LDArrayPush(payload, LDNewText(std::string(200, 'x').c_str())));
+
+    ASSERT_TRUE(rejoined = LDNewArray());
+
+    for (iter = LDGetIter(payload); iter; batches++) {
+        ASSERT_TRUE(serialized =
+            LDi_serializeEventBatch(&iter, 100, LDBooleanFalse));
+
+        if (batches < 4) {
+            ASSERT_LE(strlen(serialized), 100);
+        }
+
+        ASSERT_TRUE(batch = LDJSONDeserialize(serialized));
+        ASSERT_GT(LDCollectionGetSize(batch), 0);
+        ASSERT_TRUE(LDArrayAppend(rejoined, batch));
+
+        LDJSONFree(batch);
+        LDFree(serialized);
+    }
+
+    /* each event is about 35 bytes, so two fit per batch */
+    ASSERT_EQ(batches, 11);
+    ASSERT_TRUE(LDJSONCompare(payload, rejoined));
+
+    /* unbounded is a single array */
+    iter = LDGetIter(payload);
+    ASSERT_TRUE(serialized = LDi_serializeEventBatch(&iter, 0, LDBooleanFalse));
+    ASSERT_EQ(iter, nullptr);
+    ASSERT_TRUE(expected = LDJSONSerialize(payload));
+    ASSERT_STREQ(serialized, expected);
+
+    LDFree(serialized);
+    LDFree(expected);
+    LDJSONFree(rejoined);
+    LDJSONFree(payload);
+}
+
+TEST_F(EventsFixture, AggregatedMetricIsOneEventPerFlush) {
+    struct LDConfig *config;
+    struct LDUser *user;
+    struct LDClient *client;
+    struct LDJSON *payload, *event, *data;
+    unsigned int metrics = 0, others = 0;
+
+    ASSERT_TRUE(config = LDConfigNew("abc"));
+    LDConfigSetOffline(config, LDBooleanTrue);
+    ASSERT_TRUE(LDConfigAddAggregatedMetric(config, "latency"));
+
+    ASSERT_TRUE(user = LDUserNew("my-user"));
+    ASSERT_TRUE(client = LDClientInit(config, user, 0));
+
+    for (int i = 1; i <= 10; i++) {
+        LDClientTrackMetric(client, "latency", LDNewNumber(i), i);
+    }
+
+    LDClientTrackMetric(client, "other", NULL, 5);
+    LDClientTrackMetric(client, "other", NULL, 6);
+
+    ASSERT_TRUE(LDi_bundleEventPayload(client->eventProcessor, &payload));
+
+    for (event = LDGetIter(payload); event; event = LDIterNext(event)) {
+        if (strcmp(LDGetText(LDObjectLookup(event, "kind")), "custom") != 0) {
+            continue;
+        }
+
+        if (strcmp(LDGetText(LDObjectLookup(event, "key")), "other") == 0) {
+            ASSERT_FALSE(LDObjectLookup(event, "data"));
+            others++;
+
+            continue;
+        }
+
+        ASSERT_EQ(LDGetNumber(LDObjectLookup(event, "metricValue")), 5.5);
+        ASSERT_STREQ(LDGetText(LDObjectLookup(event, "userKey")), "my-user");
+        ASSERT_TRUE(data = LDObjectLookup(event, "data"));
+        ASSERT_EQ(LDGetNumber(LDObjectLookup(data, "count")), 10);
+        ASSERT_EQ(LDGetNumber(LDObjectLookup(data, "sum")), 55);
+        ASSERT_EQ(LDGetNumber(LDObjectLookup(data, "min")), 1);
+        ASSERT_EQ(LDGetNumber(LDObjectLookup(data, "max")), 10);
+        metrics++;
+    }
+
+    ASSERT_EQ(metrics, 1);
+    ASSERT_EQ(others, 2);
+
+    LDJSONFree(payload);
+
+    /* the aggregate starts afresh after each flush */
+    LDClientTrackMetric(client, "latency", NULL, 3);
+
+    ASSERT_TRUE(LDi_bundleEventPayload(client->eventProcessor, &payload));
+    ASSERT_EQ(LDCollectionGetSize(payload), 1);
+    ASSERT_TRUE(event = LDArrayLookup(payload, 0));
+    ASSERT_EQ(LDGetNumber(LDObjectLookup(event, "metricValue")), 3);
+    ASSERT_TRUE(data = LDObjectLookup(event, "data"));
+    ASSERT_EQ(LDGetNumber(LDObjectLookup(data, "count")), 1);
+
+    LDJSONFree(payload);
+    LDClientClose(client);
+}
+
+static struct LDMetricAggregate stripedAggregate;
+
+static THREAD_RETURN
+addMetricSamples(void *const unused) {
+    (void)unused;
+
+    for (int i = 1; i <= 100; i++) {
+        LDi_metricAdd(&stripedAggregate, i);
+    }
+
+    return THREAD_RETURN_DEFAULT;
+}
+
+TEST_F(EventsFixture, AggregatedMetricThreadsUseTheirOwnStripes) {
+    struct LDConfig *config;
+    struct LDMetricTotals totals;
+    struct LDJSON *event;
+    ld_thread_t threads[4];
+    unsigned int used = 0;
+
+    /* assigns thread specific storage for stripes */
+    ASSERT_TRUE(config = LDConfigNew("abc"));
+    LDConfigFree(config);
+
+    ASSERT_TRUE(LDi_metricInitialize(&stripedAggregate, "latency"));
+
+    for (int i = 0; i < 4; i++) {
+        ASSERT_TRUE(LDi_thread_create(&threads[i], addMetricSamples, NULL));
+    }
+
+    for (int i = 0; i < 4; i++) {
+        ASSERT_TRUE(LDi_thread_join(&threads[i]));
+    }
+
+    /* stripes are handed out in turn, so each thread has its own */
+    for (int i = 0; i < LD_METRIC_STRIPES; i++) {
+        if (stripedAggregate.stripes[i].count) {
+            ASSERT_EQ(stripedAggregate.stripes[i].count, 100);
+            used++;
+        }
+    }
+
+    ASSERT_EQ(used, 4);
+
+    ASSERT_TRUE(event = LDNewObject());
+    LDi_metricSetEvent(&stripedAggregate, event);
+    LDi_metricTake(&stripedAggregate, &totals, &event);
+
+    ASSERT_EQ(totals.count, 400);
+    ASSERT_EQ(totals.sum, 4 * 5050);
+    ASSERT_EQ(totals.min, 1);
+    ASSERT_EQ(totals.max, 100);
+
+    LDJSONFree(event);
+    LDi_metricDestroy(&stripedAggregate);
+}
+
+TEST_F(EventsFixture, DeduplicatedUsersAreIndexedOnce) {
+    struct LDJSON *events, *iter, *batch, *expected;
+    char *serialized;
+
+    ASSERT_TRUE(events = LDJSONDeserialize(
+        "["
+        "{\"kind\":\"custom\",\"creationDate\":1,\"user\":{\"key\":\"a\"}},"
+        "{\"kind\":\"feature\",\"creationDate\":2,\"user\":{\"key\":\"b\"}},"
+        "{\"kind\":\"custom\",\"creationDate\":3,\"user\":{\"key\":\"a\"}},"
+        "{\"kind\":\"identify\",\"creationDate\":4,\"key\":\"c\","
+        "\"user\":{\"key\":\"c\"}},"
+        "{\"kind\":\"custom\",\"creationDate\":5,\"user\":{\"key\":\"c\"}},"
+        "{\"kind\":\"summary\",\"startDate\":1,\"endDate\":5}"
+        "]"));
+
+    ASSERT_TRUE(expected = LDJSONDeserialize(
+        "["
+        "{\"kind\":\"index\",\"creationDate\":1,\"user\":{\"key\":\"a\"}},"
+        "{\"kind\":\"custom\",\"creationDate\":1,\"userKey\":\"a\"},"
+        "{\"kind\":\"index\",\"creationDate\":2,\"user\":{\"key\":\"b\"}},"
+        "{\"kind\":\"feature\",\"creationDate\":2,\"userKey\":\"b\"},"
+        "{\"kind\":\"custom\",\"creationDate\":3,\"userKey\":\"a\"},"
+        "{\"kind\":\"identify\",\"creationDate\":4,\"key\":\"c\","
+        "\"user\":{\"key\":\"c\"}},"
+        "{\"kind\":\"custom\",\"creationDate\":5,\"userKey\":\"c\"},"
+        "{\"kind\":\"summary\",\"startDate\":1,\"endDate\":5}"
+        "]"));
+
+    iter = LDGetIter(events);
+    ASSERT_TRUE(serialized = LDi_serializeEventBatch(&iter, 0, LDBooleanTrue));
+    ASSERT_EQ(iter, nullptr);
+    ASSERT_TRUE(batch = LDJSONDeserialize(serialized));
+    ASSERT_TRUE(LDJSONCompare(batch, expected));
+
+    /* the bundled events are left untouched */
+    ASSERT_TRUE(LDObjectLookup(LDArrayLookup(events, 0), "user"));
+
+    LDFree(serialized);
+    LDJSONFree(batch);
+    LDJSONFree(events);
+    LDJSONFree(expected);
+}
+
+TEST_F(EventsFixture, DeduplicatedUsersAreIndexedInEachRequest) {
+    struct LDConfig *config;
+    struct LDUser *user;
+    struct LDClient *client;
+    struct LDJSON *payload, *iter, *batch, *event, *indexed;
+    const struct LDConfig *shared;
+    const char *kind;
+    char *serialized;
+    unsigned int batches = 0, events = 0;
+
+    ASSERT_TRUE(config = LDConfigNew("abc"));
+    LDConfigSetOffline(config, LDBooleanTrue);
+    LDConfigSetInlineUsersInEvents(config, LDBooleanTrue);
+    LDConfigSetDeduplicateInlineUsers(config, LDBooleanTrue);
+    LDConfigSetEventsMaxPayloadBytes(config, 400);
+
+    ASSERT_TRUE(user = LDUserNew("my-user"));
+    ASSERT_TRUE(LDUserSetFirstName(user, "Ada"));
+    ASSERT_TRUE(client = LDClientInit(config, user, 0));
+
+    for (int i = 0; i < 20; i++) {
+        LDClientTrack(client, "clicked");
+    }
+
+    ASSERT_TRUE(LDi_bundleEventPayload(client->eventProcessor, &payload));
+
+    /* serialized as the events thread does */
+    shared = client->shared->sharedConfig;
+
+    for (iter = LDGetIter(payload); iter; batches++) {
+        ASSERT_TRUE(serialized = LDi_serializeEventBatch(&iter,
+            shared->eventsMaxPayloadBytes,
+            shared->inlineUsersInEvents && shared->deduplicateInlineUsers));
+        ASSERT_LE(strlen(serialized), 400);
+        ASSERT_TRUE(batch = LDJSONDeserialize(serialized));
+        ASSERT_TRUE(indexed = LDNewObject());
+
+        /* every request carries the users it refers to */
+        for (event = LDGetIter(batch); event; event = LDIterNext(event)) {
+            kind = LDGetText(LDObjectLookup(event, "kind"));
+
+            if (strcmp(kind, "index") == 0 || strcmp(kind, "identify") == 0) {
+                ASSERT_FALSE(LDObjectLookup(indexed, "my-user"));
+                ASSERT_TRUE(LDObjectSetKey(indexed, "my-user",
+                    LDJSONDuplicate(LDObjectLookup(event, "user"))));
+            } else {
+                ASSERT_FALSE(LDObjectLookup(event, "user"));
+                ASSERT_STREQ(
+                    LDGetText(LDObjectLookup(event, "userKey")), "my-user");
+                ASSERT_TRUE(LDObjectLookup(indexed, "my-user"));
+                events++;
+            }
+        }
+
+        LDJSONFree(indexed);
+        LDJSONFree(batch);
+        LDFree(serialized);
+    }
+
+    ASSERT_GT(batches, 1);
+    ASSERT_EQ(events, 20);
+
+    LDJSONFree(payload);
+    LDClientClose(client);
+}
+
+TEST_F(EventsFixture, TrackRawJSONIsSplicedVerbatim) {
+    struct LDConfig *config;
+    struct LDUser *user;
+    struct LDClient *client;
+    struct LDJSON *payload, *iter;
+    char *serialized;
+    const char *const data = "{\"screen\": \"checkout\", \"items\": [1, 2.50]}";
+
+    ASSERT_TRUE(config = LDConfigNew("abc"));
+    LDConfigSetOffline(config, LDBooleanTrue);
+
+    ASSERT_TRUE(user = LDUserNew("my-user"));
+    ASSERT_TRUE(client = LDClientInit(config, user, 0));
+
+    ASSERT_TRUE(LDClientTrackRawJSON(client, "raw", data, strlen(data)));
+    ASSERT_TRUE(LDClientTrackMetricRawJSON(client, "raw-metric", "7", 1, 2.5));
+
+    /* invalid data records no event */
+    ASSERT_FALSE(LDClientTrackRawJSON(client, "raw", "{\"a\":", 5));
+    ASSERT_FALSE(LDClientTrackRawJSON(client, "raw", data, strlen(data) - 1));
+
+    ASSERT_TRUE(LDi_bundleEventPayload(client->eventProcessor, &payload));
+    ASSERT_EQ(LDCollectionGetSize(payload), 3);
+
+    iter = LDGetIter(payload);
+    ASSERT_TRUE(serialized = LDi_serializeEventBatch(&iter, 0, LDBooleanFalse));
+
+    ASSERT_TRUE(strstr(serialized, "\"key\":\"raw\",\"data\":{\"screen\": "
+        "\"checkout\", \"items\": [1, 2.50]}"));
+    ASSERT_TRUE(strstr(serialized,
+        "\"key\":\"raw-metric\",\"data\":7,\"metricValue\":2.5"));
+
+    LDFree(serialized);
+    LDJSONFree(payload);
+    LDClientClose(client);
+}
@@ -1,5 +1,6 @@
 #include "gtest/gtest.h"
 #include "commonfixture.h"
+#include <atomic>
 #include <unordered_map>
 #include "callback-spy.hpp"
 
@@ -7,12 +8,21 @@ extern "C" {
 #include <launchdarkly/api.h>
 
 #include "ldinternal.h"
+#include "utility.h"
 }
 
 
 // Used for unit testing the ChangeListener implementation detail.
 class ChangeListenerFixture : public CommonFixture {};
 
+static LDFlagChange makeChange(const char* key) {
+    LDFlagChange change;
+    memset(&change, 0, sizeof(change));
+    change.key = key;
+    change.deleted = LDBooleanFalse;
+    return change;
+}
+
 TEST_F(ChangeListenerFixture, TestInitFreeDoesNotLeak) {
     struct ChangeListener *listeners;
     LDi_initListeners(&listeners);
@@ -40,7 +50,8 @@ TEST_F(ChangeListenerFixture, TestDispatchAfterInsert) {
     LDi_initListeners(&listeners);
 
     LDi_listenerAdd(&listeners, "flag1", testDispatchAfterInsert);
-    LDi_listenersDispatch(listeners, "flag1", 0);
+    LDFlagChange change = makeChange("flag1");
+    LDi_listenersDispatch(listeners, &change);
 
     LDi_freeListeners(&listeners);
 
@@ -60,7 +71,8 @@ TEST_F(ChangeListenerFixture, TestDispatchNoopAfterDelete) {
     LDi_listenerAdd(&listeners, "flag1", testDispatchAfterDelete);
     LDi_listenerRemove(&listeners, "flag1", testDispatchAfterDelete);
 
-    LDi_listenersDispatch(listeners, "flag1", 0);
+    LDFlagChange change = makeChange("flag1");
+    LDi_listenersDispatch(listeners, &change);
     LDi_freeListeners(&listeners);
 
     ASSERT_TRUE(FLAG_CALLS(testDispatchAfterDelete).empty());
@@ -76,7 +88,8 @@ TEST_F(ChangeListenerFixture, TestMultiDispatch) {
     LDi_listenerAdd(&listeners, "flag1", testMultiDispatch1);
     LDi_listenerAdd(&listeners, "flag1", testMultiDispatch2);
 
-    LDi_listenersDispatch(listeners, "flag1", 0);
+    LDFlagChange change = makeChange("flag1");
+    LDi_listenersDispatch(listeners, &change);
     LDi_freeListeners(&listeners);
 
     ASSERT_EQ(FLAG_CALLS(testMultiDispatch1).size(), 1);
@@ -189,3 +202,264 @@ TEST_F(FlagListenerFixture, TestListenerUniqueness) {
 
     ASSERT_EQ(FLAG_CALLS(enforceUniqueness).size(), 1);
 }
+
+struct RecordedChange {
+    std::string key;
+    bool deleted;
+    std::string oldValue;
+    std::string newValue;
+    int oldVersion;
+    int newVersion;
+    int newVariation;
+};
+
+static std::string serializeOrEmpty(const struct LDJSON *value) {
+    if (value == NULL) {
+        return "";
+    }
+
+    char *serialized = LDJSONSerialize(value);
+    std::string result(serialized);
+    LDFree(serialized);
+    return result;
+}
+
+static void recordChange(const LDFlagChange *const change, void *const context) {
+    auto *changes = static_cast<std::vector<RecordedChange> *>(context);
+
+    changes->push_back(RecordedChange{change->key, change->deleted == LDBooleanTrue,
+        serializeOrEmpty(change->oldValue), serializeOrEmpty(change->newValue),
+        change->oldVersion, change->newVersion, change->newVariation});
+}
+
+TEST_F(FlagListenerFixture, ChangeListenerReceivesValues) {
+    std::vector<RecordedChange> changes;
+
+    ASSERT_TRUE(LDClientRegisterFlagChangeListener(client, "flag1", recordChange, &changes));
+
+    LDFlag flag = makeFlag("flag1");
+    ASSERT_TRUE(LDi_storeUpsert(&client->store, flag));
+
+    flag = makeFlag("flag1");
+    LDJSONFree(flag.value);
+    flag.value = LDNewBool(LDBooleanFalse);
+    flag.version = 3;
+    flag.variation = 4;
+    ASSERT_TRUE(LDi_storeUpsert(&client->store, flag));
+
+    ASSERT_TRUE(LDi_storeDelete(&client->store, "flag1", 4));
+
+    LDClientUnregisterFlagChangeListener(client, "flag1", recordChange, &changes);
+
+    flag = makeFlag("flag1");
+    flag.version = 5;
+    ASSERT_TRUE(LDi_storeUpsert(&client->store, flag));
+
+    ASSERT_EQ(changes.size(), 3);
+
+    EXPECT_EQ(changes.at(0).oldValue, "");
+    EXPECT_EQ(changes.at(0).oldVersion, -1);
+    EXPECT_EQ(changes.at(0).newValue, "true");
+    EXPECT_EQ(changes.at(0).newVersion, 2);
+
+    EXPECT_EQ(changes.at(1).oldValue, "true");
+    EXPECT_EQ(changes.at(1).newValue, "false");
+    EXPECT_EQ(changes.at(1).oldVersion, 2);
+    EXPECT_EQ(changes.at(1).newVersion, 3);
+    EXPECT_EQ(changes.at(1).newVariation, 4);
+
+    EXPECT_TRUE(changes.at(2).deleted);
+    EXPECT_EQ(changes.at(2).oldValue, "false");
+    EXPECT_EQ(changes.at(2).newValue, "");
+    EXPECT_EQ(changes.at(2).newVersion, 4);
+}
+
+DEFINE_FLAG_CALLBACK(suppressedListener)
+
+// Creates its own client, so that notifications can be configured.
+class SuppressedFlagListenerFixture : public CommonFixture {};
+
+TEST_F(SuppressedFlagListenerFixture, UnchangedValuesAreSuppressed) {
+    struct LDConfig *config;
+    struct LDUser *user;
+    struct LDClient *client;
+    struct LDFlag *flags;
+    std::vector<RecordedChange> changes;
+
+    ASSERT_TRUE(config = LDConfigNew("abc"));
+    LDConfigSetOffline(config, LDBooleanTrue);
+    LDConfigSetSuppressUnchangedNotifications(config, LDBooleanTrue);
+
+    ASSERT_TRUE(user = LDUserNew("test-user"));
+    ASSERT_TRUE(client = LDClientInit(config, user, 0));
+
+    ASSERT_TRUE(LDClientRegisterFlagChangeListener(client, "flag1", recordChange, &changes));
+    ASSERT_TRUE(LDClientRegisterFeatureFlagListener(client, "flag1", suppressedListener));
+
+    ASSERT_TRUE(LDi_storeUpsert(&client->store, makeFlag("flag1")));
+
+    /* a new version with the same value */
+    LDFlag flag = makeFlag("flag1");
+    flag.version = 3;
+    ASSERT_TRUE(LDi_storeUpsert(&client->store, flag));
+
+    /* a full refresh with the same value */
+    ASSERT_TRUE(flags = (struct LDFlag *) LDAlloc(sizeof(struct LDFlag)));
+    flags[0] = makeFlag("flag1");
+    flags[0].version = 4;
+    ASSERT_TRUE(LDi_storePut(&client->store, flags, 1));
+
+    ASSERT_EQ(changes.size(), 1);
+    ASSERT_EQ(FLAG_CALLS(suppressedListener).size(), 1);
+
+    ASSERT_TRUE(LDi_storeDelete(&client->store, "flag1", 5));
+
+    ASSERT_EQ(changes.size(), 2);
+    ASSERT_TRUE(changes.at(1).deleted);
+
+    LDClientClose(client);
+}
+
+static void evaluateInListener(const LDFlagChange *const change, void *const context) {
+    auto *client = static_cast<struct LDClient *>(context);
+
+    /* the store is not locked during delivery */
+    ASSERT_EQ(LDBoolVariation(client, change->key, LDBooleanFalse), LDBooleanTrue);
+}
+
+TEST_F(FlagListenerFixture, ListenerMayEvaluateFlags) {
+    LDListenerStatistics statistics;
+
+    ASSERT_TRUE(LDClientRegisterFlagChangeListener(client, "flag1", evaluateInListener, client));
+    ASSERT_TRUE(LDi_storeUpsert(&client->store, makeFlag("flag1")));
+
+    ASSERT_TRUE(LDClientGetListenerStatistics(client, &statistics));
+    ASSERT_EQ(statistics.delivered, 1);
+    ASSERT_EQ(statistics.coalesced, 0);
+    ASSERT_GE(statistics.maxLatencyMilliseconds, 0);
+}
+
+struct BlockingListener {
+    std::atomic<bool> entered{false};
+    std::atomic<bool> release{false};
+    std::vector<RecordedChange> changes;
+};
+
+static void blockFirstChange(const LDFlagChange *const change, void *const context) {
+    auto *listener = static_cast<BlockingListener *>(context);
+
+    recordChange(change, &listener->changes);
+
+    if (!listener->entered.exchange(true)) {
+        while (!listener->release) {
+            LDi_sleepMilliseconds(1);
+        }
+    }
+}
+
+struct UpsertContext {
+    struct LDClient *client;
+    int version;
+};
+
+static THREAD_RETURN
+threadUpsert(void *const rawContext) {
+    auto *context = static_cast<UpsertContext *>(rawContext);
+
+    LDFlag flag = makeFlag("flag1");
+    flag.version = context->version;
+
+    LDi_storeUpsert(&context->client->store, flag);
+
+    return THREAD_RETURN_DEFAULT;
+}
+
+TEST_F(FlagListenerFixture, ChangesCoalesceWhileDelivering) {
+    BlockingListener listener;
+    LDListenerStatistics statistics;
+    UpsertContext first = {client, 2}, second = {client, 3}, third = {client, 4};
+    ld_thread_t firstThread, secondThread, thirdThread;
+
+    ASSERT_TRUE(LDClientRegisterFlagChangeListener(client, "flag1", blockFirstChange, &listener));
+
+    ASSERT_TRUE(LDi_thread_create(&firstThread, threadUpsert, &first));
+
+    while (!listener.entered) {
+        LDi_sleepMilliseconds(1);
+    }
+
+    /* both changes queue behind the blocked delivery, in order */
+    ASSERT_TRUE(LDi_thread_create(&secondThread, threadUpsert, &second));
+
+    for (;;) {
+        struct LDStoreNode *node;
+        int version;
+
+        ASSERT_TRUE(node = LDi_storeGet(&client->store, "flag1"));
+        version = node->flag.version;
+        LDi_rc_decrement(&node->rc);
+
+        if (version == 3) {
+            break;
+        }
+
+        LDi_sleepMilliseconds(1);
+    }
+
+    ASSERT_TRUE(LDi_thread_create(&thirdThread, threadUpsert, &third));
+
+    do {
+        LDi_sleepMilliseconds(1);
+        ASSERT_TRUE(LDClientGetListenerStatistics(client, &statistics));
+    } while (statistics.coalesced == 0);
+
+    listener.release = true;
+
+    ASSERT_TRUE(LDi_thread_join(&firstThread));
+    ASSERT_TRUE(LDi_thread_join(&secondThread));
+    ASSERT_TRUE(LDi_thread_join(&thirdThread));
+
+    ASSERT_EQ(listener.changes.size(), 2);
+    EXPECT_EQ(listener.changes.at(1).oldVersion, 2);
+    EXPECT_EQ(listener.changes.at(1).newVersion, 4);
+}
+
+struct ReentrantListener {
+    struct LDClient *client;
+    int calls;
+    std::vector<RecordedChange> changes;
+};
+
+static void unregisterInListener(const LDFlagChange *const change, void *const context) {
+    auto *listener = static_cast<ReentrantListener *>(context);
+
+    listener->calls++;
+
+    /* the listeners are not locked or iterated during delivery */
+    LDClientUnregisterFlagChangeListener(listener->client, change->key, unregisterInListener, context);
+    ASSERT_TRUE(LDClientRegisterFlagChangeListener(listener->client, "flag2", recordChange, &listener->changes));
+}
+
+TEST_F(FlagListenerFixture, ListenerMayUnregisterDuringDelivery) {
+    ReentrantListener listener{client, 0, {}};
+    std::vector<RecordedChange> changes;
+
+    ASSERT_TRUE(LDClientRegisterFlagChangeListener(client, "flag1", unregisterInListener, &listener));
+    ASSERT_TRUE(LDClientRegisterFlagChangeListener(client, "flag1", recordChange, &changes));
+
+    ASSERT_TRUE(LDi_storeUpsert(&client->store, makeFlag("flag1")));
+
+    LDFlag flag = makeFlag("flag1");
+    flag.version = 3;
+    ASSERT_TRUE(LDi_storeUpsert(&client->store, flag));
+
+    ASSERT_TRUE(LDi_storeUpsert(&client->store, makeFlag("flag2")));
+
+    ASSERT_EQ(listener.calls, 1);
+    ASSERT_EQ(changes.size(), 2);
+    ASSERT_EQ(listener.changes.size(), 1);
+    EXPECT_EQ(listener.changes.at(0).key, "flag2");
+
+    LDClientUnregisterFlagChangeListener(client, "flag1", recordChange, &changes);
+    LDClientUnregisterFlagChangeListener(client, "flag2", recordChange, &listener.changes);
+}
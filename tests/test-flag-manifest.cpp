@@ -0,0 +1,120 @@
+#include "gtest/gtest.h"
+#include "commonfixture.h"
+
+#include "ldflag.h"
+
+extern "C" {
+#include <launchdarkly/api.h>
+
+#include "ldinternal.h"
+}
+
+class FlagManifestFixture : public CommonFixture {
+protected:
+    struct LDClient *client;
+
+    void SetUp() override {
+        CommonFixture::SetUp();
+
+        struct LDConfig *config;
+        struct LDUser *user;
+
+        LD_ASSERT(config = LDConfigNew("abc"));
+        LDConfigSetOffline(config, LDBooleanTrue);
+        LDConfigSetFlagManifest(config, LDFlagManifest, LDFlagManifestCount);
+
+        LD_ASSERT(user = LDUserNew("test-user"));
+
+        LD_ASSERT(client = LDClientInit(config, user, 0));
+    }
+
+    void TearDown() override {
+        LDClientClose(client);
+        CommonFixture::TearDown();
+    }
+};
+
+TEST_F(FlagManifestFixture, GeneratedKeysMatchRuntimeKeys) {
+    LDFlagKey prepared;
+
+    ASSERT_EQ(LDFlagManifestCount, 6);
+
+    for (unsigned int i = 0; i < LDFlagManifestCount; i++) {
+        LDFlagKeyInit(&prepared, LDFlagManifest[i].key);
+
+        ASSERT_EQ(prepared.length, LDFlagManifest[i].length);
+        ASSERT_EQ(prepared.hash, LDFlagManifest[i].hash);
+        ASSERT_EQ(LDFlagManifest[i].slot, i + 1);
+    }
+}
+
+TEST_F(FlagManifestFixture, AccessorsUseManifestFallbacks) {
+    LDBorrowedString text;
+    LDBorrowedJSON json;
+    struct LDJSON *fallback;
+
+    ASSERT_EQ(LDFlag_checkout_v2(client), LDBooleanFalse);
+    ASSERT_EQ(LDFlag_max_retries(client), 3);
+    ASSERT_EQ(LDFlag_sample_rate(client), 1.0);
+    ASSERT_STREQ(LDFlag_banner_text(client, &text), "say \"hello\"?");
+    LDBorrowedStringRelease(&text);
+
+    ASSERT_TRUE(fallback = LDNewNull());
+    ASSERT_EQ(LDFlag_layout(client, fallback, &json), fallback);
+    LDBorrowedJSONRelease(&json);
+    LDJSONFree(fallback);
+
+    ASSERT_EQ(LDFlag_ends__comment__(client), 0);
+}
+
+TEST_F(FlagManifestFixture, SlotsFollowPutAndPatch) {
+    LDBorrowedString text;
+
+    ASSERT_TRUE(LDClientRestoreFlags(client,
+        "{\"checkout-v2\":{\"value\":true,\"version\":1},"
+        "\"banner-text\":{\"value\":\"stored\",\"version\":1},"
+        "\"unlisted\":{\"value\":1,\"version\":1}}"));
+
+    ASSERT_TRUE(client->store.table->slots);
+    ASSERT_TRUE(client->store.table->slots[0]);
+    ASSERT_FALSE(client->store.table->slots[1]);
+
+    ASSERT_EQ(LDFlag_checkout_v2(client), LDBooleanTrue);
+    ASSERT_EQ(LDFlag_max_retries(client), 3);
+    ASSERT_STREQ(LDFlag_banner_text(client, &text), "stored");
+    LDBorrowedStringRelease(&text);
+
+    struct LDFlag flag;
+    memset(&flag, 0, sizeof(flag));
+    ASSERT_TRUE(flag.key = LDStrDup("max.retries"));
+    ASSERT_TRUE(flag.value = LDNewNumber(5));
+    flag.version = 2;
+    flag.flagVersion = -1;
+    ASSERT_TRUE(LDi_storeUpsert(&client->store, flag));
+
+    ASSERT_EQ(LDFlag_max_retries(client), 5);
+
+    ASSERT_TRUE(LDi_storeDelete(&client->store, "checkout-v2", 3));
+    ASSERT_EQ(LDFlag_checkout_v2(client), LDBooleanFalse);
+}
+
+TEST_F(FlagManifestFixture, SlotRequiresManifestElement) {
+    LDFlagKey forged, copy;
+    struct LDStoreNode *node;
+
+    ASSERT_TRUE(LDClientRestoreFlags(client,
+        "{\"checkout-v2\":{\"value\":true,\"version\":1},"
+        "\"unlisted\":{\"value\":1,\"version\":1}}"));
+
+    // A foreign key that claims the slot and hash of checkout-v2.
+    forged = LDFlagManifest[0];
+    forged.key = "unlisted";
+    forged.length = strlen("unlisted");
+    ASSERT_FALSE(LDi_storeGetKey(&client->store, &forged));
+
+    // A copy of a manifest element still resolves by hash.
+    copy = LDFlagManifest[0];
+    ASSERT_TRUE(node = LDi_storeGetKey(&client->store, &copy));
+    ASSERT_STREQ(node->flag.key, "checkout-v2");
+    LDi_rc_decrement(&node->rc);
+}
@@ -1,6 +1,8 @@
 #include "gtest/gtest.h"
 #include "commonfixture.h"
 
+#include <cstdio>
+
 extern "C" {
 #include <launchdarkly/api.h>
 
@@ -100,3 +102,173 @@ TEST_F(StoreFixture, EmptyDataSetShouldNotCauseAbort) {
     LDJSONFree(json);
     LDFree(jsonStr);
 }
+
+static void
+makeFlag(struct LDFlag *const flag, const char *const key, const int version)
+{
+    flag->key = LDStrDup(key);
+    flag->value = LDNewNumber(version);
+    flag->version = version;
+    flag->flagVersion = -1;
+    flag->variation = 0;
+    flag->trackEvents = LDBooleanFalse;
+    flag->trackReason = LDBooleanFalse;
+    flag->reason = NULL;
+    flag->debugEventsUntilDate = 0;
+    flag->deleted = LDBooleanFalse;
+}
+
+TEST_F(StoreFixture, IndexGrowsAndFindsEveryKey) {
+    struct LDFlag *flags;
+    struct LDStoreNode *node;
+    char key[128];
+    const unsigned int count = 1000;
+    unsigned int i;
+
+    ASSERT_TRUE(flags = (struct LDFlag *) LDAlloc(sizeof(struct LDFlag) * count));
+
+    for (i = 0; i < count; i++) {
+        /* every third key is longer than the inline key storage */
+        if (i % 3 == 0) {
+            snprintf(key, sizeof(key),
+                "a-flag-key-that-does-not-fit-inside-the-index-slot-%u", i);
+        } else {
+            snprintf(key, sizeof(key), "flag-%u", i);
+        }
+
+        makeFlag(&flags[i], key, i + 1);
+    }
+
+    ASSERT_TRUE(LDi_storePut(&client->store, flags, count));
+    ASSERT_EQ(client->store.table->flags.count, count);
+
+    for (i = 0; i < count; i++) {
+        if (i % 3 == 0) {
+            snprintf(key, sizeof(key),
+                "a-flag-key-that-does-not-fit-inside-the-index-slot-%u", i);
+        } else {
+            snprintf(key, sizeof(key), "flag-%u", i);
+        }
+
+        ASSERT_TRUE(node = LDi_storeGet(&client->store, key));
+        ASSERT_STREQ(node->flag.key, key);
+        ASSERT_EQ(node->flag.version, (int) i + 1);
+        LDi_rc_decrement(&node->rc);
+    }
+
+    ASSERT_FALSE(LDi_storeGet(&client->store, "flag-1000"));
+    ASSERT_FALSE(LDi_storeGet(&client->store, "flag-"));
+    ASSERT_FALSE(LDi_storeGet(&client->store,
+        "a-flag-key-that-does-not-fit-inside-the-index-slot-1"));
+}
+
+TEST_F(StoreFixture, UpsertReplacesIndexedNode) {
+    struct LDFlag flag;
+    struct LDStoreNode *node;
+
+    makeFlag(&flag, "flag", 1);
+    ASSERT_TRUE(LDi_storeUpsert(&client->store, flag));
+
+    makeFlag(&flag, "flag", 2);
+    ASSERT_TRUE(LDi_storeUpsert(&client->store, flag));
+
+    /* stale update is ignored */
+    makeFlag(&flag, "flag", 1);
+    ASSERT_TRUE(LDi_storeUpsert(&client->store, flag));
+
+    ASSERT_EQ(client->store.table->flags.count, 1);
+
+    ASSERT_TRUE(node = LDi_storeGet(&client->store, "flag"));
+    ASSERT_EQ(node->flag.version, 2);
+    LDi_rc_decrement(&node->rc);
+
+    ASSERT_TRUE(LDi_storeDelete(&client->store, "flag", 3));
+    ASSERT_FALSE(LDi_storeGet(&client->store, "flag"));
+    ASSERT_EQ(client->store.table->flags.count, 1);
+}
+
+TEST_F(StoreFixture, PutWithDuplicateKeysKeepsLast) {
+    struct LDFlag *flags;
+    struct LDStoreNode *node;
+
+    ASSERT_TRUE(flags = (struct LDFlag *) LDAlloc(sizeof(struct LDFlag) * 2));
+
+    makeFlag(&flags[0], "flag", 1);
+    makeFlag(&flags[1], "flag", 2);
+
+    ASSERT_TRUE(LDi_storePut(&client->store, flags, 2));
+    ASSERT_EQ(client->store.table->flags.count, 1);
+
+    ASSERT_TRUE(node = LDi_storeGet(&client->store, "flag"));
+    ASSERT_EQ(node->flag.version, 2);
+    LDi_rc_decrement(&node->rc);
+}
+
+TEST_F(StoreFixture, GenerationChangesOnlyWithContents) {
+    struct LDFlag flag, *flags;
+    unsigned long generation;
+
+    generation = LDi_storeGeneration(&client->store);
+
+    makeFlag(&flag, "flag", 2);
+    ASSERT_TRUE(LDi_storeUpsert(&client->store, flag));
+    ASSERT_NE(LDi_storeGeneration(&client->store), generation);
+    generation = LDi_storeGeneration(&client->store);
+
+    /* stale */
+    makeFlag(&flag, "flag", 1);
+    ASSERT_TRUE(LDi_storeUpsert(&client->store, flag));
+    ASSERT_EQ(LDi_storeGeneration(&client->store), generation);
+
+    ASSERT_TRUE(LDi_storeDelete(&client->store, "flag", 3));
+    ASSERT_NE(LDi_storeGeneration(&client->store), generation);
+    generation = LDi_storeGeneration(&client->store);
+
+    ASSERT_TRUE(flags = (struct LDFlag *) LDAlloc(sizeof(struct LDFlag)));
+    makeFlag(&flags[0], "flag", 4);
+    ASSERT_TRUE(LDi_storePut(&client->store, flags, 1));
+    ASSERT_NE(LDi_storeGeneration(&client->store), generation);
+}
+
+TEST_F(StoreFixture, UpsertPatchesUnsharedTableInPlace) {
+    struct LDFlag *flags, flag;
+    struct LDStoreTable *table;
+    struct LDStoreNode *other;
+
+    ASSERT_TRUE(flags = (struct LDFlag *) LDAlloc(sizeof(struct LDFlag) * 2));
+    makeFlag(&flags[0], "flag", 1);
+    makeFlag(&flags[1], "other", 1);
+    ASSERT_TRUE(LDi_storePut(&client->store, flags, 2));
+
+    table = client->store.table;
+    other = LDi_storeTableGet(table, "other");
+
+    /* only the store references the table, and the other node is not
+     * touched */
+    makeFlag(&flag, "flag", 2);
+    ASSERT_TRUE(LDi_storeUpsert(&client->store, flag));
+    ASSERT_EQ(client->store.table, table);
+    ASSERT_EQ(other->rc.count, 1);
+    ASSERT_EQ(LDi_storeTableGet(table, "flag")->flag.version, 2);
+}
+
+TEST_F(StoreFixture, UpsertCopiesSharedTable) {
+    struct LDFlag flag;
+    struct LDStoreTable *table;
+
+    makeFlag(&flag, "flag", 1);
+    ASSERT_TRUE(LDi_storeUpsert(&client->store, flag));
+
+    ASSERT_TRUE(table = LDi_storeAcquireTable(&client->store));
+
+    makeFlag(&flag, "flag", 2);
+    ASSERT_TRUE(LDi_storeUpsert(&client->store, flag));
+
+    /* the acquired table is unchanged */
+    ASSERT_NE(client->store.table, table);
+    ASSERT_EQ(LDi_storeTableGet(table, "flag")->flag.version, 1);
+    ASSERT_EQ(
+        LDi_storeTableGet(client->store.table, "flag")->flag.version, 2);
+
+    LDi_storeReleaseTable(table);
+}
@@ -3,6 +3,7 @@
 
 extern "C" {
 #include <launchdarkly/api.h>
+#include <launchdarkly/experimental/ldvalue.h>
 
 #include "ldinternal.h"
 }
@@ -157,6 +158,132 @@ TEST_F(VariationsWithClientFixture, StringVariationAlloc) {
     LDFree(result);
 }
 
+TEST_F(VariationsWithClientFixture, StringVariationBorrowDefault) {
+    LDBorrowedString result;
+
+    ASSERT_STREQ(LDStringVariationBorrow(client, "test", "fallback", &result), "fallback");
+    ASSERT_EQ(result.length, 8);
+
+    LDBorrowedStringRelease(&result);
+}
+
+TEST_F(VariationsWithClientFixture, StringVariationBorrowOutlivesUpdate) {
+    struct LDFlag flag;
+    LDBorrowedString result;
+
+    fillFlag(LDNewText("value"), flag);
+    ASSERT_TRUE(LDi_storeUpsert(&client->store, flag));
+
+    ASSERT_STREQ(LDStringVariationBorrow(client, "test", "fallback", &result), "value");
+    ASSERT_EQ(result.length, 5);
+
+    fillFlag(LDNewText("replaced"), flag);
+    flag.version = 3;
+    ASSERT_TRUE(LDi_storeUpsert(&client->store, flag));
+
+    /* the replaced node is pinned by the borrow */
+    ASSERT_STREQ(result.value, "value");
+
+    LDBorrowedStringRelease(&result);
+    ASSERT_EQ(result.value, nullptr);
+}
+
+TEST_F(VariationsWithClientFixture, JSONVariationBorrowSharesStoreValue) {
+    struct LDFlag flag;
+    struct LDJSON *fallback, *value;
+    LDBorrowedJSON first, second;
+
+    ASSERT_TRUE(value = LDNewObject());
+    ASSERT_TRUE(LDObjectSetKey(value, "a", LDNewNumber(1)));
+    fillFlag(value, flag);
+    ASSERT_TRUE(LDi_storeUpsert(&client->store, flag));
+
+    ASSERT_TRUE(fallback = LDNewNull());
+
+    ASSERT_EQ(LDJSONVariationBorrow(client, "test", fallback, &first), value);
+    ASSERT_EQ(LDJSONVariationBorrow(client, "test", fallback, &second), value);
+    ASSERT_EQ(LDValue_Type(LDBorrowedJSONAsValue(&first)), LDValueType_Object);
+
+    fillFlag(LDNewNumber(2), flag);
+    flag.version = 3;
+    ASSERT_TRUE(LDi_storeUpsert(&client->store, flag));
+
+    /* the replaced node is pinned until both borrows are released */
+    LDBorrowedJSONRelease(&first);
+    ASSERT_EQ(LDGetNumber(LDObjectLookup(second.value, "a")), 1);
+    LDBorrowedJSONRelease(&second);
+
+    LDJSONFree(fallback);
+}
+
+TEST_F(VariationsWithClientAndDetail, JSONVariationBorrowDetailDefault) {
+    struct LDJSON *fallback;
+    LDBorrowedJSON result;
+
+    ASSERT_TRUE(fallback = LDNewText("alice"));
+
+    ASSERT_EQ(LDJSONVariationBorrowDetail(client, "test", fallback, &result, &details), fallback);
+    ASSERT_EQ(details.variationIndex, -1);
+
+    LDBorrowedJSONRelease(&result);
+    LDJSONFree(fallback);
+}
+
+TEST_F(VariationsWithClientFixture, VariationReasonFlagNotFound) {
+    LDEvaluationDetail detail;
+
+    ASSERT_TRUE(LDBoolVariationReason(client, "test", LDBooleanTrue, &detail));
+    ASSERT_EQ(detail.variationIndex, -1);
+    ASSERT_EQ(detail.reason.kind, LDReasonKindError);
+    ASSERT_EQ(detail.reason.errorKind, LDReasonErrorFlagNotFound);
+
+    LDEvaluationDetailRelease(&detail);
+}
+
+TEST_F(VariationsWithClientFixture, VariationReasonWrongType) {
+    struct LDFlag flag;
+    LDEvaluationDetail detail;
+
+    fillFlag(LDNewText("value"), flag);
+    ASSERT_TRUE(LDi_storeUpsert(&client->store, flag));
+
+    ASSERT_EQ(LDIntVariationReason(client, "test", 4, &detail), 4);
+    ASSERT_EQ(detail.reason.kind, LDReasonKindError);
+    ASSERT_EQ(detail.reason.errorKind, LDReasonErrorWrongType);
+
+    LDEvaluationDetailRelease(&detail);
+}
+
+TEST_F(VariationsWithClientFixture, VariationReasonDecodedFromFlag) {
+    struct LDFlag flag;
+    struct LDJSON *reason;
+    LDEvaluationDetail detail;
+    LDBorrowedString value;
+
+    fillFlag(LDNewText("value"), flag);
+    ASSERT_TRUE(flag.reason = LDJSONDeserialize(
+        "{\"kind\":\"RULE_MATCH\",\"ruleIndex\":2,\"ruleId\":\"rule-id\","
+        "\"inExperiment\":true}"));
+    ASSERT_TRUE(LDi_storeUpsert(&client->store, flag));
+
+    ASSERT_STREQ(LDStringVariationBorrowReason(
+        client, "test", "fallback", &value, &detail), "value");
+    ASSERT_EQ(detail.variationIndex, 3);
+    ASSERT_EQ(detail.reason.kind, LDReasonKindRuleMatch);
+    ASSERT_EQ(detail.reason.ruleIndex, 2);
+    ASSERT_STREQ(detail.reason.ruleId, "rule-id");
+    ASSERT_EQ(detail.reason.prerequisiteKey, nullptr);
+    ASSERT_TRUE(detail.reason.inExperiment);
+
+    ASSERT_TRUE(reason = LDEvaluationReasonToJSON(&detail.reason));
+    ASSERT_STREQ(LDGetText(LDObjectLookup(reason, "ruleId")), "rule-id");
+    ASSERT_EQ(LDGetNumber(LDObjectLookup(reason, "ruleIndex")), 2);
+
+    LDJSONFree(reason);
+    LDBorrowedStringRelease(&value);
+    LDEvaluationDetailRelease(&detail);
+}
+
 TEST_F(VariationsWithClientFixture, JSONVariation) {
     struct LDFlag flag;
     fillFlag(LDNewText("value"), flag);
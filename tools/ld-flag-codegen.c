@@ -0,0 +1,532 @@
+/* Generates typed flag accessors from a JSON flag manifest.
+ *
+ * usage: ld-flag-codegen <manifest.json> <output> [prefix]
+ *
+ * The manifest is an object of flags in the same shape as a flag file,
+ * for example:
+ *
+ *     { "checkout-v2": { "value": false, "version": 1 } }
+ *
+ * Writes <output>.h and <output>.c. For every flag the header declares an
+ * accessor named <prefix>_<key>, with characters that may not appear in an
+ * identifier replaced by underscores. The value in the manifest is used as
+ * the fallback and selects the accessor type: booleans, integers and other
+ * numbers map to LDBoolean, int and double, strings are borrowed with
+ * LDStringVariationBorrowKey, and anything else is borrowed JSON with a
+ * fallback supplied by the caller. An optional "type" of "bool", "int",
+ * "double", "string" or "json" overrides the inferred type.
+ *
+ * Keys are hashed here, and given a slot in <prefix>Manifest, which must be
+ * passed to LDConfigSetFlagManifest for the slots to take effect. */
+
+#include <limits.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <launchdarkly/api.h>
+
+enum FlagType
+{
+    FLAG_BOOL,
+    FLAG_INT,
+    FLAG_DOUBLE,
+    FLAG_STRING,
+    FLAG_JSON
+};
+
+struct ManifestFlag
+{
+    const char *         key;
+    char *               identifier;
+    enum FlagType        type;
+    const struct LDJSON *value;
+    LDFlagKey            prepared;
+};
+
+static char *
+readFile(const char *const path)
+{
+    FILE * file;
+    char * buffer;
+    long   length;
+    size_t bytesRead;
+
+    if (!(file = fopen(path, "rb"))) {
+        return NULL;
+    }
+
+    buffer = NULL;
+
+    if (fseek(file, 0, SEEK_END) != 0 || (length = ftell(file)) < 0 ||
+        fseek(file, 0, SEEK_SET) != 0)
+    {
+        goto error;
+    }
+
+    if (!(buffer = malloc((size_t)length + 1))) {
+        goto error;
+    }
+
+    bytesRead = fread(buffer, 1, (size_t)length, file);
+
+    if (bytesRead != (size_t)length) {
+        goto error;
+    }
+
+    buffer[length] = '\0';
+
+    fclose(file);
+
+    return buffer;
+
+error:
+    free(buffer);
+    fclose(file);
+
+    return NULL;
+}
+
+static char *
+makeIdentifier(const char *const prefix, const char *const key)
+{
+    char * identifier, *cursor;
+    size_t prefixLength;
+
+    prefixLength = strlen(prefix);
+
+    if (!(identifier = malloc(prefixLength + strlen(key) + 2))) {
+        return NULL;
+    }
+
+    memcpy(identifier, prefix, prefixLength);
+    identifier[prefixLength] = '_';
+    strcpy(identifier + prefixLength + 1, key);
+
+    for (cursor = identifier + prefixLength + 1; *cursor; cursor++) {
+        if (!((*cursor >= 'a' && *cursor <= 'z') ||
+              (*cursor >= 'A' && *cursor <= 'Z') ||
+              (*cursor >= '0' && *cursor <= '9')))
+        {
+            *cursor = '_';
+        }
+    }
+
+    return identifier;
+}
+
+static LDBoolean
+selectType(
+    const char *const          key,
+    const struct LDJSON *const flag,
+    const struct LDJSON *const value,
+    enum FlagType *const       type)
+{
+    const struct LDJSON *override;
+    const char *         name;
+    double               number;
+
+    if ((override = LDObjectLookup(flag, "type"))) {
+        if (LDJSONGetType(override) != LDText) {
+            fprintf(stderr, "flag \"%s\": type must be a string\n", key);
+
+            return LDBooleanFalse;
+        }
+
+        name = LDGetText(override);
+
+        if (strcmp(name, "bool") == 0) {
+            *type = FLAG_BOOL;
+        } else if (strcmp(name, "int") == 0) {
+            *type = FLAG_INT;
+        } else if (strcmp(name, "double") == 0) {
+            *type = FLAG_DOUBLE;
+        } else if (strcmp(name, "string") == 0) {
+            *type = FLAG_STRING;
+        } else if (strcmp(name, "json") == 0) {
+            *type = FLAG_JSON;
+        } else {
+            fprintf(stderr, "flag \"%s\": unknown type \"%s\"\n", key, name);
+
+            return LDBooleanFalse;
+        }
+
+        if ((*type == FLAG_BOOL && LDJSONGetType(value) != LDBool) ||
+            ((*type == FLAG_INT || *type == FLAG_DOUBLE) &&
+             LDJSONGetType(value) != LDNumber) ||
+            (*type == FLAG_STRING && LDJSONGetType(value) != LDText))
+        {
+            fprintf(stderr, "flag \"%s\": value does not match type\n", key);
+
+            return LDBooleanFalse;
+        }
+
+        if (*type == FLAG_INT) {
+            number = LDGetNumber(value);
+
+            if (number != floor(number) || number < INT_MIN ||
+                number > INT_MAX)
+            {
+                fprintf(stderr, "flag \"%s\": value is not an int\n", key);
+
+                return LDBooleanFalse;
+            }
+        }
+
+        return LDBooleanTrue;
+    }
+
+    switch (LDJSONGetType(value)) {
+        case LDBool:
+            *type = FLAG_BOOL;
+            break;
+        case LDNumber:
+            number = LDGetNumber(value);
+
+            if (number == floor(number) && number >= INT_MIN &&
+                number <= INT_MAX)
+            {
+                *type = FLAG_INT;
+            } else {
+                *type = FLAG_DOUBLE;
+            }
+            break;
+        case LDText:
+            *type = FLAG_STRING;
+            break;
+        default:
+            *type = FLAG_JSON;
+            break;
+    }
+
+    return LDBooleanTrue;
+}
+
+/* Writes text inside a comment, breaking up any sequence that would end or
+ * appear to nest it. */
+static void
+writeCommentText(FILE *const output, const char *const text)
+{
+    const char *cursor;
+
+    for (cursor = text; *cursor; cursor++) {
+        fputc(*cursor, output);
+
+        if ((*cursor == '*' && cursor[1] == '/') ||
+            (*cursor == '/' && cursor[1] == '*'))
+        {
+            fputc('\\', output);
+        }
+    }
+}
+
+/* Writes text as a C string literal. */
+static void
+writeLiteral(FILE *const output, const char *const text)
+{
+    const unsigned char *cursor;
+
+    fputc('"', output);
+
+    for (cursor = (const unsigned char *)text; *cursor; cursor++) {
+        if (*cursor == '"' || *cursor == '\\') {
+            fprintf(output, "\\%c", *cursor);
+        } else if (*cursor < 32 || *cursor > 126 || *cursor == '?') {
+            /* octal escapes are always three digits so never absorb the
+             * following character, and escaping ? avoids trigraphs */
+            fprintf(output, "\\%03o", *cursor);
+        } else {
+            fputc(*cursor, output);
+        }
+    }
+
+    fputc('"', output);
+}
+
+static void
+writeDeclaration(
+    FILE *const output, const struct ManifestFlag *const flag)
+{
+    switch (flag->type) {
+        case FLAG_BOOL:
+            fprintf(output, "LDBoolean\n%s(struct LDClient *const client)",
+                flag->identifier);
+            break;
+        case FLAG_INT:
+            fprintf(output, "int\n%s(struct LDClient *const client)",
+                flag->identifier);
+            break;
+        case FLAG_DOUBLE:
+            fprintf(output, "double\n%s(struct LDClient *const client)",
+                flag->identifier);
+            break;
+        case FLAG_STRING:
+            fprintf(output,
+                "const char *\n%s(\n"
+                "    struct LDClient *const client, "
+                "LDBorrowedString *const result)",
+                flag->identifier);
+            break;
+        case FLAG_JSON:
+            fprintf(output,
+                "const struct LDJSON *\n%s(\n"
+                "    struct LDClient *const     client,\n"
+                "    const struct LDJSON *const fallback,\n"
+                "    LDBorrowedJSON *const      result)",
+                flag->identifier);
+            break;
+    }
+}
+
+static LDBoolean
+writeHeader(
+    const char *const                path,
+    const char *const                manifestPath,
+    const char *const                prefix,
+    const struct ManifestFlag *const flags,
+    const unsigned int               flagCount)
+{
+    FILE *       output;
+    unsigned int i;
+
+    if (!(output = fopen(path, "w"))) {
+        return LDBooleanFalse;
+    }
+
+    fprintf(output, "/* Generated by ld-flag-codegen from ");
+    writeCommentText(output, manifestPath);
+    fprintf(output, ", do not edit. */"
+        "\n\n#pragma once\n\n#include <launchdarkly/api.h>\n\n"
+        "#ifdef __cplusplus\nextern \"C\" {\n#endif\n\n");
+
+    fprintf(output, "/* Pass to LDConfigSetFlagManifest. */\n"
+        "extern const LDFlagKey    %sManifest[];\n"
+        "extern const unsigned int %sManifestCount;\n", prefix, prefix);
+
+    for (i = 0; i < flagCount; i++) {
+        fprintf(output, "\n/* \"");
+        writeCommentText(output, flags[i].key);
+        fprintf(output, "\" */\n");
+        writeDeclaration(output, &flags[i]);
+        fprintf(output, ";\n");
+    }
+
+    fprintf(output, "\n#ifdef __cplusplus\n}\n#endif\n");
+
+    return fclose(output) == 0;
+}
+
+static void
+writeBody(FILE *const output, const struct ManifestFlag *const flag,
+    const char *const prefix, const unsigned int index)
+{
+    switch (flag->type) {
+        case FLAG_BOOL:
+            fprintf(output,
+                "    return LDBoolVariationKey(client, &%sManifest[%u], %s);\n",
+                prefix, index,
+                LDGetBool(flag->value) ? "LDBooleanTrue" : "LDBooleanFalse");
+            break;
+        case FLAG_INT:
+            fprintf(output,
+                "    return LDIntVariationKey(client, &%sManifest[%u], %d);\n",
+                prefix, index, (int)LDGetNumber(flag->value));
+            break;
+        case FLAG_DOUBLE:
+            fprintf(output,
+                "    return LDDoubleVariationKey(client, &%sManifest[%u], "
+                "%.17g);\n", prefix, index, LDGetNumber(flag->value));
+            break;
+        case FLAG_STRING:
+            fprintf(output,
+                "    return LDStringVariationBorrowKey(\n"
+                "        client, &%sManifest[%u], ", prefix, index);
+            writeLiteral(output, LDGetText(flag->value));
+            fprintf(output, ", result);\n");
+            break;
+        case FLAG_JSON:
+            fprintf(output,
+                "    return LDJSONVariationBorrowKey(\n"
+                "        client, &%sManifest[%u], fallback, result);\n",
+                prefix, index);
+            break;
+    }
+}
+
+static LDBoolean
+writeSource(
+    const char *const                path,
+    const char *const                headerName,
+    const char *const                manifestPath,
+    const char *const                prefix,
+    const struct ManifestFlag *const flags,
+    const unsigned int               flagCount)
+{
+    FILE *       output;
+    unsigned int i;
+
+    if (!(output = fopen(path, "w"))) {
+        return LDBooleanFalse;
+    }
+
+    fprintf(output, "/* Generated by ld-flag-codegen from ");
+    writeCommentText(output, manifestPath);
+    fprintf(output, ", do not edit. */"
+        "\n\n#include \"%s\"\n\nconst LDFlagKey %sManifest[] = {\n",
+        headerName, prefix);
+
+    for (i = 0; i < flagCount; i++) {
+        fprintf(output, "    {");
+        writeLiteral(output, flags[i].key);
+        fprintf(output, ", %lu, 0x%08xu, %u},\n",
+            (unsigned long)flags[i].prepared.length,
+            flags[i].prepared.hash, i + 1);
+    }
+
+    fprintf(output, "};\n\nconst unsigned int %sManifestCount = %u;\n",
+        prefix, flagCount);
+
+    for (i = 0; i < flagCount; i++) {
+        fprintf(output, "\n");
+        writeDeclaration(output, &flags[i]);
+        fprintf(output, "\n{\n");
+        writeBody(output, &flags[i], prefix, i);
+        fprintf(output, "}\n");
+    }
+
+    return fclose(output) == 0;
+}
+
+int
+main(int argc, char **argv)
+{
+    const char *         manifestPath, *outputBase, *prefix, *headerName;
+    char *               text, *headerPath, *sourcePath;
+    struct LDJSON *      manifest, *iter;
+    struct ManifestFlag *flags;
+    unsigned int         flagCount, i, j;
+    int                  status;
+
+    if (argc < 3 || argc > 4) {
+        fprintf(stderr, "usage: %s <manifest.json> <output> [prefix]\n",
+            argv[0]);
+
+        return 2;
+    }
+
+    manifestPath = argv[1];
+    outputBase   = argv[2];
+    prefix       = argc == 4 ? argv[3] : "LDFlag";
+    status       = 1;
+    text         = NULL;
+    manifest     = NULL;
+    flags        = NULL;
+    flagCount    = 0;
+    headerPath   = NULL;
+    sourcePath   = NULL;
+
+    if (!(text = readFile(manifestPath))) {
+        fprintf(stderr, "failed to read %s\n", manifestPath);
+
+        goto cleanup;
+    }
+
+    if (!(manifest = LDJSONDeserialize(text)) ||
+        LDJSONGetType(manifest) != LDObject)
+    {
+        fprintf(stderr, "%s is not a JSON object\n", manifestPath);
+
+        goto cleanup;
+    }
+
+    /* C89 does not allow empty arrays */
+    if (LDCollectionGetSize(manifest) == 0) {
+        fprintf(stderr, "%s contains no flags\n", manifestPath);
+
+        goto cleanup;
+    }
+
+    if (!(flags = calloc(
+              LDCollectionGetSize(manifest), sizeof(struct ManifestFlag))))
+    {
+        goto cleanup;
+    }
+
+    for (iter = LDGetIter(manifest); iter; iter = LDIterNext(iter)) {
+        struct ManifestFlag *flag;
+
+        flag      = &flags[flagCount++];
+        flag->key = LDIterKey(iter);
+
+        if (LDJSONGetType(iter) != LDObject ||
+            !(flag->value = LDObjectLookup(iter, "value")))
+        {
+            fprintf(stderr, "flag \"%s\" has no value\n", flag->key);
+
+            goto cleanup;
+        }
+
+        if (!selectType(flag->key, iter, flag->value, &flag->type)) {
+            goto cleanup;
+        }
+
+        if (!(flag->identifier = makeIdentifier(prefix, flag->key))) {
+            goto cleanup;
+        }
+
+        for (j = 0; j + 1 < flagCount; j++) {
+            if (strcmp(flags[j].identifier, flag->identifier) == 0) {
+                fprintf(stderr, "flags \"%s\" and \"%s\" both map to %s\n",
+                    flags[j].key, flag->key, flag->identifier);
+
+                goto cleanup;
+            }
+        }
+
+        LDFlagKeyInit(&flag->prepared, flag->key);
+    }
+
+    if (!(headerPath = malloc(strlen(outputBase) + 3)) ||
+        !(sourcePath = malloc(strlen(outputBase) + 3)))
+    {
+        goto cleanup;
+    }
+
+    sprintf(headerPath, "%s.h", outputBase);
+    sprintf(sourcePath, "%s.c", outputBase);
+
+    headerName = strrchr(headerPath, '/');
+    headerName = headerName ? headerName + 1 : headerPath;
+
+    if (!writeHeader(headerPath, manifestPath, prefix, flags, flagCount)) {
+        fprintf(stderr, "failed to write %s\n", headerPath);
+
+        goto cleanup;
+    }
+
+    if (!writeSource(sourcePath, headerName, manifestPath, prefix, flags,
+            flagCount))
+    {
+        fprintf(stderr, "failed to write %s\n", sourcePath);
+
+        goto cleanup;
+    }
+
+    status = 0;
+
+cleanup:
+    if (flags) {
+        for (i = 0; i < flagCount; i++) {
+            free(flags[i].identifier);
+        }
+    }
+
+    free(headerPath);
+    free(sourcePath);
+    free(flags);
+    LDJSONFree(manifest);
+    free(text);
+
+    return status;
+}